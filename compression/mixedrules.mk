@@ -0,0 +1,32 @@
+# Per-segment codecs, chosen in compression/segments.mk.
+# Each segment is prefixed with a small header naming its codec, so load_segment_decompress can pick the decoder at runtime.
+include compression/segments.mk
+
+MIXED_CODECS := mio0 yay0 gzip rnc1 rnc2 lz4t uncomp
+segment_codec = $(or $(SEGMENT_COMPRESS.$(1)),$(SEGMENT_COMPRESS_DEFAULT))
+
+compress_yay0   = $(YAY0TOOL) $(1) $(2)
+compress_mio0   = $(MIO0TOOL) $(1) $(2)
+compress_rnc1   = $(RNCPACK) p $(1) $(2) -m1
+compress_rnc2   = $(RNCPACK) p $(1) $(2) -m2
+compress_lz4t   = $(LZ4TPACK) $(1) $(2)
+compress_uncomp = cp $(1) $(2)
+# Raw DEFLATE: strip the 10 byte gzip header. The trailer is never read.
+ifeq ($(GZIPVER),std)
+compress_gzip   = $(GZIP) -c -9 -n $(1) | tail -c +11 > $(2)
+else
+compress_gzip   = $(GZIP) -c -12 -n $(1) | tail -c +11 > $(2)
+endif
+
+# Compress binary file and add the segment header
+$(BUILD_DIR)/%.szp: $(BUILD_DIR)/%.bin
+	$(if $(filter $(call segment_codec,$*),$(MIXED_CODECS)),,$(error Unknown codec '$(call segment_codec,$*)' for segment $*))
+	$(call print,Compressing ($(call segment_codec,$*)):,$<,$@)
+	$(V)$(call cached_shell,$@.pack,$<,$(call compress_$(call segment_codec,$*),$<,$@.pack))
+	$(V)python3 tools/segment_header.py $(call segment_codec,$*) $< $@.pack $@
+	$(V)$(RM) $@.pack
+
+# convert binary szp to object file
+$(BUILD_DIR)/%.szp.o: $(BUILD_DIR)/%.szp
+	$(call print,Converting segment to ELF:,$<,$@)
+	$(V)$(LD) -r -b binary $< -o $@
\ No newline at end of file
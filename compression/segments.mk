@@ -0,0 +1,20 @@
+# Codec for each segment when building with COMPRESS=mixed.
+#
+# Segments are named by their path in the build directory without the extension, e.g. levels/bob/leveldata,
+# actors/group0 or bin/segment2. Any segment not listed here uses SEGMENT_COMPRESS_DEFAULT.
+# Codecs: yay0 mio0 gzip rnc1 rnc2 lz4t uncomp
+#
+# Segments that don't shrink are stored uncompressed whatever codec they're given.
+
+SEGMENT_COMPRESS_DEFAULT ?= yay0
+
+# Hot level geometry: decompression speed matters more than size.
+# SEGMENT_COMPRESS.levels/castle_inside/leveldata := lz4t
+# SEGMENT_COMPRESS.levels/castle_grounds/leveldata := lz4t
+
+# Rarely loaded data: size matters more than speed.
+# SEGMENT_COMPRESS.levels/ending/leveldata := gzip
+# SEGMENT_COMPRESS.levels/intro/leveldata := gzip
+
+# Small or already dense data
+# SEGMENT_COMPRESS.bin/segment2 := uncomp
@@ -50,3 +50,47 @@
  * Reverb presets can be configured in audio/data.c to meet desired aesthetic/performance needs. More detailed usage info can also be found on the HackerSM64 Wiki page.
  */
 // #define BETTER_REVERB
+
+/**
+ * Runs the BETTER_REVERB filters on the RSP with a new audio microcode command (cmd_REVERB in rsp/audio.s, in place of the unused
+ * pole filter) instead of on the CPU, which frees up almost all of the CPU time BETTER_REVERB normally takes (requires BETTER_REVERB).
+ * Works with every preset, with these limits: delays must be at least 8 samples after downsampling, delay lines shorter than
+ * 160 samples still take up 160 samples of BETTER_REVERB_SIZE, and BETTER_REVERB_FILTER_COUNT_LIGHT must be 2.
+ * The output only differs from the CPU version when a filter clips, and by rounding when a mono preset merges both channels.
+ */
+// #define BETTER_REVERB_RSP
+
+/**
+ * Loads the next chunk of sample data for each playing note one audio frame before it is needed, and grows the shared sample DMA cache
+ * into whatever is left of the notes and buffers pool (US/JP only). Frequently hit cache entries are also kept around for longer.
+ * This reduces dropouts caused by PI contention when many notes are playing on console, at the cost of a little extra DMA traffic.
+ */
+// #define AUDIO_SAMPLE_PREFETCH
+
+/**
+ * Caches the final resample and envelope mixing commands of each note, and reuses them on audio updates where the note's pitch,
+ * volume and reverb did not change instead of rebuilding them (US/JP only). This saves some CPU time per audio update when
+ * many notes are held at once, which is most noticeable with a raised MAX_SIMULTANEOUS_NOTES.
+ */
+// #define AUDIO_SYNTHESIS_COMMAND_CACHE
+
+/**
+ * Keeps each note pool's active notes in one list per priority, so finding a note to steal when a pool runs out of voices
+ * no longer walks every playing note (US/JP only). Also counts how many notes each sequence channel has stolen or dropped,
+ * which is shown on the puppyprint audio page. Costs ~250 bytes of RAM per note pool (one per sequence channel and player).
+ */
+// #define AUDIO_NOTE_PRIORITY_BUCKETS
+
+/**
+ * Adds a streamed audio track that plays long recordings straight from ROM instead of through sequences and the audio heap (US/JP only).
+ * Streams are made with tools/audio_stream.py, included in sound/streams.s and played with audio_stream_play.
+ * Data is read in chunks through two 8KB buffers, so RAM usage stays the same regardless of the track's length.
+ */
+// #define AUDIO_STREAMING
+
+/**
+ * Tracks where each sequence and sound bank lives in the audio heap, how often it is loaded, evicted and looked up, and how long
+ * its loads take, along with the peak usage of each seq/bank pool (US/JP only). Shown on the "Audio Heap" puppyprint page, which
+ * can also dump everything over USB when building with UNF=1. Useful for sizing the pools in EXPAND_AUDIO_HEAP builds. Costs ~8KB of RAM.
+ */
+// #define AUDIO_HEAP_TELEMETRY
@@ -10,6 +10,20 @@
  */
 // #define ENABLE_CREDITS_BENCHMARK
 
+/**
+ * Records player 1's input from boot. Hold L and press D-Pad Left to stop, which writes the recording to SRAM
+ * (SAVETYPE=sram) and sends it over USB (UNF=1). tools/benchmark.py route turns it into src/game/benchmark/route.inc.c.
+ */
+// #define BENCHMARK_RECORD_INPUTS
+
+/**
+ * Replays the inputs in src/game/benchmark/route.inc.c from boot, starting from an empty save file, and records the
+ * CPU, RSP and RDP time and object count of every frame. When the route ends, the results are written to SRAM
+ * (SAVETYPE=sram, overwriting the save file) and sent over USB (UNF=1). tools/benchmark.py compare checks two runs
+ * against each other, so this can be run headless in an emulator with accurate RCP timings after every change.
+ */
+// #define BENCHMARK_REPLAY
+
 #ifdef ENABLE_CREDITS_BENCHMARK
     #define DEBUG_ALL
     #define ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS
@@ -24,6 +24,13 @@
  */
 #define USE_PROFILER
 
+/**
+ * Records the profiler's timings as a timeline of begin/end events in a ring buffer (32KB of RAM), including the audio thread and
+ * RSP tasks. Press L + D-Pad Down to send the last few seconds over USB, and convert the dump with tools/profiler_trace.py to a
+ * Chrome trace that can be opened in Perfetto or chrome://tracing. Requires USE_PROFILER and building with UNF=1.
+ */
+// #define PROFILER_TRACE
+
 /**
  * -- TEST LEVEL --
  * Uncomment this define and set a test level in order to boot straight into said level.
@@ -52,6 +59,35 @@
  */
 // #define PUPPYPRINT_DEBUG_CYCLES
 
+/**
+ * Samples the PC of whichever thread is running 2000 times a second, and lists the functions with the most samples on the
+ * "Hot Functions" page of Puppyprint Debug, to find hot spots that the profiler's sections don't cover.
+ * With UNF=1, press A on that page to print the whole table over USB. Requires PUPPYPRINT_DEBUG.
+ */
+// #define PC_SAMPLING_PROFILER
+
+/**
+ * Attributes RDP time to each render layer, or to the display lists of each object type, on the "RDP Breakdown" page of
+ * Puppyprint Debug. Each frame one layer or display list is wrapped in full syncs, whose interrupts read the RDP's
+ * counters, so the figures build up over a few seconds of a steady scene. Requires PUPPYPRINT_DEBUG.
+ */
+// #define RDP_BREAKDOWN_PROFILER
+
+/**
+ * Tags every allocation from the main pool, alloc-only pools and memory pools with the code that asked for it, and lists the
+ * live bytes, peak bytes, allocation counts and average lifetimes of each caller on the "Memory" puppyprint page. The page
+ * also draws a map of the main pool and the free lists of each memory pool, to show where RAM has gone and how fragmented
+ * the pools are. With UNF=1, press A on that page to print everything over USB. Costs ~20KB of RAM. Requires PUPPYPRINT_DEBUG.
+ */
+// #define MEMORY_ALLOC_TRACKER
+
+/**
+ * Attributes object update time to each behavior script on the "Behaviors" page of Puppyprint Debug. To name the behaviors,
+ * the symbol map is kept loaded at the end of RAM, which takes its size (a few hundred KB, depending on the build) off the
+ * main pool. Requires PUPPYPRINT_DEBUG.
+ */
+// #define BEHAVIOR_PROFILING
+
 /**
  * A vanilla style debug mode. It doesn't rely on a text engine, but it's much less powerful that PUPPYPRINT_DEBUG.
  * Press D-pad left to show the debug UI.
@@ -98,3 +98,10 @@
  * The levelscript needs to have a MARIO_POS command for this to work.
  */
 #define START_LEVEL LEVEL_CASTLE_GROUNDS
+
+/**
+ * Uses a two-level segregated fit (TLSF) allocator for memory pools (mem_pool_alloc/mem_pool_free) instead of a first-fit
+ * free list. Allocating and freeing take the same time however fragmented a pool gets, at the cost of ~200 bytes per pool
+ * for the free list heads and allocations rounded up to 8 bytes.
+ */
+// #define MEMORY_POOL_TLSF
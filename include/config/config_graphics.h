@@ -9,6 +9,24 @@
  */
 #define GFX_POOL_SIZE 10000
 
+/**
+ * Allocates the graphics pools from the main pool when a level is loaded instead of keeping them in .bss,
+ * sized per level from the table in include/gfx_pool_sizes.h. Levels not in the table get GFX_POOL_SIZE.
+ * Fill the table from a profiling run: the peak use of each level is shown on the puppyprint debug page,
+ * and with UNF=1 it's also printed over USB when the level is unloaded.
+ * Between levels a small static pool is used, so a level with a small table entry gives its RAM back to the level pool.
+ */
+// #define DYNAMIC_GFX_POOL
+
+/**
+ * Gives each of the two graphics pools a scratch arena of this many bytes for per-frame data like particle, painting,
+ * debug box and text vertices and matrices, which is otherwise taken from the end of the graphics pool. Allocations made
+ * with frame_alloc last until the arena is reset two frames later, like the display list they're drawn by.
+ * Running out triggers an assert with DEBUG_ASSERTIONS, and falls back to the graphics pool otherwise.
+ * The peak use is shown under the graphics pool use on the puppyprint debug page.
+ */
+// #define FRAME_ARENA_SIZE 0x2000
+
 /**
  * Causes the global light direction to be in world space,
  * this allows you to have a singular light source that doesn't change with the camera's rotation.
@@ -46,6 +64,14 @@
  */
 #define AUTO_LOD
 
+/**
+ * Watches how long the CPU and RDP take each frame. While frames run over budget, it lowers object draw distances,
+ * LOD distances, snow and bubble particle counts and how far away shadows are drawn, one step at a time, and raises
+ * them again once there is headroom. This keeps the frame rate steady in busy scenes on console.
+ * Gameplay is unaffected, since objects hidden this way still update. Enables USE_PROFILER, which it takes its times from.
+ */
+// #define FRAME_BUDGET_GOVERNOR
+
 /**
  * Enables Puppyprint, a display library for text and large images.
  * Automatically enabled when PUPPYPRINT_DEBUG is enabled.
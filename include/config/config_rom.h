@@ -54,3 +54,12 @@
  * Might break on some emulators. Use at your own risk, and don't use it unless you actually need the extra performance.
  */
 // #define RCVI_HACK
+
+/**
+ * Decompresses YAY0 and GZIP segments while they're still being read from ROM, instead of reading the whole
+ * compressed segment into the main pool first. This lowers the peak memory use while loading a segment: streaming needs
+ * 24KB of scratch memory (40KB for GZIP) rather than the size of the compressed segment, so only segments bigger than
+ * that are streamed. It's meant to save memory, not time: streamed YAY0 segments use a C decoder instead of the assembly one.
+ * Only works with COMPRESS=yay0, COMPRESS=gzip, or COMPRESS=mixed.
+ */
+// #define STREAMED_DECOMPRESSION
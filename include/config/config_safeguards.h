@@ -49,6 +49,30 @@
     #undef BETTER_REVERB
 #endif
 
+#if defined(BETTER_REVERB_RSP) && !defined(BETTER_REVERB)
+    #undef BETTER_REVERB_RSP
+#endif
+
+#if defined(AUDIO_SAMPLE_PREFETCH) && !(defined(VERSION_US) || defined(VERSION_JP))
+    #undef AUDIO_SAMPLE_PREFETCH
+#endif
+
+#if defined(AUDIO_SYNTHESIS_COMMAND_CACHE) && !(defined(VERSION_US) || defined(VERSION_JP))
+    #undef AUDIO_SYNTHESIS_COMMAND_CACHE
+#endif
+
+#if defined(AUDIO_NOTE_PRIORITY_BUCKETS) && !(defined(VERSION_US) || defined(VERSION_JP))
+    #undef AUDIO_NOTE_PRIORITY_BUCKETS
+#endif
+
+#if defined(AUDIO_STREAMING) && !(defined(VERSION_US) || defined(VERSION_JP))
+    #undef AUDIO_STREAMING
+#endif
+
+#if defined(AUDIO_HEAP_TELEMETRY) && !(defined(VERSION_US) || defined(VERSION_JP))
+    #undef AUDIO_HEAP_TELEMETRY
+#endif
+
 /*****************
  * config_debug.h
  */
@@ -107,6 +131,42 @@
     #define USE_PROFILER
 #endif // PUPPYPRINT_DEBUG
 
+#if defined(PC_SAMPLING_PROFILER) && !defined(PUPPYPRINT_DEBUG)
+    #undef PC_SAMPLING_PROFILER
+#endif // PC_SAMPLING_PROFILER
+
+#if defined(RDP_BREAKDOWN_PROFILER) && !defined(PUPPYPRINT_DEBUG)
+    #undef RDP_BREAKDOWN_PROFILER
+#endif // RDP_BREAKDOWN_PROFILER
+
+#if defined(MEMORY_ALLOC_TRACKER) && !defined(PUPPYPRINT_DEBUG)
+    #undef MEMORY_ALLOC_TRACKER
+#endif // MEMORY_ALLOC_TRACKER
+
+#if defined(BEHAVIOR_PROFILING) && !defined(PUPPYPRINT_DEBUG)
+    #undef BEHAVIOR_PROFILING
+#endif // BEHAVIOR_PROFILING
+
+#if defined(PROFILER_TRACE) && !(defined(USE_PROFILER) && defined(UNF))
+    #undef PROFILER_TRACE
+#endif // PROFILER_TRACE
+
+#ifdef BENCHMARK_REPLAY
+    #undef USE_PROFILER
+    #define USE_PROFILER
+    #undef BENCHMARK_RECORD_INPUTS
+    #undef FRAME_BUDGET_GOVERNOR
+#endif // BENCHMARK_REPLAY
+
+#ifdef FRAME_BUDGET_GOVERNOR
+    #undef USE_PROFILER
+    #define USE_PROFILER
+#endif // FRAME_BUDGET_GOVERNOR
+
+#if (defined(BENCHMARK_RECORD_INPUTS) || defined(BENCHMARK_REPLAY)) && !defined(SRAM) && !defined(UNF)
+    #error "Input recording and replay benchmarks need somewhere to write to: build with SAVETYPE=sram or UNF=1."
+#endif
+
 #ifdef COMPLETE_SAVE_FILE
     #undef UNLOCK_ALL
     #define UNLOCK_ALL
@@ -195,3 +255,7 @@
     #undef BORDER_HEIGHT_EMULATOR
     #define BORDER_HEIGHT_EMULATOR 0
 #endif // !TARGET_N64
+
+#if defined(STREAMED_DECOMPRESSION) && !(defined(YAY0) || defined(GZIP) || defined(COMPRESS_MIXED))
+    #undef STREAMED_DECOMPRESSION
+#endif // STREAMED_DECOMPRESSION
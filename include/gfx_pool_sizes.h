@@ -0,0 +1,8 @@
+// Graphics pool size of each level, in Gfx commands, used with DYNAMIC_GFX_POOL.
+// Use the peak measured while playing through the level (see DYNAMIC_GFX_POOL in config_graphics.h).
+// 1/8 is added on top for headroom. Levels that aren't listed get GFX_POOL_SIZE.
+// GFX_POOL_LEVEL_SIZE(level, size)
+
+// GFX_POOL_LEVEL_SIZE(LEVEL_CASTLE_GROUNDS, 7000)
+// GFX_POOL_LEVEL_SIZE(LEVEL_BOB,            6500)
+// GFX_POOL_LEVEL_SIZE(LEVEL_PSS,            3000)
@@ -54,6 +54,8 @@ extern int	flush_window(void);
 //
 //
 u32   expand_gzip(u8 *src_addr, u8 *dst_addr, u32 size, u32 outbytes_limit);
+#define GZIP_STREAM_WINDOW_SIZE 0x8000 // 1 << MAX_WBITS
+s32   expand_gzip_stream(u8 *(*fill)(void *arg, u32 *length), void *arg, void *window, u8 *dst_addr, u32 outbytes_limit);
 
 
 #endif
@@ -26,6 +26,14 @@ A_NOAUX    equ 0x00
 A_MAIN     equ 0x00
 A_MIX      equ 0x10
 
+// cmd_REVERB, see struct BetterReverbRspParams in synthesis.h
+REVERB_HISTORY     equ 0x00  // previous output sample of the lightweight network
+REVERB_FILTERS     equ 0x10  // delay lines
+REVERB_COEFS       equ 0xd0  // feedback and filter coefficients
+REVERB_PARAMS_SIZE equ 0x1a0
+REVERB_WINDOW_SIZE equ 0x290 // DMEM used by each delay line being processed
+REVERB_WINDOW_NEW  equ 0x150 // new samples in a window, after up to 0x146 bytes of history
+
 .create DATA_FILE, 0x0000
 
 .dh 0x0000, 0x0001, 0x0002, 0xffff, 0x0020, 0x0800, 0x7fff, 0x4000 // 0x00000000
@@ -84,7 +92,7 @@ dispatchTable:
   jumpTableEntry cmd_LOADADPCM
   jumpTableEntry cmd_MIXER
   jumpTableEntry cmd_INTERLEAVE
-  jumpTableEntry cmd_POLEF
+  jumpTableEntry cmd_REVERB
   jumpTableEntry cmd_SETLOOP
 .endif
 
@@ -180,6 +188,10 @@ audio_wet_gain      equ 0x1e // 0x37e
 .definelabel dmemBase,      0x5c0 // all samples stored that is transferred to DMEM
 .definelabel tmpData,       0xF90 // temporary area
 
+// cmd_REVERB scratch, this has to match the DMEM_ADDR_REVERB_* defines in synthesis.c
+.definelabel reverbParams,  dmemBase + 0x280 // parameter block
+.definelabel reverbWindows, dmemBase + 0x420 // one window per delay line being processed, two at most
+
 .close // DATA_FILE
 
 
@@ -753,115 +765,231 @@ cmd_ADPCM:
     j     cmd_SPNOOP
      mtc0  $zero, SP_SEMAPHORE
 
-cmd_POLEF: // unused by SM64
 .ifndef VERSION_SH
-    lqv   $v31[0], 0x0000($zero)
-    vxor  $v28, $v28, $v28
-    lhu   $21, (audio_in_buf)($24)
-    vxor  $v17, $v17, $v17
-    lhu   $20, (audio_out_buf)($24)
-    vxor  $v18, $v18, $v18
-    lhu   $19, (audio_count)($24)
-    vxor  $v19, $v19, $v19
-    beqz  $19, @@audio_04001874
-     andi  $14, $26, 0xffff
-    mtc2  $14, $v31[10]
-    sll   $14, $14, 2
-    mtc2  $14, $v16[0]
-    lui   $1, 0x00ff
-    vxor  $v20, $v20, $v20
-    ori   $1, $1, 0xffff
-    vxor  $v21, $v21, $v21
-    and   $18, $25, $1
-    vxor  $v22, $v22, $v22
-    srl   $2, $25, 24
-    vxor  $v23, $v23, $v23
-    sll   $2, $2, 2
-    lw    $3, (segmentTable)($2)
-    add   $18, $18, $3
-    slv   $v28[0], 0x00($23)
-    srl   $1, $26, 16
-    andi  $1, $1, 0x0001
-    bgtz  $1, @@audio_040017a0
-     nop
-    addi  $1, $23, 0x0000
-    addi  $2, $18, 0x0000
+// BETTER_REVERB filter network, used in place of the pole filter command which SM64 doesn't use.
+// Filters audio_count bytes of samples at audio_in_buf and adds the result to audio_out_buf (the lightweight network
+// replaces audio_in_buf with its output instead). The low 16 bits of w0 are the filter count << 4, plus 1 for the
+// lightweight network. w1 is the segmented address of a struct BetterReverbRspParams (see synthesis.h), of which
+// the part up to REVERB_COEFS is written back at the end.
+//
+// Every filter is (history = delayed sample, carryover = input to the filter):
+//     new sample    = carryover + history * coefs[0]
+//     output       += history * coefs[3]
+//     next carryover = history * coefs[1] + new sample * coefs[2]
+// with Q8 coefficients stored as (x & 0xff) << 8 and x >> 8 pairs, which covers both all-pass and comb filters.
+// The standard network runs one filter at a time over vectors of 8 samples, so every delay has to be at least 8
+// samples. The input is first mixed with the history of the last filter the same way, so the work is split into
+// chunks no longer than the last filter's delay. The lightweight network feeds every output sample back into the
+// next one, so it goes through its two delay lines one sample at a time instead.
+cmd_REVERB:
+    sll   $2, $25, 8
+    srl   $2, $2, 8
+    srl   $4, $25, 24
+    sll   $4, $4, 2
+    lw    $5, (segmentTable)($4)
+    add   $2, $2, $5
+    addi  $21, $2, 0
+    addi  $1, $zero, reverbParams
     jal   dma_read_start
-     addi  $3, $zero, 7
-.endif
+     addi  $3, $zero, REVERB_PARAMS_SIZE - 1
 @@dma_read_busy:
-.ifndef VERSION_SH
     mfc0  $5, SP_DMA_BUSY
     bnez  $5, @@dma_read_busy
      nop
     mtc0  $zero, SP_SEMAPHORE
-.endif
-@@audio_040017a0:
-.ifndef VERSION_SH
-    addi  $13, $zero, adpcmTable
-    addi  $1, $zero, 0x0004
-    mtc2  $1, $v14[0]
-    lqv   $v24[0], 0x0010($13)
-    vmudm $v16, $v24, $v16[0]
-    ldv   $v28[8], 0x00($23)
-    sqv   $v16[0], 0x10($13)
-    lqv   $v25[0], 0x00($13)
-    addi  $13, $13, -2
-    lrv   $v23[0], 0x20($13)
-    addi  $13, $13, -2
-    lrv   $v22[0], 0x20($13)
-    addi  $13, $13, -2
-    lrv   $v21[0], 0x20($13)
-    addi  $13, $13, -2
-    lrv   $v20[0], 0x20($13)
-    addi  $13, $13, -2
-    lrv   $v19[0], 0x20($13)
-    addi  $13, $13, -2
-    lrv   $v18[0], 0x20($13)
-    addi  $13, $13, -2
-    lrv   $v17[0], 0x20($13)
-    ldv   $v30[0], 0x00($21)
-    ldv   $v30[8], 0x08($21)
-.endif
-@@audio_04001800:
-.ifndef VERSION_SH
-    vmudh $v16, $v25, $v28[6]
-    addi  $21, $21, 0x10
-    vmadh $v16, $v24, $v28[7]
-    addi  $19, $19, -0x10
-    vmadh $v16, $v23, $v30[0]
-    vmadh $v16, $v22, $v30[1]
-    vmadh $v16, $v21, $v30[2]
-    vmadh $v16, $v20, $v30[3]
-    vmadh $v28, $v19, $v30[4]
-    vmadh $v16, $v18, $v30[5]
-    vmadh $v16, $v17, $v30[6]
-    vmadh $v16, $v30, $v31[5]
-    ldv   $v30[0], 0x00($21)
-    vsar  $v26, $v15, $v28[1]
-    ldv   $v30[8], 0x08($21)
-    vsar  $v28, $v15, $v28[0]
-    vmudn $v16, $v26, $v14[0]
-    vmadh $v28, $v28, $v14[0]
-    sdv   $v28[0], 0x00($20)
-    sdv   $v28[8], 0x08($20)
-    bgtz  $19, @@audio_04001800
-     addi  $20, $20, 0x10
-    addi  $1, $20, -8
-    addi  $2, $18, 0x00
+    lqv   $v31[0], 0x00($zero)         // element 1 is 1
+    lhu   $18, (audio_count)($24)
+    lhu   $15, (audio_in_buf)($24)
+    lhu   $14, (audio_out_buf)($24)
+    addi  $19, $zero, reverbWindows
+    addi  $20, $zero, reverbParams + REVERB_FILTERS
+    addi  $22, $zero, reverbParams + REVERB_COEFS
+    andi  $13, $26, 0xfff0
+    andi  $5, $26, 0x0001
+    bnez  $5, @@lightweight
+     add   $13, $13, $20               // end of the filters
+    lhu   $25, -0x08($13)              // last delay, rounded down to whole vectors
+    andi  $25, $25, 0xfff0
+    addi  $26, $18, 0
+@@chunk:
+    sub   $1, $26, $25
+    blez  $1, @@chunk_size
+     addi  $18, $26, 0
+    addi  $18, $25, 0
+@@chunk_size:
+    addi  $22, $zero, reverbParams + REVERB_COEFS
+    addi  $20, $13, -0x10              // mix in the history of the last filter first
+@@filter:
+    jal   reverb_load_window
+     lqv   $v4[0], 0x00($22)
+    addi  $1, $15, 0
+    addi  $7, $14, 0
+    addi  $3, $18, 0
+@@vector:
+    lqv   $v1[0], 0x00($16)            // history
+    lrv   $v1[0], 0x10($16)
+    lqv   $v2[0], 0x00($1)             // carryover
+    lqv   $v5[0], 0x00($7)             // output
+    vmudh $v3, $v2, $v31[1]
+    vmadm $v3, $v1, $v4[0]
+    vmadh $v2, $v1, $v4[1]             // new sample
+    vmudh $v3, $v5, $v31[1]
+    vmadm $v3, $v1, $v4[6]
+    vmadh $v5, $v1, $v4[7]
+    sqv   $v2[0], 0x00($17)
+    vmudm $v3, $v1, $v4[2]
+    vmadh $v3, $v1, $v4[3]
+    vmadm $v3, $v2, $v4[4]
+    vmadh $v2, $v2, $v4[5]             // next carryover
+    sqv   $v5[0], 0x00($7)
+    addi  $16, $16, 0x10
+    addi  $17, $17, 0x10
+    addi  $7, $7, 0x10
+    addi  $3, $3, -0x10
+    sqv   $v2[0], 0x00($1)
+    bgtz  $3, @@vector
+     addi  $1, $1, 0x10
+    addi  $5, $22, -(reverbParams + REVERB_COEFS)
+    beqz  $5, @@next_filter            // the delay line isn't written when mixing in its history
+     addi  $22, $22, 0x10
+    jal   reverb_save_window
+     nop
+@@next_filter:
+    addi  $20, $22, REVERB_FILTERS - REVERB_COEFS - 0x10
+    bne   $20, $13, @@filter
+     nop
+    add   $15, $15, $18
+    sub   $26, $26, $18
+    bgtz  $26, @@chunk
+     add   $14, $14, $18
+@@done:
+    addi  $1, $zero, reverbParams
+    addi  $2, $21, 0
     jal   dma_write_start
-     addi  $3, $zero, 7
-.endif
+     addi  $3, $zero, REVERB_COEFS - 1
 @@dma_write_busy:
-.ifndef VERSION_SH
     mfc0  $5, SP_DMA_BUSY
     bnez  $5, @@dma_write_busy
      nop
-.endif
-@@audio_04001874:
-.ifndef VERSION_SH
     j     cmd_SPNOOP
      mtc0  $zero, SP_SEMAPHORE
+
+@@lightweight:
+    jal   reverb_load_window           // first all-pass filter
+     nop
+    addi  $25, $16, 0
+    addi  $26, $17, 0
+    addi  $20, $20, 0x10
+    jal   reverb_load_window           // second all-pass filter
+     addi  $19, $19, REVERB_WINDOW_SIZE
+    lqv   $v7[0], 0x00($22)            // feedback
+    lqv   $v4[0], 0x10($22)            // both all-pass filters use the same coefficients
+    lsv   $v2[0], (REVERB_HISTORY - REVERB_FILTERS - 0x10)($20)
+    addi  $3, $18, 0
+@@sample:
+    lsv   $v5[0], 0x00($15)
+    vmudh $v3, $v5, $v31[1]
+    vmadm $v3, $v2, $v7[0]
+    vmadh $v2, $v2, $v7[1]             // input + previous output * reverb index
+    lsv   $v1[0], 0x00($25)
+    vmudh $v3, $v2, $v31[1]
+    vmadm $v3, $v1, $v4[0]
+    vmadh $v2, $v1, $v4[1]
+    ssv   $v2[0], 0x00($26)
+    vmudm $v3, $v1, $v4[2]
+    vmadh $v3, $v1, $v4[3]
+    vmadm $v3, $v2, $v4[4]
+    vmadh $v2, $v2, $v4[5]
+    lsv   $v1[0], 0x00($16)
+    vmudh $v3, $v2, $v31[1]
+    vmadm $v3, $v1, $v4[0]
+    vmadh $v2, $v1, $v4[1]
+    ssv   $v2[0], 0x00($17)
+    vmudm $v3, $v1, $v4[2]
+    vmadh $v3, $v1, $v4[3]
+    vmadm $v3, $v2, $v4[4]
+    vmadh $v2, $v2, $v4[5]
+    ssv   $v2[0], 0x00($15)
+    addi  $15, $15, 2
+    addi  $25, $25, 2
+    addi  $26, $26, 2
+    addi  $16, $16, 2
+    addi  $3, $3, -2
+    bgtz  $3, @@sample
+     addi  $17, $17, 2
+    ssv   $v2[0], (REVERB_HISTORY - REVERB_FILTERS - 0x10)($20)
+    jal   reverb_save_window
+     nop
+    addi  $20, $20, -0x10
+    ori   $ra, $zero, @@done & 0xffff
+    j     reverb_save_window
+     addi  $19, $19, -REVERB_WINDOW_SIZE
+
+// Loads the history for a chunk of $18 bytes of the filter at $20 into the window at $19.
+// Returns the history in $16 and where the chunk's new samples go in $17, which directly follows it when the delay
+// is shorter than the chunk.
+reverb_load_window:
+    lw    $8, 0x00($20)                // delay line
+    lhu   $9, 0x04($20)                // delay line size
+    lhu   $2, 0x06($20)                // write position
+    lhu   $5, 0x08($20)                // delay
+    sub   $6, $5, $18
+    blez  $6, @@short_delay
+     addi  $7, $5, 0
+    andi  $6, $6, 0x6                  // keep the history as aligned as the delay line for DMA
+    add   $7, $18, $6
+@@short_delay:
+    addi  $17, $19, REVERB_WINDOW_NEW
+    sub   $16, $17, $7
+    sub   $2, $2, $5                   // read position
+    bgez  $2, @@no_wrap
+     addi  $1, $16, 0
+    add   $2, $2, $9
+@@no_wrap:
+    addi  $3, $7, 7                    // DMA rounds the start down to 8 bytes
+    j     reverb_ring_dma
+     ori   $10, $zero, dma_read_start & 0xffff
+
+// Stores the chunk's new samples from the window at $19 at the write position of the filter at $20, and advances it.
+reverb_save_window:
+    lw    $8, 0x00($20)
+    lhu   $9, 0x04($20)
+    lhu   $2, 0x06($20)
+    add   $5, $2, $18
+    sub   $6, $5, $9
+    bltz  $6, @@no_wrap
+     addi  $1, $19, REVERB_WINDOW_NEW
+    addi  $5, $6, 0
+@@no_wrap:
+    sh    $5, 0x06($20)
+    addi  $3, $18, 0
+    ori   $10, $zero, dma_write_start & 0xffff
+
+// DMAs $3 bytes between DMEM $1 and offset $2 of the delay line at $8 that is $9 bytes long, wrapping around at its end.
+// $10 is dma_read_start or dma_write_start.
+reverb_ring_dma:
+    addi  $11, $ra, 0
+    add   $12, $2, $3
+    sub   $12, $12, $9                 // bytes past the end
+    blez  $12, @@last
+     add   $2, $2, $8
+    sub   $3, $3, $12
+    jalr  $10
+     addi  $3, $3, -1
+    mtc0  $zero, SP_SEMAPHORE
+    add   $1, $1, $3
+    addi  $1, $1, 1
+    addi  $2, $8, 0
+    addi  $3, $12, 0
+@@last:
+    jalr  $10
+     addi  $3, $3, -1
+@@dma_busy:
+    mfc0  $4, SP_DMA_BUSY
+    bnez  $4, @@dma_busy
+     nop
+    jr    $11
+     mtc0  $zero, SP_SEMAPHORE
 .endif
 
 cmd_RESAMPLE:
@@ -1893,4 +2021,8 @@ cmd_RESAMPLE_ZOH:
      nop
 .endif
 
+.if . > 0x04002000
+    .error "audio microcode doesn't fit in IMEM"
+.endif
+
 .close // CODE_FILE
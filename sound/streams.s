@@ -0,0 +1,10 @@
+.include "macros.inc"
+
+.section .data
+
+// Streamed audio tracks (AUDIO_STREAMING), made with tools/audio_stream.py.
+// This section is only placed in ROM, so each label is the ROM address to pass to audio_stream_play:
+//
+// .balign 16
+// glabel gStreamExample
+// .incbin "sound/streams/example.stream"
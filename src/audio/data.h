@@ -158,7 +158,7 @@ extern u32 gAudioRandom;
     + (DMA_BUF_SIZE_0 * 3) \
     + DMA_BUF_SIZE_1 \
     + ALIGN16(sizeof(struct NoteSynthesisBuffers))) \
-    + (320 * 2 * sizeof(u64)) /* gMaxAudioCmds */ \
+    + ((320 + 4 /* updatesPerFrame */ * (BETTER_REVERB_RSP_MAX_CMDS_PER_UPDATE + AUDIO_STREAM_MAX_CMDS_PER_UPDATE)) * 2 * sizeof(u64)) /* gMaxAudioCmds */ \
 )
 #else // Probably SH incompatible but that's an entirely different headache to save at this point tbh
 #define NOTES_BUFFER_SIZE \
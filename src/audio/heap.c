@@ -4,12 +4,16 @@
 #include "data.h"
 #include "load.h"
 #include "synthesis.h"
+#include "stream.h"
 #include "seqplayer.h"
 #include "effects.h"
 #include "game/emutest.h"
 #include "game/puppyprint.h"
 #include "game/debug.h"
 #include "string.h"
+#if defined(AUDIO_HEAP_TELEMETRY) && defined(UNF)
+#include "usb/debug.h"
+#endif
 
 struct PoolSplit {
     u32 wantSeq;
@@ -165,6 +169,151 @@ void build_vol_rampings_table(s32 UNUSED unused, s32 len) {
 }
 #endif
 
+#ifdef AUDIO_HEAP_TELEMETRY
+struct AudioHeapTelemetry gAudioHeapTelemetry;
+
+static s32 audio_heap_kind(struct SoundMultiPool *multiPool) {
+    return (multiPool == &gBankLoadedPool) ? AUDIO_HEAP_BANK : AUDIO_HEAP_SEQ;
+}
+
+static struct AudioHeapEntryStats *audio_heap_entry_stats(struct SoundMultiPool *multiPool, s32 id) {
+    if (multiPool == &gBankLoadedPool) {
+        return &gAudioHeapTelemetry.banks[id];
+    }
+    return &gAudioHeapTelemetry.seqs[id];
+}
+
+/**
+ * Bytes in use in one half of a seq or bank pool. The temporary pool is allocated from both ends,
+ * so its usage is the size of its two entries rather than how far pool.cur has moved.
+ */
+u32 audio_heap_pool_used(struct SoundMultiPool *multiPool, s32 poolType) {
+    struct TemporaryPool *tp = &multiPool->temporary;
+    u32 used = 0;
+
+    if (poolType == AUDIO_HEAP_POOL_PERSISTENT) {
+        return multiPool->persistent.pool.cur - multiPool->persistent.pool.start;
+    }
+
+    if (tp->entries[0].id != -1) {
+        used += tp->entries[0].size;
+    }
+    if (tp->entries[1].id != -1) {
+        used += tp->entries[1].size;
+    }
+    return used;
+}
+
+static void audio_heap_telemetry_alloc(struct SoundMultiPool *multiPool, s32 id, u32 size, s32 residence) {
+    struct AudioHeapEntryStats *entry = audio_heap_entry_stats(multiPool, id);
+    s32 poolType = (residence == AUDIO_HEAP_PERSISTENT) ? AUDIO_HEAP_POOL_PERSISTENT : AUDIO_HEAP_POOL_TEMPORARY;
+    struct AudioHeapPoolStats *pool = &gAudioHeapTelemetry.pools[audio_heap_kind(multiPool)][poolType];
+    u32 used = audio_heap_pool_used(multiPool, poolType);
+
+    entry->size = size;
+    entry->loadStart = osGetCount() | 1; // Never 0 while loading
+    entry->loads++;
+    entry->residence = residence;
+
+    if (used > pool->peakUsed) {
+        pool->peakUsed = used;
+    }
+}
+
+// Called when a temporary pool entry is thrown out to make room for another one.
+static void audio_heap_telemetry_evict(struct SoundMultiPool *multiPool, s32 id, u8 loadStatus) {
+    struct AudioHeapEntryStats *entry = audio_heap_entry_stats(multiPool, id);
+
+    entry->residence = AUDIO_HEAP_NOT_RESIDENT;
+    entry->loadStart = 0;
+
+    if (loadStatus != SOUND_LOAD_STATUS_NOT_LOADED) {
+        entry->evictions++;
+        gAudioHeapTelemetry.pools[audio_heap_kind(multiPool)][AUDIO_HEAP_POOL_TEMPORARY].evictions++;
+    }
+}
+
+static void audio_heap_telemetry_fail(struct SoundMultiPool *multiPool, s32 poolType) {
+    gAudioHeapTelemetry.pools[audio_heap_kind(multiPool)][poolType].failedAllocs++;
+}
+
+/**
+ * Records how long a sequence or bank took to load, from its allocation to its data being ready.
+ */
+void audio_heap_telemetry_load_done(struct SoundMultiPool *multiPool, s32 id) {
+    struct AudioHeapEntryStats *entry = audio_heap_entry_stats(multiPool, id);
+    u32 cycles;
+
+    if (entry->loadStart == 0) {
+        return;
+    }
+
+    cycles = osGetCount() - entry->loadStart;
+    entry->lastLoadCycles = cycles;
+    if (cycles > entry->maxLoadCycles) {
+        entry->maxLoadCycles = cycles;
+    }
+    entry->loadStart = 0;
+}
+
+// Pools are emptied on session resets, but the load and eviction counts are kept.
+static void audio_heap_telemetry_reset_residency(void) {
+    u32 i;
+
+    for (i = 0; i < ARRAY_COUNT(gAudioHeapTelemetry.seqs); i++) {
+        gAudioHeapTelemetry.seqs[i].residence = AUDIO_HEAP_NOT_RESIDENT;
+        gAudioHeapTelemetry.seqs[i].loadStart = 0;
+    }
+    for (i = 0; i < ARRAY_COUNT(gAudioHeapTelemetry.banks); i++) {
+        gAudioHeapTelemetry.banks[i].residence = AUDIO_HEAP_NOT_RESIDENT;
+        gAudioHeapTelemetry.banks[i].loadStart = 0;
+    }
+}
+
+#ifdef UNF
+/**
+ * Prints the pool and per sequence/bank stats over USB as comma separated lines.
+ */
+void audio_heap_telemetry_dump(void) {
+    static const char *kindNames[AUDIO_HEAP_KIND_COUNT] = { "seq", "bank" };
+    static const char *poolTypeNames[AUDIO_HEAP_POOL_TYPE_COUNT] = { "persistent", "temporary" };
+    static const char residenceNames[] = "-PLR";
+    struct SoundMultiPool *multiPools[AUDIO_HEAP_KIND_COUNT] = { &gSeqLoadedPool, &gBankLoadedPool };
+    s32 kind, poolType;
+    u32 i;
+
+    osSyncPrintf("audio_heap_pool,kind,pool,size,used,peak,evictions,failed,overflows\n");
+    for (kind = 0; kind < AUDIO_HEAP_KIND_COUNT; kind++) {
+        for (poolType = 0; poolType < AUDIO_HEAP_POOL_TYPE_COUNT; poolType++) {
+            struct AudioHeapPoolStats *pool = &gAudioHeapTelemetry.pools[kind][poolType];
+            u32 size = (poolType == AUDIO_HEAP_POOL_PERSISTENT) ? multiPools[kind]->persistent.pool.size
+                                                                 : multiPools[kind]->temporary.pool.size;
+
+            osSyncPrintf("audio_heap_pool,%s,%s,%d,%d,%d,%d,%d,%d\n", kindNames[kind], poolTypeNames[poolType], size,
+                         audio_heap_pool_used(multiPools[kind], poolType), pool->peakUsed, pool->evictions,
+                         pool->failedAllocs, pool->overflows);
+        }
+    }
+
+    osSyncPrintf("audio_heap_entry,kind,id,residence,size,loads,evictions,hits,last_load_us,max_load_us\n");
+    for (kind = 0; kind < AUDIO_HEAP_KIND_COUNT; kind++) {
+        u32 count = (kind == AUDIO_HEAP_SEQ) ? ARRAY_COUNT(gAudioHeapTelemetry.seqs) : ARRAY_COUNT(gAudioHeapTelemetry.banks);
+
+        for (i = 0; i < count; i++) {
+            struct AudioHeapEntryStats *entry = audio_heap_entry_stats(multiPools[kind], i);
+
+            if (entry->loads == 0) {
+                continue;
+            }
+            osSyncPrintf("audio_heap_entry,%s,%d,%c,%d,%d,%d,%d,%d,%d\n", kindNames[kind], i,
+                         residenceNames[entry->residence], entry->size, entry->loads, entry->evictions, entry->hits,
+                         (u32) OS_CYCLES_TO_USEC(entry->lastLoadCycles), (u32) OS_CYCLES_TO_USEC(entry->maxLoadCycles));
+        }
+    }
+}
+#endif
+#endif
+
 void reset_bank_and_seq_load_status(void) {
 #ifdef VERSION_SH
     bzero(&gBankLoadStatus, sizeof(gBankLoadStatus));
@@ -174,6 +323,9 @@ void reset_bank_and_seq_load_status(void) {
     bzero(&gBankLoadStatus, sizeof(gBankLoadStatus)); // Setting this array to zero is equivilent to SOUND_LOAD_STATUS_NOT_LOADED
     bzero(&gSeqLoadStatus,  sizeof(gSeqLoadStatus));  // Same dealio
 #endif
+#ifdef AUDIO_HEAP_TELEMETRY
+    audio_heap_telemetry_reset_residency();
+#endif
 }
 
 void discard_bank(s32 bankId) {
@@ -482,6 +634,9 @@ size = ALIGN16(size);
             tp->nextSide = 1;
         } else {
             // Both left and right sides are being loaded into.
+#ifdef AUDIO_HEAP_TELEMETRY
+            audio_heap_telemetry_fail(arg0, AUDIO_HEAP_POOL_TEMPORARY);
+#endif
             return NULL;
         }
 #else
@@ -618,6 +773,9 @@ size = ALIGN16(size);
 
         pool = &arg0->temporary.pool;
         if (tp->entries[tp->nextSide].id != (s8)nullID) {
+#ifdef AUDIO_HEAP_TELEMETRY
+            audio_heap_telemetry_evict(arg0, tp->entries[tp->nextSide].id, table[tp->entries[tp->nextSide].id]);
+#endif
             table[tp->entries[tp->nextSide].id] = SOUND_LOAD_STATUS_NOT_LOADED;
             if (isSound == TRUE) {
                 discard_bank(tp->entries[tp->nextSide].id);
@@ -640,6 +798,9 @@ size = ALIGN16(size);
 
                     // Throw out the entry on the other side if it doesn't fit.
                     // (possible @bug: what if it's currently being loaded?)
+#ifdef AUDIO_HEAP_TELEMETRY
+                    audio_heap_telemetry_evict(arg0, tp->entries[1].id, table[tp->entries[1].id]);
+#endif
                     table[tp->entries[1].id] = SOUND_LOAD_STATUS_NOT_LOADED;
                     if (isSound) {
                         discard_bank(tp->entries[1].id);
@@ -669,6 +830,9 @@ size = ALIGN16(size);
                 if (tp->entries[1].ptr < pool->cur) {
                     eu_stubbed_printf_0("WARNING: After Area Overlaid Before.");
 
+#ifdef AUDIO_HEAP_TELEMETRY
+                    audio_heap_telemetry_evict(arg0, tp->entries[0].id, table[tp->entries[0].id]);
+#endif
                     table[tp->entries[0].id] = SOUND_LOAD_STATUS_NOT_LOADED;
 
                     if (isSound) {
@@ -688,6 +852,10 @@ size = ALIGN16(size);
                 return NULL;
         }
 
+#ifdef AUDIO_HEAP_TELEMETRY
+        audio_heap_telemetry_alloc(arg0, id, size, AUDIO_HEAP_TEMPORARY_LEFT + tp->nextSide);
+#endif
+
         // Switch sides for next time in case both entries are
         // SOUND_LOAD_STATUS_DISCARDABLE.
         tp->nextSide ^= 1;
@@ -717,6 +885,9 @@ size = ALIGN16(size);
 #elif defined(VERSION_SH)
                 return alloc_bank_or_seq(poolIdx, size, 0, id);
 #else
+#ifdef AUDIO_HEAP_TELEMETRY
+                gAudioHeapTelemetry.pools[audio_heap_kind(arg0)][AUDIO_HEAP_POOL_PERSISTENT].overflows++;
+#endif
                 // Prevent tail call optimization.
                 ret = alloc_bank_or_seq(arg0, arg1, size, 0, id);
                 return ret;
@@ -727,6 +898,9 @@ size = ALIGN16(size);
 #endif
 #ifdef VERSION_EU
                 eu_stubbed_printf_1("MEMORY:StayHeap OVERFLOW (REQ:%d)", arg1 * size);
+#endif
+#ifdef AUDIO_HEAP_TELEMETRY
+                audio_heap_telemetry_fail(arg0, AUDIO_HEAP_POOL_PERSISTENT);
 #endif
                 return NULL;
         }
@@ -736,6 +910,9 @@ size = ALIGN16(size);
     // Because the buffer is small enough that more don't fit?
     arg0->persistent.entries[arg0->persistent.numEntries].id = id;
     arg0->persistent.entries[arg0->persistent.numEntries].size = size;
+#ifdef AUDIO_HEAP_TELEMETRY
+    audio_heap_telemetry_alloc(arg0, id, size, AUDIO_HEAP_PERSISTENT);
+#endif
 #if defined(VERSION_EU) || defined(VERSION_SH)
     return arg0->persistent.entries[arg0->persistent.numEntries++].ptr;
 #else
@@ -811,9 +988,15 @@ void *get_bank_or_seq(struct SoundMultiPool *arg0, s32 arg1, s32 id) {
         // Try not to overwrite sound that we have just accessed, by setting nextSide appropriately.
         if (temporary->entries[0].id == id) {
             temporary->nextSide = 1;
+#ifdef AUDIO_HEAP_TELEMETRY
+            audio_heap_entry_stats(arg0, id)->hits++;
+#endif
             return temporary->entries[0].ptr;
         } else if (temporary->entries[1].id == id) {
             temporary->nextSide = 0;
+#ifdef AUDIO_HEAP_TELEMETRY
+            audio_heap_entry_stats(arg0, id)->hits++;
+#endif
             return temporary->entries[1].ptr;
         }
         eu_stubbed_printf_1("Auto Heap Unhit for ID %d\n", id);
@@ -823,6 +1006,9 @@ void *get_bank_or_seq(struct SoundMultiPool *arg0, s32 arg1, s32 id) {
         for (i = 0; i < persistent->numEntries; i++) {
             if (id == persistent->entries[i].id) {
                 //eu_stubbed_printf_2("Cache hit %d at stay %d\n", id, i);
+#ifdef AUDIO_HEAP_TELEMETRY
+                audio_heap_entry_stats(arg0, id)->hits++;
+#endif
                 return persistent->entries[i].ptr;
             }
         }
@@ -1189,6 +1375,9 @@ void audio_reset_session(s32 reverbPresetId) {
             reset_bank_and_seq_load_status();
 
             init_reverb_us(reverbPresetId);
+#ifdef AUDIO_STREAMING
+            audio_stream_reset();
+#endif
             bzero(&gAiBuffers[0][0], (AIBUFFER_LEN * NUMAIBUFFERS));
 
             if (gAudioLoadLock != AUDIO_LOCK_UNINITIALIZED) {
@@ -1371,6 +1560,12 @@ void audio_reset_session(void) {
     gTempoInternalToExternal = (u32)(updatesPerFrame * 2880000.0f / gTatumsPerBeat / 16.713f);
 #endif
     gMaxAudioCmds = gMaxSimultaneousNotes * 20 * updatesPerFrame + 320;
+#ifdef BETTER_REVERB_RSP
+    gMaxAudioCmds += BETTER_REVERB_RSP_MAX_CMDS_PER_UPDATE * updatesPerFrame;
+#endif
+#ifdef AUDIO_STREAMING
+    gMaxAudioCmds += AUDIO_STREAM_MAX_CMDS_PER_UPDATE * updatesPerFrame;
+#endif
 #endif
 
 #if defined(VERSION_SH)
@@ -1431,6 +1626,9 @@ void audio_reset_session(void) {
 #else
     init_reverb_us(reverbPresetId);
 #endif
+#ifdef AUDIO_STREAMING
+    audio_stream_reset();
+#endif
 
     init_sample_dma_buffers();
 
@@ -71,6 +71,52 @@ struct SoundMultiPool {
     /*     */ u32 pad2[4];
 }; // size = 0x1D0
 
+#ifdef AUDIO_HEAP_TELEMETRY
+enum AudioHeapResidence {
+    AUDIO_HEAP_NOT_RESIDENT,
+    AUDIO_HEAP_PERSISTENT,
+    AUDIO_HEAP_TEMPORARY_LEFT,
+    AUDIO_HEAP_TEMPORARY_RIGHT,
+};
+
+enum AudioHeapKind {
+    AUDIO_HEAP_SEQ,
+    AUDIO_HEAP_BANK,
+    AUDIO_HEAP_KIND_COUNT
+};
+
+enum AudioHeapPoolType {
+    AUDIO_HEAP_POOL_PERSISTENT,
+    AUDIO_HEAP_POOL_TEMPORARY,
+    AUDIO_HEAP_POOL_TYPE_COUNT
+};
+
+struct AudioHeapEntryStats {
+    u32 size; // of the last allocation
+    u32 loadStart; // osGetCount() when the allocation was made, 0 once the load has finished
+    u32 lastLoadCycles;
+    u32 maxLoadCycles;
+    u16 loads; // every allocation, so loads - 1 is the number of reloads
+    u16 evictions; // times it was thrown out of a temporary pool while loaded
+    u16 hits; // lookups that found it already resident
+    u8 residence; // enum AudioHeapResidence
+    u8 pad;
+}; // size = 0x18
+
+struct AudioHeapPoolStats {
+    u32 peakUsed;
+    u32 evictions;
+    u32 failedAllocs;
+    u32 overflows; // persistent allocations that did not fit and went to the temporary pool instead
+};
+
+struct AudioHeapTelemetry {
+    struct AudioHeapEntryStats seqs[0x100];
+    struct AudioHeapEntryStats banks[MAX_NUM_SOUNDBANKS];
+    struct AudioHeapPoolStats pools[AUDIO_HEAP_KIND_COUNT][AUDIO_HEAP_POOL_TYPE_COUNT];
+};
+#endif
+
 #ifdef VERSION_SH
 struct Unk1Pool {
     struct SoundAllocPool pool;
@@ -132,6 +178,14 @@ void sound_alloc_pool_init(struct SoundAllocPool *pool, void *memAddr, u32 size)
 #ifdef PUPPYPRINT_DEBUG
 void puppyprint_get_allocated_pools(s32 *audioPoolList);
 #endif
+#ifdef AUDIO_HEAP_TELEMETRY
+extern struct AudioHeapTelemetry gAudioHeapTelemetry;
+void audio_heap_telemetry_load_done(struct SoundMultiPool *multiPool, s32 id);
+u32 audio_heap_pool_used(struct SoundMultiPool *multiPool, s32 poolType);
+#ifdef UNF
+void audio_heap_telemetry_dump(void);
+#endif
+#endif
 #ifdef VERSION_SH
 void *alloc_bank_or_seq(s32 poolIdx, s32 size, s32 arg3, s32 id);
 void *get_bank_or_seq(s32 poolIdx, s32 arg1, s32 id);
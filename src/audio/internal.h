@@ -52,6 +52,14 @@ enum NotePriority {
     NOTE_PRIORITY_DEFAULT
 };
 
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+// Active notes are sorted into one list per priority. Priorities at or above
+// the last bucket share it, and that bucket is searched when stealing from it.
+#define NOTE_PRIORITY_BUCKETS 16
+#define NOTE_PRIORITY_BUCKET(priority) ((priority) < NOTE_PRIORITY_BUCKETS ? (priority) : NOTE_PRIORITY_BUCKETS - 1)
+#define NOTE_PRIORITY_BUCKET_NONE 0xFF
+#endif
+
 #define TATUMS_PER_BEAT 48
 
 // abi.h contains more details about the ADPCM and S8 codecs, "skip" skips codec processing
@@ -128,7 +136,12 @@ struct NotePool {
     struct AudioListItem disabled;
     struct AudioListItem decaying;
     struct AudioListItem releasing;
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    struct AudioListItem active[NOTE_PRIORITY_BUCKETS];
+    u16 activeMask; // bit n is set when active[n] may be non-empty
+#else
     struct AudioListItem active;
+#endif
 };
 
 struct VibratoState {
@@ -490,6 +503,10 @@ struct SequenceChannel {
     /*0x5C, 0x60*/ struct M64ScriptState scriptState;
     /*0x78, 0x7C*/ struct AdsrSettings adsr;
     /*0x80, 0x84*/ struct NotePool notePool;
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    /*            */ u32 noteSteals; // notes taken from lower priority layers
+    /*            */ u32 noteDrops; // notes that could not be allocated at all
+#endif
 #ifdef VERSION_SH
     /*            0xC0*/ s8 soundScriptIO[8]; // bridge between sound script and audio lib. For player 2,
     // [0] contains enabled, [4] contains sound ID, [5] contains reverb adjustment
@@ -706,12 +723,26 @@ struct Note {
     /*0x8C*/ struct AudioListItem listItem;
     /*0x9C*/ s16 curVolLeft; // Q1.15, but will always be non-negative
     /*0x9E*/ s16 curVolRight; // Q1.15, but will always be non-negative
+#if defined(ENABLE_STEREO_HEADSET_EFFECTS) || defined(AUDIO_SAMPLE_PREFETCH) || defined(AUDIO_NOTE_PRIORITY_BUCKETS)
 #ifdef ENABLE_STEREO_HEADSET_EFFECTS
     /*0xA0*/ u16 headsetPanRight;
     /*0xA2*/ u16 headsetPanLeft;
     /*0xA4*/ u16 prevHeadsetPanRight;
     /*0xA6*/ u16 prevHeadsetPanLeft;
-    /*    */ u8 align16Padding[0x08];
+#else
+    /*    */ u8 pad1[0x08];
+#endif
+#ifdef AUDIO_SAMPLE_PREFETCH
+    /*0xA8*/ u8 samplePrefetchDmaIndex; // 0xFF if nothing has been prefetched
+#else
+    /*    */ u8 pad2[0x01];
+#endif
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    /*0xA9*/ u8 activeBucket; // NOTE_PRIORITY_BUCKET_NONE unless in one of its pool's active lists
+#else
+    /*    */ u8 pad3[0x01];
+#endif
+    /*0xAA*/ u8 align16Padding[0x06];
 #endif
 }; // size = 0xA0, 0xB0
 #endif
@@ -14,9 +14,24 @@ struct SharedDma {
     /*0x4*/ uintptr_t source; // device address
     /*0x8*/ u32 bufSize;      // size of buffer (converted from u16 for intentional padding to size 0x10)
     /*0xC*/ u8 reuseIndex;    // position in sSampleDmaReuseQueue1/2, if ttl == 0
-    /*   */ // u8 pad[3];
+    /*0xD*/ u8 hits;          // saturating number of cache hits since the buffer was last filled
+    /*   */ // u8 pad[2];
 };                            // size = 0x10
 
+#define SAMPLE_DMA_TTL_NOTE      2  // Buffers tied to a single note (reuse queue 1)
+#define SAMPLE_DMA_TTL_SHARED   60  // Buffers shared between notes (reuse queue 2)
+
+#ifdef AUDIO_SAMPLE_PREFETCH
+// Reuse queues are indexed with a u8, so this is as large as the cache can get.
+#define SAMPLE_DMA_MAX_ENTRIES 0xFF
+// Prefetched buffers may not be touched until the frame after next.
+#define SAMPLE_DMA_TTL_PREFETCH  4
+// Leave at least half of this frame's DMA queue for demand loads.
+#define SAMPLE_PREFETCH_DMA_LIMIT (AUDIO_FRAME_DMA_QUEUE_SIZE / 2)
+#else
+#define SAMPLE_DMA_MAX_ENTRIES (MAX_SIMULTANEOUS_NOTES * 4)
+#endif
+
 // EU only
 void port_eu_init(void);
 
@@ -40,8 +55,8 @@ OSMesgQueue gAudioDmaMesgQueue;
 OSMesg gAudioDmaMesg;
 OSIoMesg gAudioDmaIoMesg;
 
-struct SharedDma sSampleDmas[MAX_SIMULTANEOUS_NOTES * 4];
-u8 sSampleTTLs[MAX_SIMULTANEOUS_NOTES * 4];
+struct SharedDma sSampleDmas[SAMPLE_DMA_MAX_ENTRIES];
+u8 sSampleTTLs[SAMPLE_DMA_MAX_ENTRIES];
 u32 gSampleDmaNumListItems; // sh: 0x803503D4
 u32 sSampleDmaListSize1; // sh: 0x803503D8
 
@@ -53,6 +68,10 @@ u8 sSampleDmaReuseQueueTail2;
 u8 sSampleDmaReuseQueueHead1; // sh: 0x803505E2
 u8 sSampleDmaReuseQueueHead2; // sh: 0x803505E3
 
+#ifdef AUDIO_SAMPLE_PREFETCH
+struct SampleDmaStats gSampleDmaStats;
+#endif
+
 // bss correct up to here
 
 ALSeqFile *gSeqFileHeader;
@@ -202,7 +221,16 @@ void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef) {
                     }
                     sSampleDmaReuseQueueTail2++;
                 }
-                sSampleTTLs[i] = 60;
+#ifdef AUDIO_SAMPLE_PREFETCH
+                // Keep hot shared samples (usually sound effects) resident for longer.
+                if (dma->hits < 0xFF - SAMPLE_DMA_TTL_SHARED) {
+                    dma->hits++;
+                }
+                sSampleTTLs[i] = SAMPLE_DMA_TTL_SHARED + dma->hits;
+                gSampleDmaStats.hits++;
+#else
+                sSampleTTLs[i] = SAMPLE_DMA_TTL_SHARED;
+#endif
                 *dmaIndexRef = (u8) i;
                 return (devAddr - dma->source) + dma->buffer;
             }
@@ -214,7 +242,7 @@ void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef) {
             dmaIndex = sSampleDmaReuseQueue2[sSampleDmaReuseQueueTail2];
             sSampleDmaReuseQueueTail2++;
             dma = sSampleDmas + dmaIndex;
-            sSampleTTLs[dmaIndex] = 2;
+            sSampleTTLs[dmaIndex] = SAMPLE_DMA_TTL_NOTE;
             hasDma = TRUE;
         }
     } else {
@@ -233,7 +261,10 @@ void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef) {
                 }
                 sSampleDmaReuseQueueTail1++;
             }
-            sSampleTTLs[*dmaIndexRef] = 2;
+            sSampleTTLs[*dmaIndexRef] = SAMPLE_DMA_TTL_NOTE;
+#ifdef AUDIO_SAMPLE_PREFETCH
+            gSampleDmaStats.hits++;
+#endif
             return dma->buffer + (devAddr - dma->source);
         }
     }
@@ -243,13 +274,17 @@ void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef) {
         // be empty, since TTL 2 is so small.
         dmaIndex = sSampleDmaReuseQueue1[sSampleDmaReuseQueueTail1++];
         dma = sSampleDmas + dmaIndex;
-        sSampleTTLs[dmaIndex] = 2;
+        sSampleTTLs[dmaIndex] = SAMPLE_DMA_TTL_NOTE;
         hasDma = TRUE;
     }
 
     transfer = dma->bufSize;
     dmaDevAddr = devAddr & ~0xF;
     dma->source = dmaDevAddr;
+    dma->hits = 0;
+#ifdef AUDIO_SAMPLE_PREFETCH
+    gSampleDmaStats.misses++;
+#endif
 #ifdef VERSION_US // TODO: Is there a reason this only exists in US?
     osInvalDCache(dma->buffer, transfer);
 #endif
@@ -259,6 +294,81 @@ void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef) {
     return (devAddr - dmaDevAddr) + dma->buffer;
 }
 
+#ifdef AUDIO_SAMPLE_PREFETCH
+static s32 sample_dma_contains(u32 dmaIndex, uintptr_t devAddr, u32 size) {
+    if (dmaIndex >= gSampleDmaNumListItems) {
+        return FALSE;
+    }
+
+    struct SharedDma *dma = &sSampleDmas[dmaIndex];
+    ssize_t bufferPos = devAddr - dma->source;
+
+    return (0 <= bufferPos && (size_t) bufferPos <= dma->bufSize - size);
+}
+
+/**
+ * If the note's current buffer does not hold the requested range but its prefetched one does,
+ * make the prefetched buffer current so that dma_sample_data finds it without issuing a DMA.
+ */
+void claim_prefetched_sample_data(uintptr_t devAddr, u32 size, u8 *dmaIndexRef, u8 *prefetchIndexRef) {
+    u8 prefetchIndex = *prefetchIndexRef;
+    struct SharedDma *dma;
+
+    // Prefetches always come from reuse queue 1, so anything else is a stale index.
+    if (prefetchIndex >= sSampleDmaListSize1
+        || sample_dma_contains(*dmaIndexRef, devAddr, size) || !sample_dma_contains(prefetchIndex, devAddr, size)) {
+        return;
+    }
+
+    dma = &sSampleDmas[prefetchIndex];
+    if (sSampleTTLs[prefetchIndex] == 0) {
+        // The prefetch expired without being reclaimed yet; move it out of the reuse queue.
+        if (dma->reuseIndex != sSampleDmaReuseQueueTail1) {
+            sSampleDmaReuseQueue1[dma->reuseIndex] = sSampleDmaReuseQueue1[sSampleDmaReuseQueueTail1];
+            sSampleDmas[sSampleDmaReuseQueue1[sSampleDmaReuseQueueTail1]].reuseIndex = dma->reuseIndex;
+        }
+        sSampleDmaReuseQueueTail1++;
+        sSampleTTLs[prefetchIndex] = SAMPLE_DMA_TTL_NOTE;
+    }
+
+    *prefetchIndexRef = *dmaIndexRef;
+    *dmaIndexRef = prefetchIndex;
+    gSampleDmaStats.prefetchHits++;
+}
+
+/**
+ * Start loading the sample data a note will read next, so that the DMA has landed well before
+ * synthesis asks for it. Does nothing if the data is already resident in either of the note's
+ * buffers, or if DMAs or free buffers are running short this frame.
+ */
+void prefetch_sample_data(uintptr_t devAddr, u32 size, u8 dmaIndex, u8 *prefetchIndexRef) {
+    struct SharedDma *dma;
+    u32 prefetchIndex;
+
+    if (sample_dma_contains(dmaIndex, devAddr, size) || sample_dma_contains(*prefetchIndexRef, devAddr, size)) {
+        return;
+    }
+
+    // Demand loads always take priority, so keep enough buffers free for every note to miss once.
+    if (gCurrAudioFrameDmaCount >= SAMPLE_PREFETCH_DMA_LIMIT
+        || (u8)(sSampleDmaReuseQueueHead1 - sSampleDmaReuseQueueTail1) <= (u32) gMaxSimultaneousNotes) {
+        return;
+    }
+
+    prefetchIndex = sSampleDmaReuseQueue1[sSampleDmaReuseQueueTail1++];
+    dma = &sSampleDmas[prefetchIndex];
+    sSampleTTLs[prefetchIndex] = SAMPLE_DMA_TTL_PREFETCH;
+
+    dma->source = devAddr & ~0xF;
+    dma->hits = 0;
+    osInvalDCache(dma->buffer, dma->bufSize);
+    osPiStartDma(&gCurrAudioFrameDmaIoMesgBufs[gCurrAudioFrameDmaCount++], OS_MESG_PRI_NORMAL,
+                     OS_READ, dma->source, dma->buffer, dma->bufSize, &gCurrAudioFrameDmaQueue);
+    *prefetchIndexRef = prefetchIndex;
+    gSampleDmaStats.prefetches++;
+}
+#endif
+
 
 void init_sample_dma_buffers() {
     s32 i;
@@ -296,7 +406,13 @@ void init_sample_dma_buffers() {
 
     sDmaBufSize = DMA_BUF_SIZE_1;
 
+#ifdef AUDIO_SAMPLE_PREFETCH
+    // Nothing else is allocated from the notes and buffers pool after this point, so give all of
+    // the space left over (e.g. from running with fewer notes on console) to the shared cache.
+    while (gSampleDmaNumListItems < ARRAY_COUNT(sSampleDmas)) {
+#else
     for (i = 0; i < gMaxSimultaneousNotes; i++) {
+#endif
         sSampleDmas[gSampleDmaNumListItems].buffer = soundAlloc(&gNotesAndBuffersPool, sDmaBufSize);
         if (sSampleDmas[gSampleDmaNumListItems].buffer == NULL) {
             break;
@@ -478,6 +594,9 @@ struct AudioBank *bank_load_immediate(s32 bankId, s32 arg1) {
     gCtlEntries[bankId].instruments = ret->instruments;
     gCtlEntries[bankId].drums = ret->drums;
     gBankLoadStatus[bankId] = SOUND_LOAD_STATUS_COMPLETE;
+#ifdef AUDIO_HEAP_TELEMETRY
+    audio_heap_telemetry_load_done(&gBankLoadedPool, bankId);
+#endif
     return ret;
 }
 
@@ -538,6 +657,9 @@ void *sequence_dma_immediate(s32 seqId, s32 arg1) {
 
     audio_dma_copy_immediate((uintptr_t) seqData, ptr, seqLength);
     gSeqLoadStatus[seqId] = SOUND_LOAD_STATUS_COMPLETE;
+#ifdef AUDIO_HEAP_TELEMETRY
+    audio_heap_telemetry_load_done(&gSeqLoadedPool, seqId);
+#endif
     return ptr;
 }
 
@@ -561,6 +683,9 @@ void *sequence_dma_async(s32 seqId, s32 arg1, struct SequencePlayer *seqPlayer)
         // Immediately load short sequenece
         audio_dma_copy_immediate((uintptr_t) seqData, ptr, seqLength);
         gSeqLoadStatus[seqId] = SOUND_LOAD_STATUS_COMPLETE;
+#ifdef AUDIO_HEAP_TELEMETRY
+        audio_heap_telemetry_load_done(&gSeqLoadedPool, seqId);
+#endif
     } else {
         audio_dma_copy_immediate((uintptr_t) seqData, ptr, 0x40);
         mesgQueue = &seqPlayer->seqDmaMesgQueue;
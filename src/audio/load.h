@@ -80,6 +80,8 @@ struct PatchStruct {
 extern struct UnkStructSH8034EC88 D_SH_8034EC88[0x80];
 #endif
 
+void audio_dma_copy_immediate(uintptr_t devAddr, void *vAddr, size_t nbytes);
+void audio_dma_copy_async(uintptr_t devAddr, void *vAddr, size_t nbytes, OSMesgQueue *queue, OSIoMesg *mesg);
 void audio_dma_partial_copy_async(uintptr_t *devAddr, u8 **vAddr, ssize_t *remaining, OSMesgQueue *queue, OSIoMesg *mesg);
 void decrease_sample_dma_ttls(void);
 #ifdef VERSION_SH
@@ -88,6 +90,18 @@ void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef, s3
 void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef);
 #endif
 void init_sample_dma_buffers();
+#ifdef AUDIO_SAMPLE_PREFETCH
+struct SampleDmaStats {
+    u32 hits;
+    u32 misses;
+    u32 prefetches;
+    u32 prefetchHits;
+};
+extern struct SampleDmaStats gSampleDmaStats;
+
+void claim_prefetched_sample_data(uintptr_t devAddr, u32 size, u8 *dmaIndexRef, u8 *prefetchIndexRef);
+void prefetch_sample_data(uintptr_t devAddr, u32 size, u8 dmaIndex, u8 *prefetchIndexRef);
+#endif
 #if defined(VERSION_SH)
 void patch_audio_bank(s32 bankId, struct AudioBank *mem, struct PatchStruct *patchInfo);
 #else
@@ -371,10 +371,18 @@ void process_notes(void) {
          ? it                                                                                          \
          : (it->prev = (head_arg), it->next = (head_arg)->next, (head_arg)->next->prev = it,           \
             (head_arg)->next = it, (head_arg)->u.count++, it->pool = (head_arg)->pool, it))
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+#define POP(item)                                                                                      \
+    ((it = (item), it->prev == NULL)                                                                   \
+         ? it                                                                                          \
+         : (it->prev->next = it->next, it->next->prev = it->prev, it->prev = NULL,                    \
+            ((struct Note *) it->u.value)->activeBucket = NOTE_PRIORITY_BUCKET_NONE, it))
+#else
 #define POP(item)                                                                                      \
     ((it = (item), it->prev == NULL)                                                                   \
          ? it                                                                                          \
          : (it->prev->next = it->next, it->next->prev = it->prev, it->prev = NULL, it))
+#endif
 
     for (i = 0; i < gMaxSimultaneousNotes; i++) {
         note = &gNotes[i];
@@ -553,8 +561,13 @@ void process_notes(void) {
                                 PREPEND(&note->listItem, &gNoteFreeLists.disabled);
                             } else {
                                 note_vibrato_init(note);
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+                                POP(&note->listItem);
+                                note_pool_push_active(note->listItem.pool, note, FALSE);
+#else
                                 audio_list_push_back(&note->listItem.pool->active,
                                                      POP(&note->listItem));
+#endif
                                 note->wantedParentLayer = NO_LAYER;
                             }
                         } else {
@@ -744,6 +757,9 @@ void seq_channel_layer_decay_release_internal(struct SequenceChannelLayer *seqLa
             note->priority = NOTE_PRIORITY_STOPPING;
 #ifdef VERSION_SH
         }
+#endif
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+        note_update_priority_bucket(note);
 #endif
         note->prevParentLayer = note->parentLayer;
         note->parentLayer = NO_LAYER;
@@ -917,14 +933,28 @@ void init_note_list(struct AudioListItem *list) {
 }
 
 void init_note_lists(struct NotePool *pool) {
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    s32 i;
+
+#endif
     init_note_list(&pool->disabled);
     init_note_list(&pool->decaying);
     init_note_list(&pool->releasing);
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    for (i = 0; i < NOTE_PRIORITY_BUCKETS; i++) {
+        init_note_list(&pool->active[i]);
+        pool->active[i].pool = pool;
+    }
+    pool->activeMask = 0;
+#else
     init_note_list(&pool->active);
+#endif
     pool->disabled.pool = pool;
     pool->decaying.pool = pool;
     pool->releasing.pool = pool;
+#ifndef AUDIO_NOTE_PRIORITY_BUCKETS
     pool->active.pool = pool;
+#endif
 }
 
 void init_note_free_list(void) {
@@ -934,6 +964,12 @@ void init_note_free_list(void) {
     for (i = 0; i < gMaxSimultaneousNotes; i++) {
         gNotes[i].listItem.u.value = &gNotes[i];
         gNotes[i].listItem.prev = NULL;
+#ifdef AUDIO_SAMPLE_PREFETCH
+        gNotes[i].samplePrefetchDmaIndex = 0xFF;
+#endif
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+        gNotes[i].activeBucket = NOTE_PRIORITY_BUCKET_NONE;
+#endif
         audio_list_push_back(&gNoteFreeLists.disabled, &gNotes[i].listItem);
     }
 }
@@ -963,9 +999,14 @@ void note_pool_clear(struct NotePool *pool) {
                 break;
 
             case 3:
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+                note_pool_clear_active(pool);
+                continue;
+#else
                 source = &pool->active;
                 dest = &gNoteFreeLists.active;
                 break;
+#endif
         }
 
 #if defined(VERSION_EU) || defined(VERSION_SH)
@@ -1027,9 +1068,14 @@ void note_pool_fill(struct NotePool *pool, s32 count) {
                 break;
 
             case 3:
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+                j += note_pool_take_active(pool, count - j);
+                continue;
+#else
                 source = &gNoteFreeLists.active;
                 dest = &pool->active;
                 break;
+#endif
         }
 
         while (j < count) {
@@ -1065,9 +1111,129 @@ void audio_list_remove(struct AudioListItem *item) {
         item->prev->next = item->next;
         item->next->prev = item->prev;
         item->prev = NULL;
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+        if (item->pool != NULL) {
+            ((struct Note *) item->u.value)->activeBucket = NOTE_PRIORITY_BUCKET_NONE;
+        }
+#endif
+    }
+}
+
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+/**
+ * Add a detached note to the active list of 'pool' that matches its current priority.
+ */
+void note_pool_push_active(struct NotePool *pool, struct Note *note, s32 atFront) {
+    u32 bucket = NOTE_PRIORITY_BUCKET(note->priority);
+
+    if (note->listItem.prev != NULL) {
+        eu_stubbed_printf_0("Error:Same List Add\n");
+        return;
+    }
+
+    if (atFront) {
+        audio_list_push_front(&pool->active[bucket], &note->listItem);
+    } else {
+        audio_list_push_back(&pool->active[bucket], &note->listItem);
+    }
+    note->activeBucket = bucket;
+    pool->activeMask |= (1 << bucket);
+}
+
+/**
+ * Move an active note to the list for its priority after it was changed in place.
+ * Notes that are not in an active list are left alone.
+ */
+void note_update_priority_bucket(struct Note *note) {
+    struct NotePool *pool;
+
+    if (note->activeBucket == NOTE_PRIORITY_BUCKET_NONE
+        || note->activeBucket == NOTE_PRIORITY_BUCKET(note->priority)) {
+        return;
+    }
+
+    pool = note->listItem.pool;
+    audio_list_remove(&note->listItem);
+    note_pool_push_active(pool, note, FALSE);
+}
+
+/**
+ * Return all active notes of 'pool' to the global free lists.
+ */
+void note_pool_clear_active(struct NotePool *pool) {
+    struct AudioListItem *list;
+    struct AudioListItem *cur;
+    s32 i;
+
+    for (i = 0; i < NOTE_PRIORITY_BUCKETS; i++) {
+        list = &pool->active[i];
+        while ((cur = list->next) != list) {
+            audio_list_remove(cur);
+            note_pool_push_active(&gNoteFreeLists, cur->u.value, FALSE);
+        }
+    }
+    pool->activeMask = 0;
+}
+
+/**
+ * Move up to 'count' active notes from the global free lists into 'pool'.
+ * Returns the number of notes moved.
+ */
+s32 note_pool_take_active(struct NotePool *pool, s32 count) {
+    struct Note *note;
+    s32 moved = 0;
+    s32 i;
+
+    for (i = 0; i < NOTE_PRIORITY_BUCKETS && moved < count; i++) {
+        while (moved < count && (note = audio_list_pop_back(&gNoteFreeLists.active[i])) != NULL) {
+            note->activeBucket = NOTE_PRIORITY_BUCKET_NONE;
+            note_pool_push_active(pool, note, FALSE);
+            moved++;
+        }
     }
+    return moved;
 }
 
+/**
+ * Bucketed version of pop_node_with_lower_prio for a pool's active notes. The lowest non-empty
+ * priority list is found from the pool's mask, so only the shared top list is ever searched.
+ */
+struct Note *pop_active_note_with_lower_prio(struct NotePool *pool, s32 limit) {
+    struct AudioListItem *list;
+    struct AudioListItem *cur;
+    struct AudioListItem *best;
+    s32 bucket;
+
+    while (pool->activeMask != 0) {
+        bucket = __builtin_ctz(pool->activeMask);
+        list = &pool->active[bucket];
+        if (list->next == list) {
+            pool->activeMask &= ~(1 << bucket);
+            continue;
+        }
+
+        // Like the linear search, take the last of the lowest priority notes.
+        best = list->prev;
+        if (bucket == NOTE_PRIORITY_BUCKETS - 1) {
+            for (best = cur = list->next; cur != list; cur = cur->next) {
+                if (((struct Note *) best->u.value)->priority >= ((struct Note *) cur->u.value)->priority) {
+                    best = cur;
+                }
+            }
+        }
+
+        if (limit < ((struct Note *) best->u.value)->priority) {
+            return NULL;
+        }
+
+        audio_list_remove(best);
+        return best->u.value;
+    }
+
+    return NULL;
+}
+#endif
+
 struct Note *pop_node_with_lower_prio(struct AudioListItem *list, s32 limit) {
     struct AudioListItem *cur = list->next;
     struct AudioListItem *best;
@@ -1178,6 +1344,9 @@ void note_release_and_take_ownership(struct Note *note, struct SequenceChannelLa
 #else
     note->priority = NOTE_PRIORITY_STOPPING;
 #endif
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    note_update_priority_bucket(note);
+#endif
 
 #if defined(VERSION_EU) || defined(VERSION_SH)
     note->adsr.fadeOutVel = gAudioBufferParameters.updatesPerFrameInv;
@@ -1198,7 +1367,11 @@ struct Note *alloc_note_from_disabled(struct NotePool *pool, struct SequenceChan
             return NULL;
         }
 #endif
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+        note_pool_push_active(pool, note, TRUE);
+#else
         audio_list_push_front(&pool->active, &note->listItem);
+#endif
     }
     return note;
 }
@@ -1228,7 +1401,11 @@ struct Note *alloc_note_from_active(struct NotePool *pool, struct SequenceChanne
     }
 #endif
 
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    aNote = pop_active_note_with_lower_prio(pool, seqLayer->seqChannel->notePriority);
+#else
     aNote = pop_node_with_lower_prio(&pool->active, seqLayer->seqChannel->notePriority);
+#endif
 
     if (aNote == NULL) {
         eu_stubbed_printf_0("Audio: C-Alloc : lowerPrio is NULL\n");
@@ -1236,6 +1413,9 @@ struct Note *alloc_note_from_active(struct NotePool *pool, struct SequenceChanne
 #ifdef VERSION_SH
         aPriority = aNote->priority;
 #else
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+        seqLayer->seqChannel->noteSteals++;
+#endif
         func_80319728(aNote, seqLayer);
         audio_list_push_back(&pool->releasing, &aNote->listItem);
 #endif
@@ -1291,6 +1471,9 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
             goto null_return;
 #else
             eu_stubbed_printf_0("Sub Limited Warning: Drop Voice");
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+            seqLayer->seqChannel->noteDrops++;
+#endif
             seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
             return NULL;
 #endif
@@ -1309,6 +1492,9 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
             goto null_return;
 #else
             eu_stubbed_printf_0("Warning: Drop Voice");
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+            seqLayer->seqChannel->noteDrops++;
+#endif
             seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
             return NULL;
 #endif
@@ -1324,6 +1510,9 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
             goto null_return;
 #else
             eu_stubbed_printf_0("Warning: Drop Voice");
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+            seqLayer->seqChannel->noteDrops++;
+#endif
             seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
             return NULL;
 #endif
@@ -1344,6 +1533,9 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer) {
         goto null_return;
 #else
         eu_stubbed_printf_0("Warning: Drop Voice");
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+        seqLayer->seqChannel->noteDrops++;
+#endif
         seqLayer->status = SOUND_LOAD_STATUS_NOT_LOADED;
         return NULL;
 #endif
@@ -1373,9 +1565,15 @@ void reclaim_notes(void) {
                 audio_list_push_back(&gLayerFreeList, &note->parentLayer->listItem);
                 seq_channel_layer_disable(note->parentLayer);
                 note->priority = NOTE_PRIORITY_STOPPING;
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+                note_update_priority_bucket(note);
+#endif
             } else if (note->parentLayer->seqChannel->seqPlayer == NULL) {
                 sequence_channel_disable(note->parentLayer->seqChannel);
                 note->priority = NOTE_PRIORITY_STOPPING;
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+                note_update_priority_bucket(note);
+#endif
             } else if (note->parentLayer->seqChannel->seqPlayer->muted) {
                 if (note->parentLayer->seqChannel->muteBehavior
                     & (MUTE_BEHAVIOR_STOP_SCRIPT | MUTE_BEHAVIOR_STOP_NOTES)) {
@@ -1448,3 +1646,39 @@ void note_init_all(void) {
 #endif
     }
 }
+
+#if defined(AUDIO_NOTE_PRIORITY_BUCKETS) && defined(PUPPYPRINT_DEBUG)
+/**
+ * Sum the voice steal and drop counts of every running sequence channel, and find the
+ * channel that stole the most notes (-1 if none have).
+ */
+void puppyprint_get_note_steal_stats(u32 *steals, u32 *drops, s32 *busiestPlayer, s32 *busiestChannel) {
+    struct SequenceChannel *seqChannel;
+    u32 mostSteals = 0;
+    s32 i, j;
+
+    *steals = 0;
+    *drops = 0;
+    *busiestPlayer = -1;
+    *busiestChannel = -1;
+
+    for (i = 0; i < SEQUENCE_PLAYERS; i++) {
+        if (!gSequencePlayers[i].enabled) {
+            continue;
+        }
+        for (j = 0; j < CHANNELS_MAX; j++) {
+            seqChannel = gSequencePlayers[i].channels[j];
+            if (!IS_SEQUENCE_CHANNEL_VALID(seqChannel)) {
+                continue;
+            }
+            *steals += seqChannel->noteSteals;
+            *drops += seqChannel->noteDrops;
+            if (seqChannel->noteSteals > mostSteals) {
+                mostSteals = seqChannel->noteSteals;
+                *busiestPlayer = i;
+                *busiestChannel = j;
+            }
+        }
+    }
+}
+#endif
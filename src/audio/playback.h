@@ -32,6 +32,17 @@ struct Note *alloc_note(struct SequenceChannelLayer *seqLayer);
 void reclaim_notes(void);
 void note_init_all(void);
 
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+void note_pool_push_active(struct NotePool *pool, struct Note *note, s32 atFront);
+void note_update_priority_bucket(struct Note *note);
+void note_pool_clear_active(struct NotePool *pool);
+s32 note_pool_take_active(struct NotePool *pool, s32 count);
+struct Note *pop_active_note_with_lower_prio(struct NotePool *pool, s32 limit);
+#ifdef PUPPYPRINT_DEBUG
+void puppyprint_get_note_steal_stats(u32 *steals, u32 *drops, s32 *busiestPlayer, s32 *busiestChannel);
+#endif
+#endif
+
 #if defined(VERSION_SH)
 void note_set_vel_pan_reverb(struct Note *note, struct ReverbInfo *reverbInfo);
 #elif defined(VERSION_EU)
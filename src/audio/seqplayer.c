@@ -58,6 +58,10 @@ void sequence_channel_init(struct SequenceChannel *seqChannel) {
     seqChannel->notePriority = NOTE_PRIORITY_DEFAULT;
 #ifdef VERSION_SH
     seqChannel->unkSH06 = 1;
+#endif
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    seqChannel->noteSteals = 0;
+    seqChannel->noteDrops = 0;
 #endif
     seqChannel->delay = 0;
     seqChannel->adsr.envelope = gDefaultEnvelope;
@@ -2233,6 +2237,9 @@ void sequence_player_process_sequence(struct SequencePlayer *seqPlayer) {
             gCtlEntries[seqPlayer->loadingBankId].instruments = seqPlayer->loadingBank->instruments;
             gCtlEntries[seqPlayer->loadingBankId].drums = seqPlayer->loadingBank->drums;
             gBankLoadStatus[seqPlayer->loadingBankId] = SOUND_LOAD_STATUS_COMPLETE;
+#ifdef AUDIO_HEAP_TELEMETRY
+            audio_heap_telemetry_load_done(&gBankLoadedPool, seqPlayer->loadingBankId);
+#endif
         } else {
             osCreateMesgQueue(&seqPlayer->bankDmaMesgQueue, &seqPlayer->bankDmaMesg, 1);
             seqPlayer->bankDmaMesg = NULL;
@@ -2256,6 +2263,9 @@ void sequence_player_process_sequence(struct SequencePlayer *seqPlayer) {
 #endif
         seqPlayer->seqDmaInProgress = FALSE;
         gSeqLoadStatus[seqPlayer->seqId] = SOUND_LOAD_STATUS_COMPLETE;
+#ifdef AUDIO_HEAP_TELEMETRY
+        audio_heap_telemetry_load_done(&gSeqLoadedPool, seqPlayer->seqId);
+#endif
     }
 #endif
 
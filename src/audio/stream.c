@@ -0,0 +1,309 @@
+#include <ultra64.h>
+#include <PR/os_internal_reg.h>
+
+#include "data.h"
+#include "load.h"
+#include "stream.h"
+#include "engine/math_util.h"
+
+#ifdef AUDIO_STREAMING
+
+// A buffer may only be refilled once the RSP task for the audio frame that last read it has finished.
+#define AUDIO_STREAM_BUFFER_REUSE_FRAMES 2
+
+// Largest gain change per audio update, so volume changes and stops don't click
+#define AUDIO_STREAM_GAIN_STEP 0x400
+
+enum AudioStreamRequests {
+    AUDIO_STREAM_REQUEST_PLAY   = (1 << 0),
+    AUDIO_STREAM_REQUEST_STOP   = (1 << 1),
+    AUDIO_STREAM_REQUEST_VOLUME = (1 << 2),
+};
+
+ALIGNED16 struct AudioStream gAudioStream;
+static ALIGNED16 u8 sAudioStreamBuffers[ARRAY_COUNT(gAudioStream.buffers)][AUDIO_STREAM_BUFFER_SIZE];
+
+static volatile u8 sAudioStreamRequests = 0;
+static u8 *volatile sAudioStreamRequestRom = NULL;
+static volatile u8 sAudioStreamRequestVolume = 0;
+
+/**
+ * Clears and sets request flags. Requests come from the game thread and are handled on the audio thread, and either one
+ * can be preempted by the other in the middle of the read-modify-write, so it's done with interrupts disabled.
+ */
+static void audio_stream_update_requests(u8 clear, u8 set) {
+    u32 saved = __osDisableInt();
+
+    sAudioStreamRequests = (sAudioStreamRequests & ~clear) | set;
+    __osRestoreInt(saved);
+}
+
+/**
+ * Starts playing the stream whose header is at the given ROM address, usually a label in sound/streams.s.
+ * Volume ranges from 0 to 127. Takes effect on the next audio frame, replacing any stream that is playing.
+ */
+void audio_stream_play(u8 *romHeader, u8 volume) {
+    sAudioStreamRequestRom = romHeader;
+    sAudioStreamRequestVolume = volume;
+    audio_stream_update_requests(AUDIO_STREAM_REQUEST_STOP, AUDIO_STREAM_REQUEST_PLAY);
+}
+
+/**
+ * Fades out and stops the current stream.
+ */
+void audio_stream_stop(void) {
+    audio_stream_update_requests(AUDIO_STREAM_REQUEST_PLAY, AUDIO_STREAM_REQUEST_STOP);
+}
+
+void audio_stream_set_volume(u8 volume) {
+    sAudioStreamRequestVolume = volume;
+    audio_stream_update_requests(0, AUDIO_STREAM_REQUEST_VOLUME);
+}
+
+s32 audio_stream_is_playing(void) {
+    return (gAudioStream.playing && !gAudioStream.stopping) || (sAudioStreamRequests & AUDIO_STREAM_REQUEST_PLAY);
+}
+
+static s16 audio_stream_volume_to_gain(u8 volume) {
+    return MIN(volume, 0x7F) << 8;
+}
+
+static s32 audio_stream_buffer_reusable(struct AudioStreamBuffer *buffer) {
+    return !buffer->loading && (gAudioFrameCount - buffer->lastUsedFrame) >= AUDIO_STREAM_BUFFER_REUSE_FRAMES;
+}
+
+static void audio_stream_load_chunk(struct AudioStreamBuffer *buffer, s32 chunk) {
+    struct AudioStream *stream = &gAudioStream;
+
+    buffer->chunk = chunk;
+    buffer->loading = TRUE;
+    audio_dma_copy_async(stream->romData + chunk * stream->header.chunkStride, buffer->data,
+                         stream->header.chunkStride, &buffer->dmaQueue, &buffer->dmaIoMesg);
+}
+
+static s32 audio_stream_header_valid(struct AudioStreamHeader *header) {
+    return header->magic == AUDIO_STREAM_MAGIC
+        && header->codec <= AUDIO_STREAM_CODEC_ADPCM
+        && header->numChannels >= 1 && header->numChannels <= 2
+        && header->sampleRate != 0 && header->sampleRate < gAiFrequency * 2
+        && header->numChunks != 0
+        && header->chunkSamples >= AUDIO_STREAM_MIN_CHUNK_SAMPLES && (header->chunkSamples & 0xF) == 0
+        && header->lastChunkSamples >= AUDIO_STREAM_MIN_CHUNK_SAMPLES && (header->lastChunkSamples & 0xF) == 0
+        && header->lastChunkSamples <= header->chunkSamples
+        && header->chunkStride <= AUDIO_STREAM_BUFFER_SIZE && (header->channelStride & 0xF) == 0
+        && header->loopChunk < (s32) header->numChunks
+        && (header->dataOffset & 0xF) == 0
+        && (header->codec != AUDIO_STREAM_CODEC_ADPCM
+            || header->bookOrder * header->bookNumPredictors * 8 <= AUDIO_STREAM_BOOK_MAX_ENTRIES);
+}
+
+static void audio_stream_start(u8 *romHeader, u8 volume) {
+    struct AudioStream *stream = &gAudioStream;
+    struct AudioStreamHeader *header = &stream->header;
+    u32 i;
+
+    stream->playing = FALSE;
+    audio_dma_copy_immediate((uintptr_t) romHeader, header, sizeof(struct AudioStreamHeader));
+    if (!audio_stream_header_valid(header)) {
+        return;
+    }
+
+    stream->romData = (uintptr_t) romHeader + header->dataOffset;
+    stream->resampleRate = (u16) (s32) ((f32) header->sampleRate / gAiFrequency * 32768.0f);
+    stream->samplePosFrac = 0;
+    stream->curChunk = 0;
+    stream->chunkPos = 0;
+    stream->curBuffer = 0;
+    stream->needsInit = TRUE;
+    stream->stopping = FALSE;
+    stream->gain = stream->targetGain = audio_stream_volume_to_gain(volume);
+
+    for (i = 0; i < ARRAY_COUNT(stream->buffers); i++) {
+        stream->buffers[i].chunk = -1;
+    }
+
+    // Block on the first chunk, the one after it is loaded by audio_stream_update.
+    stream->buffers[0].chunk = 0;
+    audio_dma_copy_immediate(stream->romData, stream->buffers[0].data, header->chunkStride);
+
+    stream->playing = TRUE;
+}
+
+/**
+ * Called on audio session resets. Stops the current stream, since the output frequency may change.
+ */
+void audio_stream_reset(void) {
+    struct AudioStream *stream = &gAudioStream;
+    static u8 sInitialized = FALSE;
+    u32 i;
+
+    for (i = 0; i < ARRAY_COUNT(stream->buffers); i++) {
+        struct AudioStreamBuffer *buffer = &stream->buffers[i];
+
+        if (!sInitialized) {
+            buffer->data = sAudioStreamBuffers[i];
+            osCreateMesgQueue(&buffer->dmaQueue, &buffer->dmaMesg, 1);
+        } else if (buffer->loading) {
+            osRecvMesg(&buffer->dmaQueue, NULL, OS_MESG_BLOCK);
+        }
+        buffer->chunk = -1;
+        buffer->loading = FALSE;
+        // gAudioFrameCount restarts from 0 on resets
+        buffer->lastUsedFrame = gAudioFrameCount;
+    }
+    sInitialized = TRUE;
+
+    stream->playing = FALSE;
+    stream->stopping = FALSE;
+}
+
+/**
+ * Handles requests from the game thread and queues up the next chunk. Called once per audio frame.
+ */
+void audio_stream_update(void) {
+    struct AudioStream *stream = &gAudioStream;
+    struct AudioStreamBuffer *nextBuffer;
+    u8 requests = sAudioStreamRequests;
+    s32 nextChunk;
+    u32 i;
+
+    for (i = 0; i < ARRAY_COUNT(stream->buffers); i++) {
+        struct AudioStreamBuffer *buffer = &stream->buffers[i];
+
+        if (buffer->loading && osRecvMesg(&buffer->dmaQueue, NULL, OS_MESG_NOBLOCK) != -1) {
+            buffer->loading = FALSE;
+        }
+    }
+
+    if (requests & AUDIO_STREAM_REQUEST_STOP) {
+        if (stream->playing) {
+            stream->stopping = TRUE;
+            stream->targetGain = 0;
+        }
+        audio_stream_update_requests(AUDIO_STREAM_REQUEST_STOP, 0);
+    }
+
+    if (requests & AUDIO_STREAM_REQUEST_PLAY) {
+        // The previous stream's buffers may still be read by an RSP task that hasn't run yet.
+        if (audio_stream_buffer_reusable(&stream->buffers[0]) && audio_stream_buffer_reusable(&stream->buffers[1])) {
+            audio_stream_update_requests(AUDIO_STREAM_REQUEST_PLAY | AUDIO_STREAM_REQUEST_VOLUME, 0);
+            audio_stream_start(sAudioStreamRequestRom, sAudioStreamRequestVolume);
+        } else {
+            stream->playing = FALSE;
+        }
+    }
+
+    if (requests & AUDIO_STREAM_REQUEST_VOLUME) {
+        if (!stream->stopping) {
+            stream->targetGain = audio_stream_volume_to_gain(sAudioStreamRequestVolume);
+        }
+        audio_stream_update_requests(AUDIO_STREAM_REQUEST_VOLUME, 0);
+    }
+
+    if (!stream->playing) {
+        return;
+    }
+
+    nextChunk = audio_stream_next_chunk(stream->curChunk);
+    nextBuffer = &stream->buffers[stream->curBuffer ^ 1];
+    if (nextChunk >= 0 && nextBuffer->chunk != nextChunk && audio_stream_buffer_reusable(nextBuffer)) {
+        audio_stream_load_chunk(nextBuffer, nextChunk);
+    }
+}
+
+/**
+ * Moves the gain towards its target for the next audio update. Returns FALSE once a stream that is being stopped is silent.
+ */
+s32 audio_stream_update_gain(void) {
+    struct AudioStream *stream = &gAudioStream;
+
+    if (stream->gain < stream->targetGain) {
+        stream->gain = MIN(stream->gain + AUDIO_STREAM_GAIN_STEP, stream->targetGain);
+    } else if (stream->gain > stream->targetGain) {
+        stream->gain = MAX(stream->gain - AUDIO_STREAM_GAIN_STEP, stream->targetGain);
+    }
+
+    if (stream->stopping && stream->gain == 0) {
+        stream->playing = FALSE;
+        stream->stopping = FALSE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+s32 audio_stream_next_chunk(s32 chunk) {
+    if (chunk + 1 < (s32) gAudioStream.header.numChunks) {
+        return chunk + 1;
+    }
+    return gAudioStream.header.loopChunk;
+}
+
+s32 audio_stream_get_chunk_samples(s32 chunk) {
+    if (chunk == (s32) gAudioStream.header.numChunks - 1) {
+        return gAudioStream.header.lastChunkSamples;
+    }
+    return gAudioStream.header.chunkSamples;
+}
+
+static s32 audio_stream_wait_for_buffer(struct AudioStreamBuffer *buffer, s32 chunk) {
+    if (buffer->chunk != chunk) {
+        return FALSE;
+    }
+    if (buffer->loading) {
+        osRecvMesg(&buffer->dmaQueue, NULL, OS_MESG_BLOCK);
+        buffer->loading = FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Whether the chunks needed for the next nSamples samples are in RAM. Waits for DMAs that are still in flight.
+ */
+s32 audio_stream_ready(s32 nSamples) {
+    struct AudioStream *stream = &gAudioStream;
+    s32 nextChunk;
+
+    if (!audio_stream_wait_for_buffer(&stream->buffers[stream->curBuffer], stream->curChunk)) {
+        return FALSE;
+    }
+
+    if (stream->chunkPos + nSamples > audio_stream_get_chunk_samples(stream->curChunk)) {
+        nextChunk = audio_stream_next_chunk(stream->curChunk);
+        if (nextChunk >= 0 && !audio_stream_wait_for_buffer(&stream->buffers[stream->curBuffer ^ 1], nextChunk)) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+u8 *audio_stream_get_chunk_data(s32 nextBuffer, s32 channel) {
+    struct AudioStream *stream = &gAudioStream;
+
+    return stream->buffers[stream->curBuffer ^ (nextBuffer ? 1 : 0)].data + channel * stream->header.channelStride;
+}
+
+/**
+ * Moves the play position forward after the commands reading nSamples samples have been emitted.
+ */
+void audio_stream_advance(s32 nSamples) {
+    struct AudioStream *stream = &gAudioStream;
+    s32 chunkSamples = audio_stream_get_chunk_samples(stream->curChunk);
+
+    stream->buffers[stream->curBuffer].lastUsedFrame = gAudioFrameCount;
+    stream->chunkPos += nSamples;
+
+    if (stream->chunkPos >= chunkSamples) {
+        stream->chunkPos -= chunkSamples;
+        stream->curChunk = audio_stream_next_chunk(stream->curChunk);
+        stream->curBuffer ^= 1;
+        stream->buffers[stream->curBuffer].lastUsedFrame = gAudioFrameCount;
+
+        if (stream->curChunk < 0) {
+            // Reached the end of a stream without a loop
+            stream->playing = FALSE;
+        }
+    }
+}
+
+#endif
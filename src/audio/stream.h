@@ -0,0 +1,102 @@
+#ifndef AUDIO_STREAM_H
+#define AUDIO_STREAM_H
+
+#include <PR/ultratypes.h>
+
+#include "internal.h"
+
+#ifdef AUDIO_STREAMING
+
+// "STRM"
+#define AUDIO_STREAM_MAGIC 0x5354524D
+
+// Size of each of the two chunk buffers. A stream's chunkStride must fit in one of them.
+#define AUDIO_STREAM_BUFFER_SIZE 0x2000
+
+// An audio update never consumes more than this many samples, so it touches at most two chunks
+#define AUDIO_STREAM_MIN_CHUNK_SAMPLES 0x200
+
+// Largest VADPCM codebook a stream can have (order 2, 8 predictors)
+#define AUDIO_STREAM_BOOK_MAX_ENTRIES (2 * 8 * 8)
+
+enum AudioStreamCodec {
+    AUDIO_STREAM_CODEC_PCM16,
+    AUDIO_STREAM_CODEC_ADPCM,
+};
+
+/**
+ * Header at the start of a stream file, as written by tools/audio_stream.py.
+ *
+ * The sample data following the header is split into chunks of chunkSamples samples per channel,
+ * each chunkStride bytes long. Within a chunk, each channel's data starts at a multiple of
+ * channelStride. ADPCM chunks hold whole 9 byte frames of 16 samples each.
+ */
+struct AudioStreamHeader {
+    /*0x00*/ u32 magic;
+    /*0x04*/ u8 codec; // enum AudioStreamCodec
+    /*0x05*/ u8 numChannels;
+    /*0x06*/ u16 sampleRate;
+    /*0x08*/ u32 numChunks;
+    /*0x0C*/ u32 chunkSamples; // multiple of 16
+    /*0x10*/ u32 lastChunkSamples; // multiple of 16
+    /*0x14*/ u32 channelStride;
+    /*0x18*/ u32 chunkStride;
+    /*0x1C*/ s32 loopChunk; // chunk to continue with after the last one, or -1 to stop
+    /*0x20*/ u16 bookOrder;
+    /*0x22*/ u16 bookNumPredictors;
+    /*0x24*/ u32 dataOffset; // from the start of the header, 16 byte aligned
+    /*0x28*/ u8 pad[8];
+    /*0x30*/ s16 book[AUDIO_STREAM_BOOK_MAX_ENTRIES];
+}; // size = 0x130
+
+struct AudioStreamBuffer {
+    u8 *data;
+    s32 chunk; // -1 if empty
+    s32 lastUsedFrame;
+    u8 loading;
+    OSMesgQueue dmaQueue;
+    OSMesg dmaMesg;
+    OSIoMesg dmaIoMesg;
+};
+
+struct AudioStream {
+    // The header and states are read by the RSP, so they come first to stay 16 byte aligned
+    struct AudioStreamHeader header;
+    s16 adpcmState[2][0x10];
+    s16 resampleState[2][0x10];
+    struct AudioStreamBuffer buffers[2];
+    uintptr_t romData;
+    u8 playing;
+    u8 stopping;
+    u8 needsInit;
+    u8 curBuffer; // buffer holding curChunk, the other one gets the chunk after it
+    u16 resampleRate; // Q15
+    u16 samplePosFrac;
+    s32 curChunk;
+    s32 chunkPos; // in samples
+    s16 gain;
+    s16 targetGain;
+    u32 underruns;
+};
+
+extern struct AudioStream gAudioStream;
+
+// Game thread
+void audio_stream_play(u8 *romHeader, u8 volume);
+void audio_stream_stop(void);
+void audio_stream_set_volume(u8 volume);
+s32 audio_stream_is_playing(void);
+
+// Audio thread
+void audio_stream_reset(void);
+void audio_stream_update(void);
+s32 audio_stream_update_gain(void);
+s32 audio_stream_ready(s32 nSamples);
+s32 audio_stream_next_chunk(s32 chunk);
+s32 audio_stream_get_chunk_samples(s32 chunk);
+u8 *audio_stream_get_chunk_data(s32 nextBuffer, s32 channel);
+void audio_stream_advance(s32 nSamples);
+
+#endif
+
+#endif // AUDIO_STREAM_H
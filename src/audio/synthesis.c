@@ -8,6 +8,7 @@
 #include "seqplayer.h"
 #include "internal.h"
 #include "external.h"
+#include "stream.h"
 #include "game/game_init.h"
 #include "game/debug.h"
 #include "engine/math_util.h"
@@ -25,6 +26,14 @@
 #define DMEM_ADDR_WET_LEFT_CH 0x740
 #define DMEM_ADDR_WET_RIGHT_CH 0x880
 
+#ifdef BETTER_REVERB_RSP
+// Only used at the start of an audio update, before any of the buffers above are live.
+// DMEM_ADDR_REVERB_PARAMS and the windows after it up to 0x940 are hardcoded in rsp/audio.s.
+#define DMEM_ADDR_REVERB_IN 0x0
+#define DMEM_ADDR_REVERB_OUT 0x140
+#define DMEM_ADDR_REVERB_PARAMS 0x280
+#endif
+
 #define aSetLoadBufferPair(pkt, c, off)                                                                \
     aSetBuffer(pkt, 0, c + DMEM_ADDR_WET_LEFT_CH, 0, DEFAULT_LEN_1CH - c);                             \
     aLoadBuffer(pkt, VIRTUAL_TO_PHYSICAL2(gSynthesisReverb.ringBuffer.left + (off)));                  \
@@ -59,6 +68,11 @@ s32 reverbFilterCount;
 s32 betterReverbWindowsSize;
 s32 betterReverbRevIndex; // This one is okay to adjust whenever
 s32 betterReverbGainIndex; // This one is okay to adjust whenever
+#ifdef BETTER_REVERB_RSP
+static ALIGNED16 struct BetterReverbRspParams betterReverbRspParams[SYNTH_CHANNEL_STEREO_COUNT];
+static s32 betterReverbRspPos; // First sample in the ring buffer that hasn't been filtered yet
+static s32 betterReverbRspSamples; // Number of samples from there on waiting to be filtered
+#endif
 #endif
 
 struct VolumeChange {
@@ -68,8 +82,51 @@ struct VolumeChange {
     u16 targetRight;
 };
 
+#ifdef AUDIO_SYNTHESIS_COMMAND_CACHE
+// Large enough for the final resample plus the longest steady state envelope mix.
+#define NOTE_CMD_CACHE_SIZE 8
+
+struct NoteCmdCache {
+    u64 cmds[NOTE_CMD_CACHE_SIZE];
+    struct NoteSynthesisBuffers *synthesisBuffers;
+    u32 key;
+    u32 numCmds;
+};
+
+static struct NoteCmdCache sNoteCmdCache[MAX_SIMULTANEOUS_NOTES];
+
+/**
+ * Whether the commands after the final resample's aSetBuffer only depend on note_cmd_cache_key,
+ * i.e. the resampler and envelope mixer are both continuing with unchanged parameters.
+ */
+static s32 note_cmd_cache_usable(struct Note *note) {
+#ifdef ENABLE_STEREO_HEADSET_EFFECTS
+    if (note->usesHeadsetPanEffects) {
+        return FALSE;
+    }
+#endif
+    return (!note->initFullVelocity && !note->envMixerNeedsInit
+            && (u16) note->curVolLeft == note->targetVolLeft && (u16) note->curVolRight == note->targetVolRight);
+}
+
+static u32 note_cmd_cache_key(struct Note *note, u32 bufLen, u16 resamplingRateFixedPoint) {
+    u32 key = ((u32) resamplingRateFixedPoint << 16) | (bufLen << 3);
+
+    if (gSynthesisReverb.useReverb && note->reverbVol != 0) {
+        key |= (1 << 0);
+    }
+#ifdef ENABLE_STEREO_HEADSET_EFFECTS
+    key |= (note->stereoStrongRight << 1) | (note->stereoStrongLeft << 2);
+#endif
+    return key;
+}
+#endif
+
 u64 *synthesis_do_one_audio_update(s16 *aiBuf, u32 bufLen, u64 *cmd, s32 updateIndex);
 u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd);
+#ifdef AUDIO_STREAMING
+u64 *synthesis_process_stream(u64 *cmd, u32 bufLen);
+#endif
 u64 *load_wave_samples(u64 *cmd, struct Note *note, s32 nSamplesToLoad);
 #ifdef ENABLE_STEREO_HEADSET_EFFECTS
 u64 *process_envelope(u64 *cmd, struct Note *note, s32 nSamples, u16 inBuf, s32 headsetPanSettings);
@@ -83,7 +140,7 @@ struct SynthesisReverb gSynthesisReverb;
 f32 *currentRampingTableLeft;
 f32 *currentRampingTableRight;
 
-#ifdef BETTER_REVERB
+#if defined(BETTER_REVERB) && !defined(BETTER_REVERB_RSP)
 static void reverb_samples(s16 *start, s16 *end, s16 *downsampleBuffer, s32 channel) {
     s16 *curDelaySample;
     s32 historySample;
@@ -172,6 +229,9 @@ static void reverb_samples_light(s16 *start, s16 *end, s16 *downsampleBuffer, s3
     // Copy history sample to temporary buffer for processing next tick
     historySamplesLight[channel] = tmpCarryover;
 }
+#endif
+
+#ifdef BETTER_REVERB
 
 void initialize_better_reverb_buffers(void) {
     delayBufs[SYNTH_CHANNEL_LEFT] = (s16**) soundAlloc(&gBetterReverbPool, BETTER_REVERB_PTR_SIZE);
@@ -181,6 +241,10 @@ void initialize_better_reverb_buffers(void) {
 void set_better_reverb_buffers(u32 *inputDelaysL, u32 *inputDelaysR) {
     s32 bufOffset = 0;
     s32 filterCount = reverbFilterCount;
+#ifdef BETTER_REVERB_RSP
+    struct BetterReverbRspFilter *filterParams;
+    s32 bufSize;
+#endif
     u32 *inputDelayPtrs[SYNTH_CHANNEL_STEREO_COUNT] = {
         [SYNTH_CHANNEL_LEFT]  = inputDelaysL,
         [SYNTH_CHANNEL_RIGHT] = inputDelaysR,
@@ -195,14 +259,43 @@ void set_better_reverb_buffers(u32 *inputDelaysL, u32 *inputDelaysR) {
     if (!toggleBetterReverb)
         return;
 
+#ifdef BETTER_REVERB_RSP
+    aggress(gSynthesisReverb.bufSizePerChannel % 8 == 0, "BETTER_REVERB_RSP needs a reverb window size that is a multiple of 8!");
+    // better_reverb_rsp filters samples two frames after they were written, and leaves up to 7 of them for the next update.
+    // The wet channels read the oldest samples in the ring buffer, so it has to hold two frames and an update on top of
+    // those for the leftover samples to be filtered before they're read.
+    aggress(gSynthesisReverb.bufSizePerChannel >= ((gSamplesPerFrameTarget + 0x10) * 2 + (s32) (DEFAULT_LEN_1CH / sizeof(s16))) / gReverbDownsampleRate + 8,
+            "BETTER_REVERB_RSP needs a larger reverb window size!");
+    betterReverbRspSamples = 0;
+#endif
+
     // NOTE: Using filterCount over NUM_ALLPASS will report less memory usage with fewer filters, but poses an additional
     // risk to anybody testing on console with performance compromises, as emulator can be easily overlooked.
     for (s32 channel = 0; channel < SYNTH_CHANNEL_STEREO_COUNT; channel++) {
         historySamplesLight[channel] = 0;
+#ifdef BETTER_REVERB_RSP
+        betterReverbRspParams[channel].history = 0;
+#endif
         for (s32 filter = 0; filter < filterCount; filter++) {
             betterReverbDelays[channel][filter] = (s32) (inputDelayPtrs[channel][filter] / gReverbDownsampleRate);
+#ifdef BETTER_REVERB_RSP
+            // The RSP runs each filter over whole vectors of 8 samples, and writes a whole chunk of up to DEFAULT_LEN_1CH
+            // bytes to the delay line at once, so it's used as a ring buffer of at least that size.
+            aggress(betterReverbDelays[channel][filter] >= 8 && betterReverbDelays[channel][filter] < 0x7FF8,
+                    "BETTER_REVERB_RSP delays must be between 8 and 0x7FF8 samples after downsampling!");
+            bufSize = ALIGN16(MAX(betterReverbDelays[channel][filter] * (s32) sizeof(s16), DEFAULT_LEN_1CH));
+            delayBufs[channel][filter] = soundAlloc(&gBetterReverbPool, bufSize);
+            bufOffset += bufSize / sizeof(s16);
+
+            filterParams = &betterReverbRspParams[channel].filters[filter];
+            filterParams->buf = (u32) VIRTUAL_TO_PHYSICAL2(delayBufs[channel][filter]);
+            filterParams->size = bufSize;
+            filterParams->writePos = 0;
+            filterParams->delay = betterReverbDelays[channel][filter] * sizeof(s16);
+#else
             delayBufs[channel][filter] = soundAlloc(&gBetterReverbPool, betterReverbDelays[channel][filter] * sizeof(s16));
             bufOffset += betterReverbDelays[channel][filter];
+#endif
         }
     }
 
@@ -210,6 +303,111 @@ void set_better_reverb_buffers(u32 *inputDelaysL, u32 *inputDelaysR) {
 
     bzero(allpassIdx, sizeof(allpassIdx));
 }
+
+#ifdef BETTER_REVERB_RSP
+/**
+ * Stores the Q8 coefficients of one filter the way cmd_REVERB multiplies by them, as (x & 0xFF) << 8 and x >> 8 pairs.
+ * With the filter's history h and its input c, the filter stores c + h * newSample in its delay line, adds h * out to the
+ * output and passes h * carryHistory + (the new sample) * carryNew on to the next filter.
+ */
+static void better_reverb_rsp_set_coefs(u16 *coefs, s32 newSample, s32 carryHistory, s32 carryNew, s32 out) {
+    s32 values[4] = { newSample, carryHistory, carryNew, out };
+    s32 i;
+
+    for (i = 0; i < ARRAY_COUNT(values); i++) {
+        coefs[i * 2] = (values[i] & 0xFF) << 8;
+        coefs[i * 2 + 1] = values[i] >> 8;
+    }
+}
+
+/**
+ * Updates the filter network gains for cmd_REVERB, the same ones reverb_samples and reverb_samples_light use.
+ */
+static void better_reverb_rsp_update_coefs(void) {
+    struct BetterReverbRspParams *params;
+    s32 channel;
+    s32 i;
+
+    for (channel = 0; channel < SYNTH_CHANNEL_STEREO_COUNT; channel++) {
+        params = &betterReverbRspParams[channel];
+
+        if (betterReverbLightweight) {
+            // Feedback from the previous output sample, then the all-pass filters
+            better_reverb_rsp_set_coefs(params->coefs[0], BETTER_REVERB_REVERB_INDEX_LIGHT, 0, 0x100, 0);
+            better_reverb_rsp_set_coefs(params->coefs[1], -BETTER_REVERB_GAIN_INDEX_LIGHT, 0x100, BETTER_REVERB_GAIN_INDEX_LIGHT, 0);
+            continue;
+        }
+
+        // Feedback from the last filter's history, which isn't written to its delay line
+        better_reverb_rsp_set_coefs(params->coefs[0], betterReverbRevIndex, 0, 0x100, 0);
+
+        for (i = 0; i < reverbFilterCount; i++) {
+            if (i % 3 == 2) {
+                better_reverb_rsp_set_coefs(params->coefs[i + 1], 0, betterReverbRevIndex, 0, reverbMults[channel][i / 3]);
+            } else {
+                better_reverb_rsp_set_coefs(params->coefs[i + 1], -betterReverbGainIndex, 0x100, betterReverbGainIndex, 0);
+            }
+        }
+    }
+}
+
+/**
+ * Emits the commands that run the filter network over the samples prepare_reverb_ring_buffer queued up, in place in
+ * the reverb ring buffer. Only whole vectors of 8 samples are filtered, the rest is left for the next audio update.
+ * That is always before the wet channels read them, since they read the oldest samples in the ring buffer and
+ * set_better_reverb_buffers checks the ring buffer is long enough. This goes at the start of the audio update, where
+ * the region of the ring buffer being filtered is not touched by anything else in the task.
+ */
+static u64 *better_reverb_rsp(u64 *cmd) {
+    s32 ringSize = gSynthesisReverb.bufSizePerChannel;
+    s32 mono = (gSoundMode == SOUND_MODE_MONO || monoReverb);
+    s32 filterCount = betterReverbLightweight ? BETTER_REVERB_FILTER_COUNT_LIGHT : reverbFilterCount;
+    u16 out = betterReverbLightweight ? DMEM_ADDR_REVERB_IN : DMEM_ADDR_REVERB_OUT;
+    s16 *rings[SYNTH_CHANNEL_STEREO_COUNT] = {
+        [SYNTH_CHANNEL_LEFT]  = gSynthesisReverb.ringBuffer.left,
+        [SYNTH_CHANNEL_RIGHT] = gSynthesisReverb.ringBuffer.right,
+    };
+    s32 nSamples, nBytes;
+    s32 channel;
+
+    while (betterReverbRspSamples >= 8) {
+        nSamples = MIN(betterReverbRspSamples & ~7, (s32) (DEFAULT_LEN_1CH / sizeof(s16)));
+        nSamples = MIN(nSamples, ringSize - betterReverbRspPos);
+        nBytes = nSamples * sizeof(s16);
+
+        for (channel = 0; channel < (mono ? 1 : SYNTH_CHANNEL_STEREO_COUNT); channel++) {
+            aSetBuffer(cmd++, 0, DMEM_ADDR_REVERB_IN, 0, nBytes);
+            aLoadBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(&rings[channel][betterReverbRspPos]));
+            if (mono) {
+                // Merge stereo samples into one channel, using the output buffer as temporary space
+                aSetBuffer(cmd++, 0, DMEM_ADDR_REVERB_OUT, 0, nBytes);
+                aLoadBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(&rings[SYNTH_CHANNEL_RIGHT][betterReverbRspPos]));
+                aSetBuffer(cmd++, 0, 0, 0, nBytes);
+                aMix(cmd++, 0, /*gain*/ 0xC000, /*in*/ DMEM_ADDR_REVERB_IN, /*out*/ DMEM_ADDR_REVERB_IN);
+                aMix(cmd++, 0, /*gain*/ 0x4000, /*in*/ DMEM_ADDR_REVERB_OUT, /*out*/ DMEM_ADDR_REVERB_IN);
+            }
+            if (!betterReverbLightweight) {
+                aClearBuffer(cmd++, DMEM_ADDR_REVERB_OUT, nBytes);
+            }
+            aSetBuffer(cmd++, 0, DMEM_ADDR_REVERB_IN, out, nBytes);
+            aBetterReverb(cmd++, filterCount, betterReverbLightweight, VIRTUAL_TO_PHYSICAL2(&betterReverbRspParams[channel]));
+            aSetBuffer(cmd++, 0, 0, out, nBytes);
+            aSaveBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(&rings[channel][betterReverbRspPos]));
+            if (mono) {
+                aSaveBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(&rings[SYNTH_CHANNEL_RIGHT][betterReverbRspPos]));
+            }
+        }
+
+        betterReverbRspSamples -= nSamples;
+        betterReverbRspPos += nSamples;
+        if (betterReverbRspPos == ringSize) {
+            betterReverbRspPos = 0;
+        }
+    }
+
+    return cmd;
+}
+#endif
 #endif
 
 void prepare_reverb_ring_buffer(s32 chunkLen, u32 updateIndex) {
@@ -219,7 +417,7 @@ void prepare_reverb_ring_buffer(s32 chunkLen, u32 updateIndex) {
     s32 excessiveSamples;
 
     if (gSynthesisReverb.framesLeftToIgnore == 0) {
-#ifdef BETTER_REVERB
+#if defined(BETTER_REVERB) && !defined(BETTER_REVERB_RSP)
         if (!toggleBetterReverb && gReverbDownsampleRate != 1) {
 #else
         if (gReverbDownsampleRate != 1) {
@@ -241,7 +439,16 @@ void prepare_reverb_ring_buffer(s32 chunkLen, u32 updateIndex) {
                 gSynthesisReverb.ringBuffer.right[dstPos] = item->toDownsampleRight[srcPos];
             }
         }
-#ifdef BETTER_REVERB
+#ifdef BETTER_REVERB_RSP
+        if (toggleBetterReverb) {
+            // Filtered in place in the ring buffer by better_reverb_rsp
+            item = &gSynthesisReverb.items[gSynthesisReverb.curFrame][updateIndex];
+            if (betterReverbRspSamples == 0) {
+                betterReverbRspPos = item->startPos;
+            }
+            betterReverbRspSamples += (item->lengthA + item->lengthB) / 2;
+        }
+#elif defined(BETTER_REVERB)
         else if (toggleBetterReverb) {
             s32 loopCounts[2];
 
@@ -334,6 +541,10 @@ u64 *synthesis_execute(u64 *cmdBuf, s32 *writtenCmds, s16 *aiBuf, s32 bufLen) {
 
     aSegment(cmdBuf, 0, 0);
 
+#ifdef AUDIO_STREAMING
+    audio_stream_update();
+#endif
+
 #ifdef BETTER_REVERB
     s32 filterCountDiv3 = reverbFilterCount / 3;
     reverbFilterCount = filterCountDiv3 * 3; // reverbFilterCount should always be a multiple of 3.
@@ -359,6 +570,10 @@ u64 *synthesis_execute(u64 *cmdBuf, s32 *writtenCmds, s16 *aiBuf, s32 bufLen) {
         reverbMults[SYNTH_CHANNEL_LEFT][0] = (reverbMults[SYNTH_CHANNEL_RIGHT][0] + reverbMults[SYNTH_CHANNEL_LEFT][0]) / 2;
         reverbMults[SYNTH_CHANNEL_RIGHT][0] = reverbMults[SYNTH_CHANNEL_LEFT][0];
     }
+
+#ifdef BETTER_REVERB_RSP
+    better_reverb_rsp_update_coefs();
+#endif
 #endif
 
     for (i = gAudioUpdatesPerFrame; i > 0; i--) {
@@ -385,6 +600,9 @@ u64 *synthesis_execute(u64 *cmdBuf, s32 *writtenCmds, s16 *aiBuf, s32 bufLen) {
 
         if (gSynthesisReverb.useReverb) {
             prepare_reverb_ring_buffer(chunkLen, gAudioUpdatesPerFrame - i);
+#ifdef BETTER_REVERB_RSP
+            cmd = better_reverb_rsp(cmd);
+#endif
         }
         cmd = synthesis_do_one_audio_update((s16 *) aiBufPtr, chunkLen * 2, cmd, gAudioUpdatesPerFrame - i);
 
@@ -522,6 +740,12 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
     s32 resampledTempLen;                    // spD8, spAC
     u16 noteSamplesDmemAddrBeforeResampling = 0; // spD6, spAA
     u16 resamplingRateFixedPoint;            // sp5c, sp11A
+#ifdef AUDIO_SYNTHESIS_COMMAND_CACHE
+    struct NoteCmdCache *cmdCache;
+    u32 cmdCacheKey;
+    u64 *cachedCmdsStart;
+    u32 i;
+#endif
 
     switch (bufLen) {
         case (128 * 2):
@@ -650,9 +874,21 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
             
                             AUDIO_PROFILER_SWITCH(PROFILER_TIME_SUB_AUDIO_SYNTHESIS_PROCESSING, PROFILER_TIME_SUB_AUDIO_SYNTHESIS_DMA);
 
+#ifdef AUDIO_SAMPLE_PREFETCH
+                            claim_prefetched_sample_data((uintptr_t) (sampleAddr + temp * 9), t0 * 9,
+                                &note->sampleDmaIndex, &note->samplePrefetchDmaIndex);
+#endif
                             v0_2 = dma_sample_data(
                                 (uintptr_t) (sampleAddr + temp * 9),
                                 t0 * 9, flags, &note->sampleDmaIndex);
+#ifdef AUDIO_SAMPLE_PREFETCH
+                            // Queue up whatever follows this chunk, assuming the note keeps reading at the same rate.
+                            // Loop points and note ends are left to the demand path.
+                            if (flags == 0 && !restart && !noteFinished) {
+                                prefetch_sample_data((uintptr_t) (sampleAddr + (temp + t0) * 9), t0 * 9,
+                                    note->sampleDmaIndex, &note->samplePrefetchDmaIndex);
+                            }
+#endif
 
                             AUDIO_PROFILER_SWITCH(PROFILER_TIME_SUB_AUDIO_SYNTHESIS_DMA, PROFILER_TIME_SUB_AUDIO_SYNTHESIS_PROCESSING);
 
@@ -769,8 +1005,29 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
                 note->needsInit = FALSE;
             }
 
+#ifdef AUDIO_SYNTHESIS_COMMAND_CACHE
+            // Only the input address of the final resample changes between updates of a steady note,
+            // so everything after it can be replayed from the last update.
+            cmdCache = NULL;
+            if (flags == 0 && note_cmd_cache_usable(note)) {
+                cmdCache = &sNoteCmdCache[noteIndex];
+                cmdCacheKey = note_cmd_cache_key(note, bufLen, resamplingRateFixedPoint);
+                if (cmdCache->numCmds != 0 && cmdCache->key == cmdCacheKey
+                    && cmdCache->synthesisBuffers == note->synthesisBuffers) {
+                    aSetBuffer(cmd++, /*flags*/ 0, noteSamplesDmemAddrBeforeResampling, /*dmemout*/ DMEM_ADDR_TEMP, bufLen);
+                    for (i = 0; i < cmdCache->numCmds; i++) {
+                        *cmd++ = cmdCache->cmds[i];
+                    }
+                    continue;
+                }
+            }
+#endif
+
             // final resample
             aSetBuffer(cmd++, /*flags*/ 0, noteSamplesDmemAddrBeforeResampling, /*dmemout*/ DMEM_ADDR_TEMP, bufLen);
+#ifdef AUDIO_SYNTHESIS_COMMAND_CACHE
+            cachedCmdsStart = cmd;
+#endif
             aResample(cmd++, flags, resamplingRateFixedPoint, VIRTUAL_TO_PHYSICAL2(note->synthesisBuffers->finalResampleState));
 
 #ifdef ENABLE_STEREO_HEADSET_EFFECTS
@@ -794,9 +1051,27 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
             cmd = process_envelope(cmd, note, bufLen, 0);
             AUDIO_PROFILER_SWITCH(PROFILER_TIME_SUB_AUDIO_SYNTHESIS_ENVELOPE_REVERB, PROFILER_TIME_SUB_AUDIO_SYNTHESIS_PROCESSING);
 #endif
+
+#ifdef AUDIO_SYNTHESIS_COMMAND_CACHE
+            if (cmdCache != NULL) {
+                cmdCache->numCmds = 0;
+                if (cmd - cachedCmdsStart <= NOTE_CMD_CACHE_SIZE) {
+                    cmdCache->numCmds = cmd - cachedCmdsStart;
+                    cmdCache->key = cmdCacheKey;
+                    cmdCache->synthesisBuffers = note->synthesisBuffers;
+                    for (i = 0; i < cmdCache->numCmds; i++) {
+                        cmdCache->cmds[i] = cachedCmdsStart[i];
+                    }
+                }
+            }
+#endif
         }
     }
 
+#ifdef AUDIO_STREAMING
+    cmd = synthesis_process_stream(cmd, bufLen);
+#endif
+
     aSetBuffer(cmd++, 0, 0, DMEM_ADDR_TEMP, bufLen);
     aInterleave(cmd++, DMEM_ADDR_LEFT_CH, DMEM_ADDR_RIGHT_CH);
     aSetBuffer(cmd++, 0, 0, DMEM_ADDR_TEMP, bufLen * 2);
@@ -805,6 +1080,145 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
     return cmd;
 }
 
+#ifdef AUDIO_STREAMING
+/**
+ * Loads or decodes the next nSamples samples of one of the stream's channels into DMEM, using the same buffers as
+ * ADPCM notes. The samples may continue into the next chunk. Returns the DMEM address of the first sample.
+ */
+static u64 *load_stream_samples(u64 *cmd, s32 channel, s32 nSamples, s32 flags, u16 *samplesDmemAddr) {
+    struct AudioStream *stream = &gAudioStream;
+    s32 chunk = stream->curChunk;
+    s32 chunkPos = stream->chunkPos;
+    s32 nextBuffer = FALSE;
+    s32 nProcessed = 0;
+    u16 dmemAddr = DMEM_ADDR_UNCOMPRESSED_NOTE;
+    s32 decodedEnd = 0;
+    s32 nFrames;
+    s32 nSamplesInThisIteration;
+    s32 s2;
+    u32 a3;
+    u8 *sampleAddr;
+
+    if (stream->header.codec == AUDIO_STREAM_CODEC_ADPCM) {
+        // The decoder output starts with the last frame it decoded, which holds the samples
+        // up to chunkPos that were not consumed yet.
+        s2 = chunkPos & 0xf;
+        if (s2 == 0) {
+            s2 = 16;
+        }
+        *samplesDmemAddr = DMEM_ADDR_UNCOMPRESSED_NOTE + s2 * 2;
+        decodedEnd = ALIGN16(chunkPos);
+    } else {
+        *samplesDmemAddr = DMEM_ADDR_UNCOMPRESSED_NOTE + ((chunkPos * 2) & 7);
+    }
+
+    while (nProcessed < nSamples) {
+        sampleAddr = audio_stream_get_chunk_data(nextBuffer, channel);
+        nSamplesInThisIteration = MIN(nSamples - nProcessed, audio_stream_get_chunk_samples(chunk) - chunkPos);
+
+        if (stream->header.codec == AUDIO_STREAM_CODEC_ADPCM) {
+            nFrames = 0;
+            if (chunkPos + nSamplesInThisIteration > decodedEnd) {
+                nFrames = (chunkPos + nSamplesInThisIteration - decodedEnd + 0xf) / 16;
+            }
+            sampleAddr += (decodedEnd / 16) * 9;
+            a3 = (uintptr_t) sampleAddr & 0xf;
+            if (nFrames != 0) {
+                aSetBuffer(cmd++, 0, DMEM_ADDR_COMPRESSED_ADPCM_DATA, 0, nFrames * 9 + a3);
+                aLoadBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(sampleAddr - a3));
+            }
+            aSetBuffer(cmd++, 0, DMEM_ADDR_COMPRESSED_ADPCM_DATA + a3, dmemAddr, nFrames * 16 * sizeof(s16));
+            aADPCMdec(cmd++, flags, VIRTUAL_TO_PHYSICAL2(stream->adpcmState[channel]));
+            flags = 0;
+            // The next decode repeats the last frame at its start, so it overwrites it with the same samples
+            dmemAddr += nFrames * 16 * sizeof(s16);
+        } else {
+            sampleAddr += chunkPos * sizeof(s16);
+            a3 = (uintptr_t) sampleAddr & 7;
+            aSetBuffer(cmd++, 0, dmemAddr, 0, ALIGN8(nSamplesInThisIteration * sizeof(s16) + a3));
+            aLoadBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(sampleAddr - a3));
+            // Chunks are a multiple of 16 samples long, so this stays 8 byte aligned
+            dmemAddr += a3 + nSamplesInThisIteration * sizeof(s16);
+        }
+
+        nProcessed += nSamplesInThisIteration;
+        chunkPos += nSamplesInThisIteration;
+
+        if (chunkPos == audio_stream_get_chunk_samples(chunk)) {
+            chunk = audio_stream_next_chunk(chunk);
+            chunkPos = 0;
+            decodedEnd = 0;
+            if (chunk < 0 || nextBuffer) {
+                break;
+            }
+            nextBuffer = TRUE;
+        }
+    }
+
+    if (nProcessed < nSamples) {
+        // End of the stream
+        aClearBuffer(cmd++, *samplesDmemAddr + nProcessed * 2, (nSamples - nProcessed) * 2);
+    }
+
+    return cmd;
+}
+
+/**
+ * Mixes the streamed track into the dry output, like a note without an envelope or reverb.
+ */
+u64 *synthesis_process_stream(u64 *cmd, u32 bufLen) {
+    struct AudioStream *stream = &gAudioStream;
+    u32 samplesLenFixedPoint;
+    s32 nSamples;
+    s32 channel;
+    s32 flags;
+    u16 samplesDmemAddr;
+
+    if (!stream->playing || !audio_stream_update_gain()) {
+        return cmd;
+    }
+
+    samplesLenFixedPoint = stream->samplePosFrac + (stream->resampleRate * bufLen);
+    nSamples = samplesLenFixedPoint >> 16;
+
+    if (!audio_stream_ready(nSamples)) {
+        // The next chunk did not make it in time, skip this update rather than play stale data
+        stream->underruns++;
+        return cmd;
+    }
+    stream->samplePosFrac = samplesLenFixedPoint & 0xFFFF;
+
+    flags = 0;
+    if (stream->needsInit) {
+        flags = A_INIT;
+        stream->needsInit = FALSE;
+    }
+
+    if (stream->header.codec == AUDIO_STREAM_CODEC_ADPCM) {
+        aLoadADPCM(cmd++, stream->header.bookOrder * stream->header.bookNumPredictors * 16U,
+                   VIRTUAL_TO_PHYSICAL2(stream->header.book));
+    }
+
+    for (channel = 0; channel < stream->header.numChannels; channel++) {
+        cmd = load_stream_samples(cmd, channel, nSamples, flags, &samplesDmemAddr);
+
+        aSetBuffer(cmd++, /*flags*/ 0, samplesDmemAddr, /*dmemout*/ DMEM_ADDR_TEMP, bufLen);
+        aResample(cmd++, flags, stream->resampleRate, VIRTUAL_TO_PHYSICAL2(stream->resampleState[channel]));
+
+        aSetBuffer(cmd++, 0, 0, 0, bufLen);
+        if (stream->header.numChannels == 1 || channel == SYNTH_CHANNEL_LEFT) {
+            aMix(cmd++, 0, /*gain*/ stream->gain, /*in*/ DMEM_ADDR_TEMP, /*out*/ DMEM_ADDR_LEFT_CH);
+        }
+        if (stream->header.numChannels == 1 || channel == SYNTH_CHANNEL_RIGHT) {
+            aMix(cmd++, 0, /*gain*/ stream->gain, /*in*/ DMEM_ADDR_TEMP, /*out*/ DMEM_ADDR_RIGHT_CH);
+        }
+    }
+
+    audio_stream_advance(nSamples);
+    return cmd;
+}
+#endif
+
 u64 *load_wave_samples(u64 *cmd, struct Note *note, s32 nSamplesToLoad) {
     s32 a3;
     s32 repeats;
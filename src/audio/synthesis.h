@@ -17,6 +17,13 @@
 #define MAX_UPDATES_PER_FRAME 4
 #endif
 
+#ifdef AUDIO_STREAMING
+// Upper bound on the audio commands the streamed track adds to each audio update
+#define AUDIO_STREAM_MAX_CMDS_PER_UPDATE 32
+#else
+#define AUDIO_STREAM_MAX_CMDS_PER_UPDATE 0
+#endif
+
 enum ChannelIndexes {
     SYNTH_CHANNEL_LEFT,
     SYNTH_CHANNEL_RIGHT,
@@ -39,6 +46,14 @@ enum ChannelIndexes {
 // as this default is configured to handle the emulator RCVI settings.
 #define BETTER_REVERB_SIZE ALIGN16(0xEDE0 + BETTER_REVERB_PTR_SIZE)
 
+#ifdef BETTER_REVERB_RSP
+// Upper bound on the audio commands better_reverb_rsp emits per audio update: two chunks (the second one only when the ring
+// buffer wraps around) of up to 14 commands each.
+#define BETTER_REVERB_RSP_MAX_CMDS_PER_UPDATE (2 * 14)
+#else
+#define BETTER_REVERB_RSP_MAX_CMDS_PER_UPDATE 0
+#endif
+
 
 /* ------ BETTER REVERB LIGHTWEIGHT PARAMETER OVERRIDES ------ */
 
@@ -51,6 +66,44 @@ enum ChannelIndexes {
 #define BETTER_REVERB_REVERB_INDEX_LIGHT 0x30 // Advanced parameter; used to tune the reuse of the previously processed output sample (multiples of 0x10 will compile more efficiently)
 
 
+/* --------------- BETTER REVERB RSP COMMAND ---------------- */
+
+#ifdef BETTER_REVERB_RSP
+// Takes the place of A_POLEF, which SM64 doesn't use, in the audio microcode (see cmd_REVERB in rsp/audio.s).
+#define A_BETTER_REVERB 14
+
+/*
+ * Runs the filter network over the samples set up with aSetBuffer. The standard network adds its output to the output
+ * buffer, while the lightweight network replaces the input with its output. p is the address of a struct BetterReverbRspParams.
+ */
+#define aBetterReverb(pkt, filterCount, lightweight, p)                              \
+{                                                                                   \
+        Acmd *_a = (Acmd *)pkt;                                                     \
+                                                                                    \
+        _a->words.w0 = (_SHIFTL(A_BETTER_REVERB, 24, 8) | _SHIFTL(filterCount, 4, 12) | \
+                        _SHIFTL(lightweight, 0, 1));                                \
+        _a->words.w1 = (uintptr_t)(p);                                              \
+}
+
+// A delay line of cmd_REVERB. Only written by the CPU when the buffers are set up, the RSP keeps it up to date after that.
+struct BetterReverbRspFilter {
+    /*0x00*/ u32 buf; // Physical address of the ring buffer
+    /*0x04*/ u16 size; // Ring buffer size in bytes, a multiple of 16 that fits a whole audio update
+    /*0x06*/ u16 writePos; // In bytes
+    /*0x08*/ u16 delay; // In bytes
+    /*0x0A*/ u16 pad[3];
+}; // size = 0x10
+
+// Parameters of cmd_REVERB for one channel. The RSP writes back everything before coefs after each command.
+struct BetterReverbRspParams {
+    /*0x000*/ s16 history; // Previous output sample of the lightweight network
+    /*0x002*/ u16 pad[7];
+    /*0x010*/ struct BetterReverbRspFilter filters[NUM_ALLPASS];
+    /*0x0D0*/ u16 coefs[NUM_ALLPASS + 1][8]; // Feedback, then one set per filter, see better_reverb_rsp_set_coefs
+}; // size = 0x1A0
+#endif
+
+
 /* ------------ BETTER REVERB EXTERNED VARIABLES ------------ */
 
 extern u8 toggleBetterReverb;
@@ -77,10 +130,18 @@ void set_better_reverb_buffers(u32 *inputDelaysL, u32 *inputDelaysR);
 STATIC_ASSERT(NUM_ALLPASS % 3 == 0, "NUM_ALLPASS must be a multiple of 3!");
 STATIC_ASSERT(BETTER_REVERB_FILTER_COUNT_LIGHT > 0, "BETTER_REVERB_FILTER_COUNT_LIGHT must be greater than 0!");
 STATIC_ASSERT(BETTER_REVERB_FILTER_COUNT_LIGHT <= NUM_ALLPASS, "BETTER_REVERB_FILTER_COUNT_LIGHT cannot be larger than NUM_ALLPASS!");
+#ifdef BETTER_REVERB_RSP
+STATIC_ASSERT(BETTER_REVERB_FILTER_COUNT_LIGHT == 2, "BETTER_REVERB_RSP only supports a BETTER_REVERB_FILTER_COUNT_LIGHT of 2!");
+// These offsets are hardcoded in rsp/audio.s
+STATIC_ASSERT(offsetof(struct BetterReverbRspParams, filters) == 0x10, "BetterReverbRspParams doesn't match the microcode!");
+STATIC_ASSERT(offsetof(struct BetterReverbRspParams, coefs) == 0xD0, "BetterReverbRspParams doesn't match the microcode!");
+STATIC_ASSERT(sizeof(struct BetterReverbRspParams) == 0x1A0, "BetterReverbRspParams doesn't match the microcode!");
+#endif
 
 #else
 
 #define BETTER_REVERB_SIZE 0
+#define BETTER_REVERB_RSP_MAX_CMDS_PER_UPDATE 0
 
 #ifdef VERSION_EU
 #define REVERB_WINDOW_SIZE_MAX 0x1000
@@ -0,0 +1,177 @@
+#include <ultra64.h>
+
+#include "sm64.h"
+
+#ifdef STREAMED_DECOMPRESSION
+
+#include <gzip.h>
+
+#include "dma_stream.h"
+#include "game/memory.h"
+
+/**
+ * Start the DMA of the next chunk into the half of the buffer that isn't being read.
+ */
+static void dma_stream_request(struct DmaStream *stream) {
+    u8 *dest = stream->buffer + (stream->pendingHalf * DMA_STREAM_CHUNK_SIZE);
+    u32 size = stream->romEnd - stream->romPos;
+
+    if (size > DMA_STREAM_CHUNK_SIZE) {
+        size = DMA_STREAM_CHUNK_SIZE;
+    }
+    stream->pendingSize = size;
+    if (size != 0) {
+        osInvalDCache(dest, size);
+        osPiStartDma(&stream->ioMesg, OS_MESG_PRI_NORMAL, OS_READ, (uintptr_t) stream->romPos, dest, size,
+                     &stream->queue);
+        stream->romPos += size;
+    }
+}
+
+/**
+ * Start streaming the ROM data from srcStart to srcEnd into buffer, and wait for the first chunk.
+ * The DMAs are widened to 16 byte boundaries, so srcStart doesn't need to be aligned.
+ */
+void dma_stream_open(struct DmaStream *stream, u8 *buffer, u8 *srcStart, u8 *srcEnd) {
+    u32 skip = (uintptr_t) srcStart & 0xF;
+
+    osCreateMesgQueue(&stream->queue, stream->mesgBuf, ARRAY_COUNT(stream->mesgBuf));
+    stream->buffer = buffer;
+    stream->romPos = srcStart - skip;
+    stream->romEnd = (u8 *) ALIGN16((uintptr_t) srcEnd);
+    stream->pendingHalf = 0;
+    dma_stream_request(stream);
+    dma_stream_refill(stream);
+    stream->readPos += skip;
+}
+
+/**
+ * Wait for the chunk in flight to arrive and start reading it, then start the DMA of the one after it
+ * into the half of the buffer that was just finished with.
+ * At the end of the stream, this leaves nothing to read.
+ */
+void dma_stream_refill(struct DmaStream *stream) {
+    u8 *chunk = stream->buffer + (stream->pendingHalf * DMA_STREAM_CHUNK_SIZE);
+
+    if (stream->pendingSize != 0) {
+        osRecvMesg(&stream->queue, NULL, OS_MESG_BLOCK);
+    }
+    stream->readPos = chunk;
+    stream->readEnd = chunk + stream->pendingSize;
+    stream->pendingHalf ^= 1;
+    dma_stream_request(stream);
+}
+
+/**
+ * Read the rest of the current chunk, or all of the next one if the current one is finished.
+ * The data stays valid until the next read. The size is 0 at the end of the stream.
+ */
+u8 *dma_stream_read_chunk(struct DmaStream *stream, u32 *size) {
+    u8 *chunk;
+
+    if (stream->readPos == stream->readEnd) {
+        dma_stream_refill(stream);
+    }
+    chunk = stream->readPos;
+    *size = stream->readEnd - chunk;
+    stream->readPos = stream->readEnd;
+    return chunk;
+}
+
+/**
+ * Wait for the DMA in flight, so the buffer can be reused.
+ */
+void dma_stream_close(struct DmaStream *stream) {
+    if (stream->pendingSize != 0) {
+        osRecvMesg(&stream->queue, NULL, OS_MESG_BLOCK);
+        stream->pendingSize = 0;
+    }
+}
+
+static u32 dma_stream_read_u32(struct DmaStream *stream) {
+    u32 val = dma_stream_read_byte(stream) << 24;
+    val |= dma_stream_read_byte(stream) << 16;
+    val |= dma_stream_read_byte(stream) << 8;
+    return val | dma_stream_read_byte(stream);
+}
+
+/**
+ * Unpack YAY0 data while it's read from ROM. The mask, link and chunk tables are each read
+ * through their own stream, so only six chunks of compressed data are ever in memory.
+ * Returns FALSE if there wasn't room for the buffers.
+ */
+s32 yay0_stream_unpack(u8 *srcStart, u8 *srcEnd, u8 *dest) {
+    ALIGNED16 u32 header[4];
+    struct DmaStream masks, links, chunks;
+    u8 *buffer = main_pool_alloc(YAY0_STREAM_SCRATCH_SIZE, MEMORY_POOL_RIGHT);
+    u8 *end;
+    u32 mask = 0;
+    s32 maskBits = 0;
+
+    if (buffer == NULL) {
+        return FALSE;
+    }
+    // "Yay0", decompressed size, link table offset, chunk table offset
+    dma_read((u8 *) header, srcStart, srcStart + sizeof(header));
+    end = dest + header[1];
+    dma_stream_open(&masks, buffer, srcStart + sizeof(header), srcStart + header[2]);
+    dma_stream_open(&links, buffer + DMA_STREAM_BUFFER_SIZE, srcStart + header[2], srcStart + header[3]);
+    dma_stream_open(&chunks, buffer + (DMA_STREAM_BUFFER_SIZE * 2), srcStart + header[3], srcEnd);
+
+    while (dest < end) {
+        if (maskBits == 0) {
+            mask = dma_stream_read_u32(&masks);
+            maskBits = 32;
+        }
+        if (mask & 0x80000000) {
+            *dest++ = dma_stream_read_byte(&chunks);
+        } else {
+            u32 link = dma_stream_read_byte(&links) << 8;
+            link |= dma_stream_read_byte(&links);
+
+            u8 *copy = dest - (link & 0xFFF) - 1;
+            u32 length = link >> 12;
+            if (length == 0) {
+                length = dma_stream_read_byte(&chunks) + 0x12;
+            } else {
+                length += 2;
+            }
+            do {
+                *dest++ = *copy++;
+            } while (--length != 0);
+        }
+        mask <<= 1;
+        maskBits--;
+    }
+
+    dma_stream_close(&masks);
+    dma_stream_close(&links);
+    dma_stream_close(&chunks);
+    main_pool_free(buffer);
+    return TRUE;
+}
+
+static u8 *gzip_stream_fill(void *stream, u32 *size) {
+    return dma_stream_read_chunk(stream, size);
+}
+
+/**
+ * Inflate raw DEFLATE data while it's read from ROM. Inflating a piece at a time
+ * needs a 32KB window on top of the stream buffer.
+ * Returns FALSE if there wasn't room for the buffers.
+ */
+s32 gzip_stream_unpack(u8 *srcStart, u8 *srcEnd, u8 *dest, u32 size) {
+    struct DmaStream stream;
+    u8 *buffer = main_pool_alloc(GZIP_STREAM_SCRATCH_SIZE, MEMORY_POOL_RIGHT);
+
+    if (buffer == NULL) {
+        return FALSE;
+    }
+    dma_stream_open(&stream, buffer, srcStart, srcEnd);
+    expand_gzip_stream(gzip_stream_fill, &stream, buffer + DMA_STREAM_BUFFER_SIZE, dest, size);
+    dma_stream_close(&stream);
+    main_pool_free(buffer);
+    return TRUE;
+}
+
+#endif
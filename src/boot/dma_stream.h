@@ -0,0 +1,53 @@
+#ifndef DMA_STREAM_H
+#define DMA_STREAM_H
+
+#include <ultra64.h>
+
+#include <gzip.h>
+
+#include "config.h"
+
+#ifdef STREAMED_DECOMPRESSION
+
+#define DMA_STREAM_CHUNK_SIZE 0x1000
+#define DMA_STREAM_BUFFER_SIZE (DMA_STREAM_CHUNK_SIZE * 2)
+
+// Memory needed while streaming a segment. Segments up to this size are read in whole instead, which needs less.
+#define YAY0_STREAM_SCRATCH_SIZE (DMA_STREAM_BUFFER_SIZE * 3)
+#define GZIP_STREAM_SCRATCH_SIZE (DMA_STREAM_BUFFER_SIZE + GZIP_STREAM_WINDOW_SIZE)
+
+/**
+ * Reads a block of ROM a chunk at a time into a buffer with room for two chunks,
+ * so one chunk can be read while the next one is being DMAed into the other half.
+ */
+struct DmaStream {
+    OSIoMesg ioMesg;
+    OSMesgQueue queue;
+    OSMesg mesgBuf[1];
+    u8 *buffer;      // DMA_STREAM_BUFFER_SIZE bytes
+    u8 *romPos;      // Next address to DMA from
+    u8 *romEnd;
+    u8 *readPos;     // Next byte to read in the current chunk
+    u8 *readEnd;
+    u32 pendingSize; // Size of the DMA in flight, 0 if there isn't one
+    u32 pendingHalf; // Half of the buffer it's filling
+};
+
+void dma_stream_open(struct DmaStream *stream, u8 *buffer, u8 *srcStart, u8 *srcEnd);
+void dma_stream_refill(struct DmaStream *stream);
+u8 *dma_stream_read_chunk(struct DmaStream *stream, u32 *size);
+void dma_stream_close(struct DmaStream *stream);
+
+static inline u8 dma_stream_read_byte(struct DmaStream *stream) {
+    if (stream->readPos == stream->readEnd) {
+        dma_stream_refill(stream);
+    }
+    return *stream->readPos++;
+}
+
+s32 yay0_stream_unpack(u8 *srcStart, u8 *srcEnd, u8 *dest);
+s32 gzip_stream_unpack(u8 *srcStart, u8 *srcEnd, u8 *dest, u32 size);
+
+#endif
+
+#endif // DMA_STREAM_H
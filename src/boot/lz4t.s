@@ -0,0 +1,117 @@
+# assembler directives
+.set noat      # allow manual use of $at
+.set noreorder # don't insert nops after branches
+.set gp=64
+
+.include "macros.inc"
+
+
+.section .text, "ax"
+
+# This file is handwritten.
+
+# void lz4t_unpack(void *src, void *dest);
+#
+# Unpacks LZ4T data made by tools/lz4tpack, which documents the format.
+# Runs of four or more bytes are copied a word at a time with unaligned loads and stores,
+# except for matches that overlap their own output by less than a word.
+#
+# $a0: input, $a1: output, $t0: end of output, $t1: token, $t2: length, $t4: match source, $t5: match offset
+
+glabel lz4t_unpack
+    lw      $t0, 4($a0)             # Decompressed size
+    addiu   $a0, $a0, 8
+    beqz    $t0, .Ldone
+     addu   $t0, $t0, $a1
+
+.Lsequence:
+    lbu     $t1, 0($a0)
+    addiu   $a0, $a0, 1
+    srl     $t2, $t1, 4             # Literal count
+    beqz    $t2, .Lmatch
+     sltiu  $t3, $t2, 15
+    bnez    $t3, .Lcopy_literals
+     nop
+.Lliteral_length:
+    lbu     $t3, 0($a0)
+    addiu   $a0, $a0, 1
+    addu    $t2, $t2, $t3
+    xori    $t3, $t3, 0xFF
+    beqz    $t3, .Lliteral_length
+     nop
+
+.Lcopy_literals:
+    sltiu   $t3, $t2, 4
+    bnez    $t3, .Lliteral_bytes
+     nop
+.Lliteral_words:
+    lwl     $t3, 0($a0)
+    lwr     $t3, 3($a0)
+    addiu   $t2, $t2, -4
+    addiu   $a0, $a0, 4
+    swl     $t3, 0($a1)
+    swr     $t3, 3($a1)
+    sltiu   $t6, $t2, 4
+    beqz    $t6, .Lliteral_words
+     addiu  $a1, $a1, 4
+    beqz    $t2, .Lliterals_done
+     nop
+.Lliteral_bytes:
+    lbu     $t3, 0($a0)
+    addiu   $t2, $t2, -1
+    addiu   $a0, $a0, 1
+    sb      $t3, 0($a1)
+    bnez    $t2, .Lliteral_bytes
+     addiu  $a1, $a1, 1
+.Lliterals_done:
+    beq     $a1, $t0, .Ldone
+     nop
+
+.Lmatch:
+    lbu     $t5, 0($a0)             # Offset, big endian
+    lbu     $t3, 1($a0)
+    andi    $t2, $t1, 0xF           # Match length - 4
+    sll     $t5, $t5, 8
+    or      $t5, $t5, $t3
+    addiu   $a0, $a0, 2
+    sltiu   $t3, $t2, 15
+    bnez    $t3, .Lcopy_match
+     subu   $t4, $a1, $t5
+.Lmatch_length:
+    lbu     $t3, 0($a0)
+    addiu   $a0, $a0, 1
+    addu    $t2, $t2, $t3
+    xori    $t3, $t3, 0xFF
+    beqz    $t3, .Lmatch_length
+     nop
+
+.Lcopy_match:
+    sltiu   $t3, $t5, 4             # Overlaps by less than a word, so go byte by byte
+    bnez    $t3, .Lmatch_bytes
+     addiu  $t2, $t2, 4
+.Lmatch_words:
+    lwl     $t3, 0($t4)
+    lwr     $t3, 3($t4)
+    addiu   $t2, $t2, -4
+    addiu   $t4, $t4, 4
+    swl     $t3, 0($a1)
+    swr     $t3, 3($a1)
+    sltiu   $t6, $t2, 4
+    beqz    $t6, .Lmatch_words
+     addiu  $a1, $a1, 4
+    beqz    $t2, .Lmatch_done
+     nop
+.Lmatch_bytes:
+    lbu     $t3, 0($t4)
+    addiu   $t2, $t2, -1
+    addiu   $t4, $t4, 1
+    sb      $t3, 0($a1)
+    bnez    $t2, .Lmatch_bytes
+     addiu  $a1, $a1, 1
+.Lmatch_done:
+    bne     $a1, $t0, .Lsequence
+     nop
+
+.Ldone:
+    jr      $ra
+     nop
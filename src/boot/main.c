@@ -112,6 +112,10 @@ void alloc_pool(void) {
     void *start = (void *) SEG_POOL_START;
     void *end = (void *) (SEG_POOL_START + POOL_SIZE);
 
+#ifdef BEHAVIOR_PROFILING
+    // The behavior profiler keeps the map data loaded after the main pool.
+    end = (void *) (RAM_END - MAP_DATA_RESIDENT_SIZE);
+#endif
     main_pool_init(start, end);
     gEffectsMemoryPool = mem_pool_init(EFFECTS_MEMORY_POOL, MEMORY_POOL_LEFT);
 }
@@ -299,6 +303,23 @@ void handle_dp_complete(void) {
     sCurrentDisplaySPTask = NULL;
 }
 
+#ifdef RDP_BREAKDOWN_PROFILER
+/**
+ * Counts the DP interrupts that are waiting to be handled.
+ */
+static s32 count_pending_dp_interrupts(void) {
+    s32 count = 0;
+
+    for (s32 i = 0; i < gIntrMesgQueue.validCount; i++) {
+        if ((uintptr_t) gIntrMesgQueue.msg[(gIntrMesgQueue.first + i) % gIntrMesgQueue.msgCount] == MESG_DP_COMPLETE) {
+            count++;
+        }
+    }
+
+    return count;
+}
+#endif
+
 OSTimerEx RCPHangTimer;
 void start_rcp_hang_timer(void) {
     if (RCPHangTimer.started == FALSE) {
@@ -412,8 +433,21 @@ void thread3_main(UNUSED void *arg) {
                 break;
             case MESG_SP_COMPLETE:
                 handle_sp_complete();
+#ifdef RDP_BREAKDOWN_PROFILER
+                // The RDP may have reached the end of the frame first, with that interrupt taken for one of the breakdown's syncs.
+                if (profiler_rdp_breakdown_sp_complete(sCurrentDisplaySPTask, count_pending_dp_interrupts())) {
+                    stop_rcp_hang_timer();
+                    handle_dp_complete();
+                }
+#endif
                 break;
             case MESG_DP_COMPLETE:
+#ifdef RDP_BREAKDOWN_PROFILER
+                // The full syncs added by the RDP breakdown also interrupt partway through the frame.
+                if (profiler_rdp_breakdown_dp_interrupt(sCurrentDisplaySPTask, count_pending_dp_interrupts())) {
+                    break;
+                }
+#endif
                 stop_rcp_hang_timer();
                 handle_dp_complete();
                 break;
@@ -4,15 +4,16 @@
 
 #include "buffers/buffers.h"
 #include "slidec.h"
+#include "dma_stream.h"
 #include "game/game_init.h"
 #include "game/main.h"
 #include "game/memory.h"
 #include "segment_symbols.h"
 #include "segments.h"
-#ifdef GZIP
+#if defined(GZIP) || defined(COMPRESS_MIXED)
 #include <gzip.h>
 #endif
-#if defined(RNC1) || defined(RNC2)
+#if defined(RNC1) || defined(RNC2) || defined(COMPRESS_MIXED)
 #include <rnc.h>
 #endif
 #ifdef UNF
@@ -20,6 +21,12 @@
 #include "usb/debug.h"
 #endif
 #include "game/puppyprint.h"
+#if defined(COMPRESS_MIXED) || defined(FRAME_ARENA_SIZE)
+#include "game/debug.h"
+#endif
+#if defined(MEMORY_ALLOC_TRACKER) && defined(UNF)
+#include "farcall.h"
+#endif
 
 
 struct MainPoolState {
@@ -34,6 +41,33 @@ struct MainPoolBlock {
     struct MainPoolBlock *next;
 };
 
+#ifdef MEMORY_POOL_TLSF
+// Free blocks are kept in TLSF_SL_COUNT lists for each power of two size, found through two levels of bitmaps.
+#define TLSF_ALIGN_LOG2     3
+#define TLSF_SL_LOG2        3
+#define TLSF_SL_COUNT       (1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT       (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_SMALL_BLOCK    (1 << TLSF_FL_SHIFT) // Sizes below this are split linearly into the first level's lists
+#define TLSF_BLOCK_FREE     0x1
+#define TLSF_HEADER_SIZE    offsetof(struct MemoryBlock, nextFree)
+#define TLSF_MIN_BLOCK      sizeof(struct MemoryBlock)
+
+struct MemoryBlock {
+    u32 size;                     // Including the header, TLSF_BLOCK_FREE in the low bit
+    struct MemoryBlock *prevPhys; // The block before this one in memory, NULL for the first
+    struct MemoryBlock *nextFree; // Only used while the block is free
+    struct MemoryBlock *prevFree;
+};
+
+struct MemoryPool {
+    u32 totalSpace;
+    struct MemoryBlock *firstBlock;
+    u32 flCount;
+    u32 flBitmap;
+    u8 slBitmap[32];
+    struct MemoryBlock *freeLists[][TLSF_SL_COUNT];
+};
+#else
 struct MemoryBlock {
     struct MemoryBlock *next;
     u32 size;
@@ -44,6 +78,7 @@ struct MemoryPool {
     struct MemoryBlock *firstBlock;
     struct MemoryBlock freeList;
 };
+#endif
 
 extern uintptr_t sSegmentTable[32];
 extern u32 sPoolFreeSpace;
@@ -70,6 +105,362 @@ struct MainPoolBlock *sPoolListHeadR;
 
 static struct MainPoolState *gMainPoolState = NULL;
 
+#ifdef MEMORY_ALLOC_TRACKER
+STATIC_ASSERT(MEM_TRACKER_NUM_CALLERS == (1 << MEM_TRACKER_HASH_BITS), "MEM_TRACKER_HASH_BITS does not match MEM_TRACKER_NUM_CALLERS!");
+STATIC_ASSERT(MEM_TRACKER_NUM_CALLERS <= 0x100, "Caller indices must fit in a byte!");
+
+#ifdef UNF
+extern far char *parse_map(u32 pc);
+#endif
+
+struct MemTracker gMemTracker;
+
+// Set by functions that allocate on behalf of their own caller, so the allocation is tagged with whoever asked for it.
+static uintptr_t sMemTrackerCaller = 0;
+// Lowest entry of allocs that may be unused.
+static u32 sMemTrackerFreeHint = 0;
+// The alloc-only pool entry added to last, as graph nodes and the like are allocated in long runs.
+static struct MemTrackerAlloc *sMemTrackerLastAllocOnly = NULL;
+// Set while main_pool_realloc frees and reallocates a block in place, which leaves its contents alone.
+static u8 sMemTrackerReallocating = FALSE;
+
+#define MEM_TRACKER_CALLER() ((sMemTrackerCaller != 0) ? sMemTrackerCaller : (uintptr_t) __builtin_return_address(0))
+#define MEM_TRACKER_ENTER() uintptr_t prevTrackerCaller = mem_tracker_enter((uintptr_t) __builtin_return_address(0))
+#define MEM_TRACKER_EXIT() sMemTrackerCaller = prevTrackerCaller
+
+static uintptr_t mem_tracker_enter(uintptr_t caller) {
+    uintptr_t prev = sMemTrackerCaller;
+
+    if (prev == 0) {
+        sMemTrackerCaller = caller;
+    }
+    return prev;
+}
+
+static s32 mem_tracker_find_caller(uintptr_t caller, u32 allocator) {
+    u32 hash = ((caller >> 2) * 0x9E3779B1) >> (32 - MEM_TRACKER_HASH_BITS);
+
+    for (s32 i = 0; i < MEM_TRACKER_NUM_CALLERS; i++) {
+        struct MemTrackerCaller *entry = &gMemTracker.callers[hash];
+
+        if (entry->caller == caller) {
+            return hash;
+        }
+        if (entry->caller == 0) {
+            entry->caller = caller;
+            entry->allocator = allocator;
+            return hash;
+        }
+        hash = (hash + 1) & (MEM_TRACKER_NUM_CALLERS - 1);
+    }
+
+    return -1;
+}
+
+static struct MemTrackerAlloc *mem_tracker_new_alloc(void) {
+    for (u32 i = sMemTrackerFreeHint; i < MEM_TRACKER_NUM_ALLOCS; i++) {
+        if (gMemTracker.allocs[i].addr == 0) {
+            sMemTrackerFreeHint = i + 1;
+            gMemTracker.allocsEnd = MAX(gMemTracker.allocsEnd, i + 1);
+            return &gMemTracker.allocs[i];
+        }
+    }
+    sMemTrackerFreeHint = MEM_TRACKER_NUM_ALLOCS;
+
+    return NULL;
+}
+
+static struct MemTrackerAlloc *mem_tracker_find_alloc_only(uintptr_t pool, u32 caller) {
+    struct MemTrackerAlloc *entry = sMemTrackerLastAllocOnly;
+
+    if (entry != NULL && entry->addr == pool && entry->caller == caller) {
+        return entry;
+    }
+    for (u32 i = 0; i < gMemTracker.allocsEnd; i++) {
+        entry = &gMemTracker.allocs[i];
+        if (entry->addr == pool && entry->caller == caller && entry->allocator == MEM_TRACKER_ALLOC_ONLY_POOL) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void mem_tracker_add(uintptr_t addr, u32 size, uintptr_t caller, u32 allocator) {
+    s32 callerIndex = mem_tracker_find_caller(caller, allocator);
+    struct MemTrackerAlloc *entry = NULL;
+
+    if (callerIndex >= 0) {
+        if (allocator == MEM_TRACKER_ALLOC_ONLY_POOL) {
+            entry = mem_tracker_find_alloc_only(addr, callerIndex);
+        }
+        if (entry == NULL) {
+            entry = mem_tracker_new_alloc();
+        }
+    }
+    if (entry == NULL) {
+        gMemTracker.untracked++;
+        return;
+    }
+
+    if (entry->count == 0) {
+        entry->addr = addr;
+        entry->frame = gGlobalTimer;
+        entry->caller = callerIndex;
+        entry->allocator = allocator;
+    }
+    entry->size += size;
+    entry->count++;
+    if (allocator == MEM_TRACKER_ALLOC_ONLY_POOL) {
+        sMemTrackerLastAllocOnly = entry;
+    }
+
+    struct MemTrackerCaller *stats = &gMemTracker.callers[callerIndex];
+    stats->liveBytes += size;
+    stats->liveCount++;
+    stats->allocs++;
+    stats->peakBytes = MAX(stats->peakBytes, stats->liveBytes);
+}
+
+static void mem_tracker_release(struct MemTrackerAlloc *entry) {
+    struct MemTrackerCaller *stats = &gMemTracker.callers[entry->caller];
+    u32 index = entry - gMemTracker.allocs;
+
+    stats->liveBytes -= entry->size;
+    stats->liveCount -= entry->count;
+    stats->frees += entry->count;
+    stats->lifetimeFrames += (gGlobalTimer - entry->frame) * entry->count;
+
+    entry->addr = 0;
+    entry->size = 0;
+    entry->count = 0;
+    if (entry == sMemTrackerLastAllocOnly) {
+        sMemTrackerLastAllocOnly = NULL;
+    }
+    sMemTrackerFreeHint = MIN(sMemTrackerFreeHint, index);
+    while (gMemTracker.allocsEnd > 0 && gMemTracker.allocs[gMemTracker.allocsEnd - 1].addr == 0) {
+        gMemTracker.allocsEnd--;
+    }
+}
+
+/**
+ * Releases everything that was in the part of the main pool that is now free, including the contents of any
+ * alloc-only pools and memory pools that were in it.
+ */
+static void mem_tracker_sweep_main_pool(void) {
+    uintptr_t start = (uintptr_t) sPoolListHeadL;
+    uintptr_t end = (uintptr_t) sPoolListHeadR + 16;
+
+    if (sMemTrackerReallocating) {
+        return;
+    }
+
+    for (u32 i = 0; i < gMemTracker.allocsEnd; i++) {
+        struct MemTrackerAlloc *entry = &gMemTracker.allocs[i];
+
+        if (entry->addr >= start && entry->addr < end) {
+            mem_tracker_release(entry);
+        }
+    }
+    for (s32 i = 0; i < MEM_TRACKER_NUM_POOLS; i++) {
+        if ((uintptr_t) gMemTracker.pools[i].pool >= start && (uintptr_t) gMemTracker.pools[i].pool < end) {
+            gMemTracker.pools[i].pool = NULL;
+        }
+    }
+}
+
+static void mem_tracker_main_pool_alloc(void *addr, u32 size, uintptr_t caller, u32 side) {
+    gMemTracker.mainPoolPeakUsed = MAX(gMemTracker.mainPoolPeakUsed, (u32) (sPoolEnd - sPoolStart) - sPoolFreeSpace);
+    if (!sMemTrackerReallocating) {
+        mem_tracker_add((uintptr_t) addr, size, caller,
+                        (side == MEMORY_POOL_LEFT) ? MEM_TRACKER_MAIN_POOL_LEFT : MEM_TRACKER_MAIN_POOL_RIGHT);
+    }
+}
+
+/**
+ * Resizes the entry of a block that main_pool_realloc kept in place, or releases it and its contents if it couldn't.
+ */
+static void mem_tracker_main_pool_realloc(void *addr, void *newAddr) {
+    if (newAddr == NULL) {
+        mem_tracker_sweep_main_pool();
+        return;
+    }
+    for (u32 i = 0; i < gMemTracker.allocsEnd; i++) {
+        struct MemTrackerAlloc *entry = &gMemTracker.allocs[i];
+
+        if (entry->addr == (uintptr_t) addr && entry->allocator == MEM_TRACKER_MAIN_POOL_LEFT) {
+            struct MemTrackerCaller *stats = &gMemTracker.callers[entry->caller];
+            u32 size = (uintptr_t) sPoolListHeadL - (uintptr_t) addr + 16;
+
+            stats->liveBytes += size - entry->size;
+            stats->peakBytes = MAX(stats->peakBytes, stats->liveBytes);
+            entry->size = size;
+            break;
+        }
+    }
+}
+
+static struct MemTrackerPool *mem_tracker_find_pool(struct MemoryPool *pool) {
+    for (s32 i = 0; i < MEM_TRACKER_NUM_POOLS; i++) {
+        if (gMemTracker.pools[i].pool == pool) {
+            return &gMemTracker.pools[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void mem_tracker_add_pool(struct MemoryPool *pool, uintptr_t caller) {
+    struct MemTrackerPool *entry = mem_tracker_find_pool(NULL);
+    s32 callerIndex = mem_tracker_find_caller(caller, MEM_TRACKER_MEMORY_POOL);
+
+    if (entry != NULL && callerIndex >= 0) {
+        entry->pool = pool;
+        entry->used = 0;
+        entry->peakUsed = 0;
+        entry->caller = callerIndex;
+    }
+}
+
+static void mem_tracker_pool_alloc(struct MemoryPool *pool, void *addr, u32 size, uintptr_t caller) {
+    struct MemTrackerPool *entry = mem_tracker_find_pool(pool);
+
+    if (entry != NULL) {
+        entry->used += size;
+        entry->peakUsed = MAX(entry->peakUsed, entry->used);
+    }
+    mem_tracker_add((uintptr_t) addr, size, caller, MEM_TRACKER_MEMORY_POOL);
+}
+
+static void mem_tracker_pool_free(struct MemoryPool *pool, void *addr, u32 size) {
+    struct MemTrackerPool *entry = mem_tracker_find_pool(pool);
+
+    if (entry != NULL) {
+        entry->used -= size;
+    }
+    for (u32 i = 0; i < gMemTracker.allocsEnd; i++) {
+        if (gMemTracker.allocs[i].addr == (uintptr_t) addr && gMemTracker.allocs[i].allocator == MEM_TRACKER_MEMORY_POOL) {
+            mem_tracker_release(&gMemTracker.allocs[i]);
+            break;
+        }
+    }
+}
+
+/**
+ * Fills top with the callers holding the most memory right now, or at their peak, from most to least.
+ */
+s32 mem_tracker_get_top(struct MemTrackerCaller **top, s32 count, s32 sortByPeak) {
+    s32 numFound = 0;
+
+    for (s32 i = 0; i < MEM_TRACKER_NUM_CALLERS; i++) {
+        struct MemTrackerCaller *entry = &gMemTracker.callers[i];
+        if (entry->caller == 0 || entry->peakBytes == 0) {
+            continue;
+        }
+        u32 key = (sortByPeak ? entry->peakBytes : entry->liveBytes);
+
+        // Insertion into the sorted output, dropping whatever falls off the end.
+        s32 j = MIN(numFound, count - 1);
+        if (j == count - 1 && numFound == count) {
+            struct MemTrackerCaller *last = top[j];
+            if ((sortByPeak ? last->peakBytes : last->liveBytes) >= key) {
+                continue;
+            }
+        }
+        while (j > 0 && (sortByPeak ? top[j - 1]->peakBytes : top[j - 1]->liveBytes) < key) {
+            top[j] = top[j - 1];
+            j--;
+        }
+        top[j] = entry;
+        if (numFound < count) {
+            numFound++;
+        }
+    }
+
+    return numFound;
+}
+
+/**
+ * Walks a memory pool's free list. A pool is fragmented when its largest free block is much smaller than its free space.
+ */
+void mem_tracker_get_free_list(struct MemoryPool *pool, struct MemTrackerFreeList *freeList) {
+    bzero(freeList, sizeof(struct MemTrackerFreeList));
+    freeList->totalSpace = pool->totalSpace;
+
+#ifdef MEMORY_POOL_TLSF
+    // Walk the blocks in address order, up to the empty sentinel block at the end.
+    for (struct MemoryBlock *block = pool->firstBlock; block->size != 0;
+         block = (struct MemoryBlock *) ((u8 *) block + (block->size & ~TLSF_BLOCK_FREE))) {
+        u32 size = block->size & ~TLSF_BLOCK_FREE;
+        if (!(block->size & TLSF_BLOCK_FREE)) {
+            continue;
+        }
+#else
+    for (struct MemoryBlock *block = pool->freeList.next; block != NULL; block = block->next) {
+        u32 size = block->size;
+#endif
+        freeList->freeBytes += size;
+        freeList->largestBlock = MAX(freeList->largestBlock, size);
+        freeList->numBlocks++;
+        if (freeList->numSpans < MEM_TRACKER_FREE_SPANS) {
+            freeList->spans[freeList->numSpans].offset = (uintptr_t) block - (uintptr_t) pool->firstBlock;
+            freeList->spans[freeList->numSpans].size = size;
+            freeList->numSpans++;
+        }
+    }
+}
+
+#ifdef UNF
+static const char *sMemTrackerAllocatorNames[MEM_TRACKER_ALLOCATOR_COUNT] = { "main_left", "main_right", "alloc_only", "mem_pool" };
+
+static const char *mem_tracker_caller_name(uintptr_t caller) {
+    char *name = parse_map(caller);
+
+    return (name != NULL) ? name : "?";
+}
+
+/**
+ * Prints the main pool, every memory pool and every caller over USB as comma-separated lines.
+ */
+void mem_tracker_dump(void) {
+    struct MemTrackerFreeList freeList;
+    s32 i;
+
+    osSyncPrintf("mem_main_pool,size,used,peak,untracked_allocs\n");
+    osSyncPrintf("mem_main_pool,%d,%d,%d,%d\n", (u32) (sPoolEnd - sPoolStart), (u32) (sPoolEnd - sPoolStart) - sPoolFreeSpace,
+                 gMemTracker.mainPoolPeakUsed, gMemTracker.untracked);
+
+    osSyncPrintf("mem_pool,address,owner,size,used,peak,free,free_blocks,largest_free\n");
+    for (i = 0; i < MEM_TRACKER_NUM_POOLS; i++) {
+        struct MemTrackerPool *pool = &gMemTracker.pools[i];
+
+        if (pool->pool == NULL) {
+            continue;
+        }
+        mem_tracker_get_free_list(pool->pool, &freeList);
+        osSyncPrintf("mem_pool,%08X,%s,%d,%d,%d,%d,%d,%d\n", (u32) pool->pool,
+                     mem_tracker_caller_name(gMemTracker.callers[pool->caller].caller), freeList.totalSpace, pool->used,
+                     pool->peakUsed, freeList.freeBytes, freeList.numBlocks, freeList.largestBlock);
+    }
+
+    osSyncPrintf("mem_caller,address,function,allocator,live_bytes,live_count,peak_bytes,allocs,frees,avg_lifetime_frames\n");
+    for (i = 0; i < MEM_TRACKER_NUM_CALLERS; i++) {
+        struct MemTrackerCaller *entry = &gMemTracker.callers[i];
+
+        if (entry->caller == 0) {
+            continue;
+        }
+        osSyncPrintf("mem_caller,%08X,%s,%s,%d,%d,%d,%d,%d,%d\n", (u32) entry->caller, mem_tracker_caller_name(entry->caller),
+                     sMemTrackerAllocatorNames[entry->allocator], entry->liveBytes, entry->liveCount, entry->peakBytes,
+                     entry->allocs, entry->frees, entry->lifetimeFrames / MAX(entry->frees, 1U));
+    }
+}
+#endif
+#else
+#define MEM_TRACKER_ENTER()
+#define MEM_TRACKER_EXIT()
+#endif
+
 uintptr_t set_segment_base_addr(s32 segment, void *addr) {
     sSegmentTable[segment] = ((uintptr_t) addr & 0x1FFFFFFF);
     return sSegmentTable[segment];
@@ -163,6 +554,9 @@ void *main_pool_alloc(u32 size, u32 side) {
             sPoolListHeadR = newListHead;
             addr = (u8 *) sPoolListHeadR + 16;
         }
+#ifdef MEMORY_ALLOC_TRACKER
+        mem_tracker_main_pool_alloc(addr, size, MEM_TRACKER_CALLER(), side);
+#endif
     }
     return addr;
 }
@@ -192,6 +586,9 @@ u32 main_pool_free(void *addr) {
         sPoolListHeadR->prev = NULL;
         sPoolFreeSpace += (uintptr_t) sPoolListHeadR - (uintptr_t) oldListHead;
     }
+#ifdef MEMORY_ALLOC_TRACKER
+    mem_tracker_sweep_main_pool();
+#endif
     return sPoolFreeSpace;
 }
 
@@ -206,8 +603,15 @@ void *main_pool_realloc(void *addr, u32 size) {
     struct MainPoolBlock *block = (struct MainPoolBlock *) ((u8 *) addr - 16);
 
     if (block->next == sPoolListHeadL) {
+#ifdef MEMORY_ALLOC_TRACKER
+        sMemTrackerReallocating = TRUE;
+#endif
         main_pool_free(addr);
         newAddr = main_pool_alloc(size, MEMORY_POOL_LEFT);
+#ifdef MEMORY_ALLOC_TRACKER
+        sMemTrackerReallocating = FALSE;
+        mem_tracker_main_pool_realloc(addr, newAddr);
+#endif
     }
     return newAddr;
 }
@@ -247,6 +651,9 @@ u32 main_pool_pop_state(void) {
     sPoolListHeadL = gMainPoolState->listHeadL;
     sPoolListHeadR = gMainPoolState->listHeadR;
     gMainPoolState = gMainPoolState->prev;
+#ifdef MEMORY_ALLOC_TRACKER
+    mem_tracker_sweep_main_pool();
+#endif
     return sPoolFreeSpace;
 }
 
@@ -278,6 +685,7 @@ void dma_read(u8 *dest, u8 *srcStart, u8 *srcEnd) {
 void *dynamic_dma_read(u8 *srcStart, u8 *srcEnd, u32 side, u32 alignment, u32 bssLength) {
     u32 size = ALIGN16(srcEnd - srcStart);
     u32 offset = 0;
+    MEM_TRACKER_ENTER();
 
     if (alignment && side == MEMORY_POOL_LEFT) {
         offset = ALIGN(((uintptr_t)sPoolListHeadL + 16), alignment) - ((uintptr_t)sPoolListHeadL + 16);
@@ -290,6 +698,7 @@ void *dynamic_dma_read(u8 *srcStart, u8 *srcEnd, u32 side, u32 alignment, u32 bs
             bzero(((u8 *)dest + offset + size), bssLength);
         }
     }
+    MEM_TRACKER_EXIT();
     return dest;
 }
 
@@ -322,6 +731,7 @@ void mapTLBPages(uintptr_t virtualAddress, uintptr_t physicalAddress, s32 length
  */
 void *load_segment(s32 segment, u8 *srcStart, u8 *srcEnd, u32 side, u8 *bssStart, u8 *bssEnd) {
     void *addr;
+    MEM_TRACKER_ENTER();
 
     if ((bssStart != NULL) && (side == MEMORY_POOL_LEFT)) {
         addr = dynamic_dma_read(srcStart, srcEnd, side, TLB_PAGE_SIZE, ((uintptr_t)bssEnd - (uintptr_t)bssStart));
@@ -340,6 +750,7 @@ void *load_segment(s32 segment, u8 *srcStart, u8 *srcEnd, u32 side, u8 *bssStart
     u32 ppSize = ALIGN16(srcEnd - srcStart) + 16;
     set_segment_memory_printout(segment, ppSize);
 #endif
+    MEM_TRACKER_EXIT();
     return addr;
 }
 
@@ -353,6 +764,7 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
     void *dest = NULL;
     u32 srcSize = ALIGN16(srcEnd - srcStart);
     u32 destSize = ALIGN16((u8 *) sPoolListHeadR - destAddr);
+    MEM_TRACKER_ENTER();
 
     if (srcSize <= destSize) {
         dest = main_pool_alloc(destSize, MEMORY_POOL_RIGHT);
@@ -364,8 +776,168 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
             osInvalDCache(dest, destSize);
         }
     }
+    MEM_TRACKER_EXIT();
+    return dest;
+}
+
+#ifdef COMPRESS_MIXED
+/**
+ * Codecs a segment can be compressed with. Must match tools/segment_header.py.
+ */
+enum SegmentCodec {
+    SEGMENT_CODEC_NONE,
+    SEGMENT_CODEC_YAY0,
+    SEGMENT_CODEC_MIO0,
+    SEGMENT_CODEC_RNC1,
+    SEGMENT_CODEC_RNC2,
+    SEGMENT_CODEC_GZIP,
+    SEGMENT_CODEC_LZ4T,
+};
+
+/**
+ * Header at the start of every compressed segment, naming the codec it was built with.
+ */
+struct SegmentHeader {
+    char magic[3]; // "SEG"
+    u8 codec;      // enum SegmentCodec
+    u32 size;      // Decompressed size
+    u8 pad[8];     // Keeps the data after the header aligned
+};
+
+/**
+ * Decompress the block of ROM data from srcStart to srcEnd and return a
+ * pointer to an allocated buffer holding the decompressed data. Set the
+ * base address of segment to this address.
+ * The codec is chosen per segment by its header. Uncompressed segments are
+ * read straight into place without a temporary buffer.
+ */
+void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
+    ALIGNED16 struct SegmentHeader header;
+    void *dest = NULL;
+    MEM_TRACKER_ENTER();
+
+    dma_read((u8 *) &header, srcStart, srcStart + sizeof(header));
+    srcStart += sizeof(header);
+    assert(header.magic[0] == 'S' && header.magic[1] == 'E' && header.magic[2] == 'G', "Segment has no codec header");
+
+    if (header.codec == SEGMENT_CODEC_NONE) {
+        dest = main_pool_alloc(header.size, MEMORY_POOL_LEFT);
+        if (dest != NULL) {
+            dma_read(dest, srcStart, srcEnd);
+            set_segment_base_addr(segment, dest);
+        }
+#ifdef STREAMED_DECOMPRESSION
+    } else if ((header.codec == SEGMENT_CODEC_YAY0 && (u32) (srcEnd - srcStart) > YAY0_STREAM_SCRATCH_SIZE)
+               || (header.codec == SEGMENT_CODEC_GZIP && (u32) (srcEnd - srcStart) > GZIP_STREAM_SCRATCH_SIZE)) {
+        // Only segments bigger than the streaming scratch are streamed, since the rest take less memory read in whole.
+        dest = main_pool_alloc(header.size, MEMORY_POOL_LEFT);
+        if (dest != NULL) {
+            s32 unpacked;
+
+            osSyncPrintf("start decompress\n");
+            if (header.codec == SEGMENT_CODEC_YAY0) {
+                unpacked = yay0_stream_unpack(srcStart, srcEnd, dest);
+            } else {
+                unpacked = gzip_stream_unpack(srcStart, srcEnd, dest, header.size);
+            }
+            osSyncPrintf("end decompress\n");
+            if (unpacked) {
+                set_segment_base_addr(segment, dest);
+            } else {
+                // No room for the scratch, and reading the segment in whole would need more.
+                main_pool_free(dest);
+                dest = NULL;
+            }
+        }
+#endif
+    } else {
+        u32 compSize = ALIGN16(srcEnd - srcStart);
+        u8 *compressed = main_pool_alloc(compSize, MEMORY_POOL_RIGHT);
+
+        if (compressed != NULL) {
+            dma_read(compressed, srcStart, srcEnd);
+            dest = main_pool_alloc(header.size, MEMORY_POOL_LEFT);
+            if (dest != NULL) {
+                osSyncPrintf("start decompress\n");
+                switch (header.codec) {
+                    case SEGMENT_CODEC_YAY0:
+                        slidstart(compressed, dest);
+                        break;
+                    case SEGMENT_CODEC_MIO0:
+                        decompress(compressed, dest);
+                        break;
+                    case SEGMENT_CODEC_RNC1:
+                        Propack_UnpackM1(compressed, dest);
+                        break;
+                    case SEGMENT_CODEC_RNC2:
+                        Propack_UnpackM2(compressed, dest);
+                        break;
+                    case SEGMENT_CODEC_GZIP:
+                        expand_gzip(compressed, dest, compSize, header.size);
+                        break;
+                    case SEGMENT_CODEC_LZ4T:
+                        lz4t_unpack(compressed, dest);
+                        break;
+                    default:
+                        error("Unknown segment codec");
+                        break;
+                }
+                osSyncPrintf("end decompress\n");
+                set_segment_base_addr(segment, dest);
+            }
+            main_pool_free(compressed);
+        }
+    }
+#ifdef PUPPYPRINT_DEBUG
+    set_segment_memory_printout(segment, ALIGN16(header.size) + 16);
+#endif
+    MEM_TRACKER_EXIT();
     return dest;
 }
+#else
+#ifdef STREAMED_DECOMPRESSION
+/**
+ * Decompress the block of ROM data from srcStart to srcEnd as it arrives from ROM,
+ * so only a few small chunks of it are ever in memory.
+ */
+static void *load_segment_decompress_streamed(s32 segment, u8 *srcStart, u8 *srcEnd) {
+    ALIGNED16 u32 header[4];
+    void *dest = NULL;
+    MEM_TRACKER_ENTER();
+
+#ifdef GZIP
+    // Decompressed size from end of gzip
+    dma_read((u8 *) header, srcEnd - sizeof(header), srcEnd);
+    u32 size = header[3];
+#else
+    // Decompressed size from header
+    dma_read((u8 *) header, srcStart, srcStart + sizeof(header));
+    u32 size = header[1];
+#endif
+    dest = main_pool_alloc(size, MEMORY_POOL_LEFT);
+    if (dest != NULL) {
+        osSyncPrintf("start decompress\n");
+#ifdef GZIP
+        s32 unpacked = gzip_stream_unpack(srcStart, srcEnd, dest, size);
+#else
+        s32 unpacked = yay0_stream_unpack(srcStart, srcEnd, dest);
+#endif
+        osSyncPrintf("end decompress\n");
+        if (unpacked) {
+            set_segment_base_addr(segment, dest);
+        } else {
+            // No room for the scratch, and reading the segment in whole would need more.
+            main_pool_free(dest);
+            dest = NULL;
+        }
+    }
+#ifdef PUPPYPRINT_DEBUG
+    set_segment_memory_printout(segment, ALIGN16(size) + 16);
+#endif
+    MEM_TRACKER_EXIT();
+    return dest;
+}
+#endif
 
 /**
  * Decompress the block of ROM data from srcStart to srcEnd and return a
@@ -375,6 +947,19 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
 void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
     void *dest = NULL;
 
+#ifdef STREAMED_DECOMPRESSION
+#ifdef GZIP
+    u32 streamScratch = GZIP_STREAM_SCRATCH_SIZE;
+#else
+    u32 streamScratch = YAY0_STREAM_SCRATCH_SIZE;
+#endif
+    // Only segments bigger than the streaming scratch are streamed, since the rest take less memory read in whole.
+    if ((u32) (srcEnd - srcStart) > streamScratch) {
+        return load_segment_decompress_streamed(segment, srcStart, srcEnd);
+    }
+#endif
+    MEM_TRACKER_ENTER();
+
 #ifdef GZIP
     u32 compSize = (srcEnd - 4 - srcStart);
 #else
@@ -408,6 +993,8 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
             slidstart(compressed, dest);
 #elif MIO0
             decompress(compressed, dest);
+#elif LZ4T
+            lz4t_unpack(compressed, dest);
 #endif
             osSyncPrintf("end decompress\n");
             set_segment_base_addr(segment, dest);
@@ -418,8 +1005,10 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
     u32 ppSize = ALIGN16((u32)*size) + 16;
     set_segment_memory_printout(segment, ppSize);
 #endif
+    MEM_TRACKER_EXIT();
     return dest;
 }
+#endif
 
 void load_engine_code_segment(void) {
     void *startAddr = (void *) _engineSegmentStart;
@@ -442,6 +1031,7 @@ void load_engine_code_segment(void) {
 struct AllocOnlyPool *alloc_only_pool_init(u32 size, u32 side) {
     void *addr;
     struct AllocOnlyPool *subPool = NULL;
+    MEM_TRACKER_ENTER();
 
     size = ALIGN4(size);
     addr = main_pool_alloc(size + sizeof(struct AllocOnlyPool), side);
@@ -452,6 +1042,7 @@ struct AllocOnlyPool *alloc_only_pool_init(u32 size, u32 side) {
         subPool->startPtr = (u8 *) addr + sizeof(struct AllocOnlyPool);
         subPool->freePtr = (u8 *) addr + sizeof(struct AllocOnlyPool);
     }
+    MEM_TRACKER_EXIT();
     return subPool;
 }
 
@@ -467,6 +1058,9 @@ void *alloc_only_pool_alloc(struct AllocOnlyPool *pool, s32 size) {
         addr = pool->freePtr;
         pool->freePtr += size;
         pool->usedSpace += size;
+#ifdef MEMORY_ALLOC_TRACKER
+        mem_tracker_add((uintptr_t) pool, size, MEM_TRACKER_CALLER(), MEM_TRACKER_ALLOC_ONLY_POOL);
+#endif
     }
     return addr;
 }
@@ -488,6 +1082,222 @@ struct AllocOnlyPool *alloc_only_pool_resize(struct AllocOnlyPool *pool, u32 siz
     return newPool;
 }
 
+#ifdef MEMORY_POOL_TLSF
+/**
+ * Index of the highest set bit. The VR4300 has no count leading zeros instruction.
+ */
+static s32 tlsf_fls(u32 x) {
+    s32 bit = 0;
+
+    if (x & 0xFFFF0000) { x >>= 16; bit += 16; }
+    if (x & 0xFF00)     { x >>= 8;  bit += 8;  }
+    if (x & 0xF0)       { x >>= 4;  bit += 4;  }
+    if (x & 0xC)        { x >>= 2;  bit += 2;  }
+    if (x & 0x2)        {           bit += 1;  }
+    return bit;
+}
+
+/**
+ * Index of the lowest set bit.
+ */
+static s32 tlsf_ffs(u32 x) {
+    return tlsf_fls(x & -x);
+}
+
+/**
+ * Find the free list that blocks of the given size are kept in.
+ */
+static void tlsf_mapping(u32 size, s32 *fl, s32 *sl) {
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = size >> TLSF_ALIGN_LOG2;
+    } else {
+        s32 bit = tlsf_fls(size);
+        *sl = (size >> (bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = bit - (TLSF_FL_SHIFT - 1);
+    }
+}
+
+static void tlsf_insert_block(struct MemoryPool *pool, struct MemoryBlock *block) {
+    s32 fl, sl;
+    struct MemoryBlock **list;
+
+    tlsf_mapping(block->size & ~TLSF_BLOCK_FREE, &fl, &sl);
+    list = &pool->freeLists[fl][sl];
+    block->prevFree = NULL;
+    block->nextFree = *list;
+    if (*list != NULL) {
+        (*list)->prevFree = block;
+    }
+    *list = block;
+    pool->flBitmap |= (1 << fl);
+    pool->slBitmap[fl] |= (1 << sl);
+}
+
+static void tlsf_remove_block(struct MemoryPool *pool, struct MemoryBlock *block) {
+    s32 fl, sl;
+
+    tlsf_mapping(block->size & ~TLSF_BLOCK_FREE, &fl, &sl);
+    if (block->nextFree != NULL) {
+        block->nextFree->prevFree = block->prevFree;
+    }
+    if (block->prevFree != NULL) {
+        block->prevFree->nextFree = block->nextFree;
+    } else {
+        pool->freeLists[fl][sl] = block->nextFree;
+        if (block->nextFree == NULL) {
+            pool->slBitmap[fl] &= ~(1 << sl);
+            if (pool->slBitmap[fl] == 0) {
+                pool->flBitmap &= ~(1 << fl);
+            }
+        }
+    }
+}
+
+static struct MemoryBlock *tlsf_next_phys(struct MemoryBlock *block) {
+    return (struct MemoryBlock *) ((u8 *) block + (block->size & ~TLSF_BLOCK_FREE));
+}
+
+/**
+ * Allocate a memory pool from the main pool. This pool supports arbitrary
+ * order for allocation/freeing.
+ * Return NULL if there is not enough space in the main pool.
+ */
+struct MemoryPool *mem_pool_init(u32 size, u32 side) {
+    void *addr;
+    struct MemoryBlock *block;
+    struct MemoryPool *pool = NULL;
+    s32 fl, sl;
+    u32 headerSize;
+    MEM_TRACKER_ENTER();
+
+    // Only as many first level lists as the largest block needs.
+    size = ALIGN(size, 1 << TLSF_ALIGN_LOG2) + TLSF_HEADER_SIZE;
+    tlsf_mapping(size, &fl, &sl);
+    headerSize = ALIGN(sizeof(struct MemoryPool) + (fl + 1) * sizeof(pool->freeLists[0]), 1 << TLSF_ALIGN_LOG2);
+    addr = main_pool_alloc(headerSize + size, side);
+    if (addr != NULL) {
+        pool = (struct MemoryPool *) addr;
+        bzero(pool, headerSize);
+
+        pool->totalSpace = size;
+        pool->flCount = fl + 1;
+        pool->firstBlock = (struct MemoryBlock *) ((u8 *) addr + headerSize);
+
+        // One free block covering the pool, then an empty used block that stops it from merging off the end.
+        block = pool->firstBlock;
+        block->size = (size - TLSF_HEADER_SIZE) | TLSF_BLOCK_FREE;
+        block->prevPhys = NULL;
+        tlsf_next_phys(block)->size = 0;
+        tlsf_next_phys(block)->prevPhys = block;
+        tlsf_insert_block(pool, block);
+#ifdef MEMORY_ALLOC_TRACKER
+        mem_tracker_add_pool(pool, MEM_TRACKER_CALLER());
+#endif
+    }
+#ifdef PUPPYPRINT_DEBUG
+    gPoolMem += ALIGN16(headerSize + size) + 16;
+#endif
+    MEM_TRACKER_EXIT();
+    return pool;
+}
+
+/**
+ * Find a free block of at least size bytes.
+ * The size is rounded up to the next list boundary, so any block in the first non-empty list at or above
+ * it is big enough. Only if there isn't one is the list the size itself belongs in searched for a fit.
+ */
+static struct MemoryBlock *tlsf_find_block(struct MemoryPool *pool, u32 size) {
+    struct MemoryBlock *block;
+    s32 fl, sl;
+    u32 searchSize = size;
+    u32 slMap = 0;
+
+    if (size >= TLSF_SMALL_BLOCK) {
+        searchSize += (1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+    }
+    tlsf_mapping(searchSize, &fl, &sl);
+    if ((u32) fl < pool->flCount) {
+        slMap = pool->slBitmap[fl] & (~0U << sl);
+        if (slMap == 0) {
+            u32 flMap = pool->flBitmap & (~0U << (fl + 1));
+            if (flMap != 0) {
+                fl = tlsf_ffs(flMap);
+                slMap = pool->slBitmap[fl];
+            }
+        }
+    }
+    if (slMap != 0) {
+        return pool->freeLists[fl][tlsf_ffs(slMap)];
+    }
+
+    tlsf_mapping(size, &fl, &sl);
+    if ((u32) fl < pool->flCount) {
+        for (block = pool->freeLists[fl][sl]; block != NULL; block = block->nextFree) {
+            if ((block->size & ~TLSF_BLOCK_FREE) >= size) {
+                return block;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Allocate from a memory pool. Return NULL if there is not enough space.
+ */
+void *mem_pool_alloc(struct MemoryPool *pool, u32 size) {
+    struct MemoryBlock *block;
+
+    size = ALIGN(size, 1 << TLSF_ALIGN_LOG2) + TLSF_HEADER_SIZE;
+    size = MAX(size, TLSF_MIN_BLOCK);
+    block = tlsf_find_block(pool, size);
+    if (block == NULL) {
+        return NULL;
+    }
+    tlsf_remove_block(pool, block);
+
+    // Split off what isn't needed, if it's big enough to be a block.
+    block->size &= ~TLSF_BLOCK_FREE;
+    if (block->size - size >= TLSF_MIN_BLOCK) {
+        struct MemoryBlock *rest = (struct MemoryBlock *) ((u8 *) block + size);
+        rest->size = (block->size - size) | TLSF_BLOCK_FREE;
+        rest->prevPhys = block;
+        tlsf_next_phys(rest)->prevPhys = rest;
+        block->size = size;
+        tlsf_insert_block(pool, rest);
+    }
+
+#ifdef MEMORY_ALLOC_TRACKER
+    mem_tracker_pool_alloc(pool, (u8 *) block + TLSF_HEADER_SIZE, block->size, MEM_TRACKER_CALLER());
+#endif
+    return (u8 *) block + TLSF_HEADER_SIZE;
+}
+
+/**
+ * Free a block that was allocated using mem_pool_alloc, merging it with the free blocks either side of it.
+ */
+void mem_pool_free(struct MemoryPool *pool, void *addr) {
+    struct MemoryBlock *block = (struct MemoryBlock *) ((u8 *) addr - TLSF_HEADER_SIZE);
+    struct MemoryBlock *next = tlsf_next_phys(block);
+
+#ifdef MEMORY_ALLOC_TRACKER
+    mem_tracker_pool_free(pool, addr, block->size);
+#endif
+    if (next->size & TLSF_BLOCK_FREE) {
+        tlsf_remove_block(pool, next);
+        block->size += next->size & ~TLSF_BLOCK_FREE;
+    }
+    if (block->prevPhys != NULL && (block->prevPhys->size & TLSF_BLOCK_FREE)) {
+        struct MemoryBlock *prev = block->prevPhys;
+        tlsf_remove_block(pool, prev);
+        prev->size += block->size;
+        block = prev;
+    }
+    block->size |= TLSF_BLOCK_FREE;
+    tlsf_next_phys(block)->prevPhys = block;
+    tlsf_insert_block(pool, block);
+}
+#else
 /**
  * Allocate a memory pool from the main pool. This pool supports arbitrary
  * order for allocation/freeing.
@@ -497,6 +1307,7 @@ struct MemoryPool *mem_pool_init(u32 size, u32 side) {
     void *addr;
     struct MemoryBlock *block;
     struct MemoryPool *pool = NULL;
+    MEM_TRACKER_ENTER();
 
     size = ALIGN4(size);
     addr = main_pool_alloc(size + sizeof(struct MemoryPool), side);
@@ -510,10 +1321,14 @@ struct MemoryPool *mem_pool_init(u32 size, u32 side) {
         block = pool->firstBlock;
         block->next = NULL;
         block->size = pool->totalSpace;
+#ifdef MEMORY_ALLOC_TRACKER
+        mem_tracker_add_pool(pool, MEM_TRACKER_CALLER());
+#endif
     }
 #ifdef PUPPYPRINT_DEBUG
     gPoolMem += ALIGN16(size) + 16;
 #endif
+    MEM_TRACKER_EXIT();
     return pool;
 }
 
@@ -537,6 +1352,9 @@ void *mem_pool_alloc(struct MemoryPool *pool, u32 size) {
                 freeBlock->next->size = size;
                 freeBlock->next = newBlock;
             }
+#ifdef MEMORY_ALLOC_TRACKER
+            mem_tracker_pool_alloc(pool, addr, ((struct MemoryBlock *) addr - 1)->size, MEM_TRACKER_CALLER());
+#endif
             break;
         }
         freeBlock = freeBlock->next;
@@ -551,6 +1369,9 @@ void mem_pool_free(struct MemoryPool *pool, void *addr) {
     struct MemoryBlock *block = (struct MemoryBlock *) ((u8 *) addr - sizeof(struct MemoryBlock));
     struct MemoryBlock *freeList = pool->freeList.next;
 
+#ifdef MEMORY_ALLOC_TRACKER
+    mem_tracker_pool_free(pool, addr, block->size);
+#endif
     if (pool->freeList.next == NULL) {
         pool->freeList.next = block;
         block->next = NULL;
@@ -585,6 +1406,7 @@ void mem_pool_free(struct MemoryPool *pool, void *addr) {
         }
     }
 }
+#endif
 
 void *alloc_display_list(u32 size) {
     void *ptr = NULL;
@@ -597,6 +1419,38 @@ void *alloc_display_list(u32 size) {
     return ptr;
 }
 
+#ifdef FRAME_ARENA_SIZE
+struct FrameArena gFrameArena;
+
+/**
+ * Start allocating from the frame arena that goes with the graphics pool of the same index,
+ * dropping everything allocated from it two frames ago.
+ */
+void frame_arena_select(s32 index) {
+    gFrameArena.peakUsed = MAX(gFrameArena.peakUsed, (u32) (gFrameArena.pos - gFrameArena.start));
+    gFrameArena.start = gFrameArenas[index];
+    gFrameArena.pos = gFrameArenas[index];
+    gFrameArena.end = gFrameArenas[index] + FRAME_ARENA_SIZE;
+}
+
+/**
+ * Allocate data that only needs to last until the RSP has drawn this frame.
+ * Falls back to the graphics pool if the arena is full.
+ */
+void *frame_alloc(u32 size) {
+    void *ptr;
+
+    size = ALIGN8(size);
+    if (gFrameArena.pos + size > gFrameArena.end) {
+        assert(FALSE, "Frame arena overflow!\nIncrease FRAME_ARENA_SIZE.");
+        return alloc_display_list(size);
+    }
+    ptr = gFrameArena.pos;
+    gFrameArena.pos += size;
+    return ptr;
+}
+#endif
+
 static struct DmaTable *load_dma_table_address(u8 *srcAddr) {
     struct DmaTable *table = dynamic_dma_read(srcAddr, srcAddr + sizeof(u32),
                                                              MEMORY_POOL_LEFT, 0, 0);
@@ -610,11 +1464,14 @@ static struct DmaTable *load_dma_table_address(u8 *srcAddr) {
 }
 
 void setup_dma_table_list(struct DmaHandlerList *list, void *srcAddr, void *buffer) {
+    MEM_TRACKER_ENTER();
+
     if (srcAddr != NULL) {
         list->dmaTable = load_dma_table_address(srcAddr);
     }
     list->currentAddr = NULL;
     list->bufTarget = buffer;
+    MEM_TRACKER_EXIT();
 }
 
 s32 load_patchable_table(struct DmaHandlerList *list, s32 index) {
@@ -5,4 +5,6 @@ void slidstart(unsigned char *compress, unsigned char *decompress);
 
 void decompress(void *mio0, void *dest);
 
+void lz4t_unpack(void *src, void *dest);
+
 #endif // SLIDEC_H
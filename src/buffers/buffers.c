@@ -25,3 +25,9 @@ __attribute__((aligned(32))) u8 gGfxSPTaskYieldBuffer[OS_YIELD_DATA_SIZE];
 ALIGNED8 struct SaveBuffer gSaveBuffer;
 // 0x190a0 bytes
 struct GfxPool gGfxPools[2];
+#ifdef DYNAMIC_GFX_POOL
+Gfx gGfxPoolFallback[2][GFX_POOL_FALLBACK_SIZE];
+#endif
+#ifdef FRAME_ARENA_SIZE
+ALIGNED16 u8 gFrameArenas[2][FRAME_ARENA_SIZE];
+#endif
@@ -27,6 +27,12 @@ extern struct SaveBuffer gSaveBuffer;
 extern u8 gGfxSPTaskStack[];
 
 extern struct GfxPool gGfxPools[2];
+#ifdef DYNAMIC_GFX_POOL
+extern Gfx gGfxPoolFallback[2][GFX_POOL_FALLBACK_SIZE];
+#endif
+#ifdef FRAME_ARENA_SIZE
+extern u8 gFrameArenas[2][FRAME_ARENA_SIZE];
+#endif
 
 extern u8 adpcmbuf[];		/* Buffer for audio records ADPCM) */
 
@@ -138,6 +138,9 @@ struct DisplayListNode {
     Mtx *transform;
     void *displayList;
     struct DisplayListNode *next;
+#ifdef RDP_BREAKDOWN_PROFILER
+    const BehaviorScript *behavior; // Behavior of the object that appended it, or NULL
+#endif
 };
 
 /** GraphNode that manages the 8 top-level display lists that will be drawn
@@ -117,6 +117,9 @@ static void level_cmd_exit_and_execute(void) {
     void *targetAddr = CMD_GET(void *, 12);
 
     main_pool_pop_state();
+#ifdef DYNAMIC_GFX_POOL
+    gfx_pool_unload_level();
+#endif
     main_pool_push_state();
 
     load_segment(CMD_GET(s16, 2), CMD_GET(void *, 4), CMD_GET(void *, 8),
@@ -128,6 +131,9 @@ static void level_cmd_exit_and_execute(void) {
 
 static void level_cmd_exit(void) {
     main_pool_pop_state();
+#ifdef DYNAMIC_GFX_POOL
+    gfx_pool_unload_level();
+#endif
 
     sStackTop = sStackBase;
     sStackBase = (uintptr_t *) *(--sStackTop);
@@ -275,6 +281,9 @@ static void level_cmd_push_pool_state(void) {
 
 static void level_cmd_pop_pool_state(void) {
     main_pool_pop_state();
+#ifdef DYNAMIC_GFX_POOL
+    gfx_pool_unload_level();
+#endif
     sCurrentCmd = CMD_NEXT;
 }
 
@@ -367,6 +376,9 @@ static void level_cmd_clear_level(void) {
     main_pool_pop_state();
     // the game does a push on level load and a pop on level unload, we need to add another push to store state after the level has been loaded, so one more pop is needed
     main_pool_pop_state();
+#ifdef DYNAMIC_GFX_POOL
+    gfx_pool_unload_level();
+#endif
     unmap_tlbs();
 
     sCurrentCmd = CMD_NEXT;
@@ -393,6 +405,16 @@ static void level_cmd_free_level_pool(void) {
             break;
         }
     }
+#ifdef DYNAMIC_GFX_POOL
+    // Allocated before the push, so it stays through area changes and is freed with the rest of the level.
+    // The global script has no areas, so it doesn't get one.
+    for (i = 0; i < AREA_COUNT; i++) {
+        if (gAreaData[i].graphNode != NULL) {
+            gfx_pool_load_level(gCurrLevelNum);
+            break;
+        }
+    }
+#endif
     main_pool_push_state();
 
     sCurrentCmd = CMD_NEXT;
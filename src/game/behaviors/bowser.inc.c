@@ -1874,6 +1874,9 @@ Gfx *geo_bits_bowser_coloring(s32 callContext, struct GraphNode *node, UNUSED s3
             SET_GRAPH_NODE_LAYER(graphNode->fnNode.node.flags, LAYER_TRANSPARENT);
         }
         Gfx *gfx = gfxHead = alloc_display_list(2 * sizeof(Gfx));
+        if (gfxHead == NULL) {
+            return NULL;
+        }
         // If TRUE, clear lighting to give rainbow color
         if (obj->oBowserRainbowLight) {
             gSPClearGeometryMode(gfx++, G_LIGHTING);
@@ -0,0 +1,209 @@
+#include <ultra64.h>
+
+/**
+ * @file benchmark.c
+ * Records player 1's input from boot (BENCHMARK_RECORD_INPUTS), or replays a recorded route from boot while
+ * sampling the profiler every frame (BENCHMARK_REPLAY).
+ *
+ * The game's logic only depends on its input and its state, so a route replayed from boot with empty save files
+ * plays out the same way every time, no matter how long each frame takes to run. This makes the per-frame times
+ * of two builds comparable. tools/benchmark.py turns recordings into routes, and prints and compares results.
+ */
+
+#include "sm64.h"
+#include "benchmark.h"
+#include "game_init.h"
+#include "object_list_processor.h"
+#include "profiling.h"
+#include "engine/math_util.h"
+#ifdef SRAM
+#include "sram.h"
+#endif
+#ifdef UNF
+#include "usb/debug.h"
+#endif
+
+#if defined(BENCHMARK_RECORD_INPUTS) || defined(BENCHMARK_REPLAY)
+
+/**
+ * FNV-1a over the big endian bytes of each input, so that tools/benchmark.py can compute the same value.
+ */
+static u32 benchmark_checksum(const struct BenchmarkInput *inputs, s32 count) {
+    u32 hash = 0x811C9DC5;
+
+    for (s32 i = 0; i < count; i++) {
+        u8 bytes[6] = {
+            inputs[i].frames >> 8, inputs[i].frames & 0xFF,
+            inputs[i].button >> 8, inputs[i].button & 0xFF,
+            inputs[i].rawStickX, inputs[i].rawStickY,
+        };
+
+        for (s32 j = 0; j < 6; j++) {
+            hash = (hash ^ bytes[j]) * 0x01000193;
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * Writes a recording or a set of results to the start of SRAM, and sends it over USB.
+ */
+static void benchmark_write_output(void *data, u32 size) {
+#ifdef SRAM
+    if (gSramProbe != 0) {
+        nuPiWriteSram(0, data, ALIGN4(size));
+    }
+#endif
+#ifdef UNF
+    debug_dumpbinary(data, size);
+#endif
+}
+
+#endif
+
+#ifdef BENCHMARK_RECORD_INPUTS
+
+static ALIGNED16 struct {
+    struct BenchmarkHeader header;
+    struct BenchmarkInput inputs[BENCHMARK_MAX_INPUTS];
+} sBenchmarkRecording;
+STATIC_ASSERT(sizeof(sBenchmarkRecording) <= 0x8000, "Input recordings must fit in SRAM!");
+
+static u8 sBenchmarkRecordingDone = FALSE;
+
+static void benchmark_finish_recording(void) {
+    struct BenchmarkHeader *header = &sBenchmarkRecording.header;
+
+    header->magic = BENCHMARK_ROUTE_MAGIC;
+    header->version = BENCHMARK_VERSION;
+    header->routeChecksum = benchmark_checksum(sBenchmarkRecording.inputs, header->count);
+    benchmark_write_output(&sBenchmarkRecording, sizeof(struct BenchmarkHeader) + header->count * sizeof(struct BenchmarkInput));
+
+    sBenchmarkRecordingDone = TRUE;
+}
+
+/**
+ * Adds the controller's state this frame to the recording. Stops recording on L + D-Pad Left, or when it is full.
+ */
+void benchmark_update_controller(struct Controller *controller) {
+    struct BenchmarkHeader *header = &sBenchmarkRecording.header;
+    struct BenchmarkInput *input = &sBenchmarkRecording.inputs[MAX(header->count, 1) - 1];
+
+    if (sBenchmarkRecordingDone) {
+        return;
+    }
+
+    if ((controller->buttonDown & L_TRIG) && (controller->buttonPressed & L_JPAD)) {
+        benchmark_finish_recording();
+        return;
+    }
+
+    if (header->count > 0 && input->frames < 0xFFFF && input->button == controller->buttonDown
+        && input->rawStickX == controller->rawStickX && input->rawStickY == controller->rawStickY) {
+        input->frames++;
+    } else if (header->count < BENCHMARK_MAX_INPUTS) {
+        input = &sBenchmarkRecording.inputs[header->count++];
+        input->frames = 1;
+        input->button = controller->buttonDown;
+        input->rawStickX = controller->rawStickX;
+        input->rawStickY = controller->rawStickY;
+    } else {
+        benchmark_finish_recording();
+        return;
+    }
+
+    header->routeFrames++;
+}
+
+#endif
+
+#ifdef BENCHMARK_REPLAY
+
+#include "benchmark/route.inc.c"
+
+static ALIGNED16 struct {
+    struct BenchmarkHeader header;
+    struct BenchmarkFrame frames[BENCHMARK_MAX_FRAMES];
+} sBenchmarkResults;
+STATIC_ASSERT(sizeof(sBenchmarkResults) <= 0x8000, "Benchmark results must fit in SRAM!");
+
+static const struct BenchmarkInput *sBenchmarkInput = sBenchmarkRoute;
+static u16 sBenchmarkInputFrame = 0;
+static u8 sBenchmarkReplaying = TRUE;
+// The replayed buttons of the last frame, since the controller's buttonDown already holds the real pad's.
+static u16 sBenchmarkPrevButton = 0;
+
+static void benchmark_finish_replay(void) {
+    struct BenchmarkHeader *header = &sBenchmarkResults.header;
+
+    header->magic = BENCHMARK_RESULTS_MAGIC;
+    header->version = BENCHMARK_VERSION;
+    header->routeChecksum = benchmark_checksum(sBenchmarkRoute, sBenchmarkInput - sBenchmarkRoute);
+    benchmark_write_output(&sBenchmarkResults, sizeof(struct BenchmarkHeader) + header->count * sizeof(struct BenchmarkFrame));
+
+    // Hand control back to the player.
+    sBenchmarkReplaying = FALSE;
+}
+
+/**
+ * Replaces the controller's state with the next input of the route.
+ */
+void benchmark_update_controller(struct Controller *controller) {
+    const struct BenchmarkInput *input = sBenchmarkInput;
+
+    if (!sBenchmarkReplaying) {
+        return;
+    }
+
+    if (input->frames == 0) {
+        benchmark_finish_replay();
+        return;
+    }
+
+    controller->rawStickX = input->rawStickX;
+    controller->rawStickY = input->rawStickY;
+    controller->buttonPressed  = (~sBenchmarkPrevButton & input->button);
+    controller->buttonReleased = (~input->button & sBenchmarkPrevButton);
+    controller->buttonDown = input->button;
+    sBenchmarkPrevButton = input->button;
+    adjust_analog_stick(controller);
+
+    if (++sBenchmarkInputFrame >= input->frames) {
+        sBenchmarkInputFrame = 0;
+        sBenchmarkInput++;
+    }
+}
+
+static u16 benchmark_cycles_to_usec(u32 cycles) {
+    return MIN(OS_CYCLES_TO_USEC(cycles), 0xFFFFU);
+}
+
+/**
+ * Samples the profiler once the frame has been submitted.
+ */
+void benchmark_frame_end(void) {
+    struct BenchmarkHeader *header = &sBenchmarkResults.header;
+
+    if (!sBenchmarkReplaying) {
+        return;
+    }
+
+    header->routeFrames++;
+    if (header->count >= BENCHMARK_MAX_FRAMES) {
+        return;
+    }
+
+    struct BenchmarkFrame *frame = &sBenchmarkResults.frames[header->count++];
+    u32 rdpClocks = MAX(MAX(profiler_get_last_sample(PROFILER_TIME_TMEM), profiler_get_last_sample(PROFILER_TIME_CMD)),
+                        profiler_get_last_sample(PROFILER_TIME_PIPE));
+
+    frame->cpu = benchmark_cycles_to_usec(profiler_get_last_sample(PROFILER_TIME_TOTAL));
+    frame->cpuAudio = benchmark_cycles_to_usec(profiler_get_last_sample(PROFILER_TIME_AUDIO));
+    frame->rspGfx = benchmark_cycles_to_usec(profiler_get_last_sample(PROFILER_TIME_RSP_GFX));
+    frame->rspAudio = benchmark_cycles_to_usec(profiler_get_last_sample(PROFILER_TIME_RSP_AUDIO));
+    frame->rdp = MIN(rdpClocks * 2 / 125, 0xFFFFU); // 62.5 MHz
+    frame->objects = gObjectCounter;
+}
+
+#endif
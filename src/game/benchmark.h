@@ -0,0 +1,64 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/**
+ * @file benchmark.h
+ * Input recording and deterministic replay benchmarks, see benchmark.c for details.
+ */
+
+#include <PR/ultratypes.h>
+
+#include "types.h"
+#include "config.h"
+
+#define BENCHMARK_ROUTE_MAGIC   0x42525445 // "BRTE"
+#define BENCHMARK_RESULTS_MAGIC 0x424E4348 // "BNCH"
+#define BENCHMARK_VERSION       1
+
+// Both are sized so that a recording or a set of results fits in 32KB of SRAM.
+#define BENCHMARK_MAX_INPUTS 4096
+#define BENCHMARK_MAX_FRAMES 2400
+
+/**
+ * Header at the start of a route recording or a set of results, as read by tools/benchmark.py.
+ */
+struct BenchmarkHeader {
+    /*0x00*/ u32 magic;
+    /*0x04*/ u16 version;
+    /*0x06*/ u16 count; // Number of inputs or frames that follow
+    /*0x08*/ u32 routeChecksum;
+    /*0x0C*/ u32 routeFrames; // Length of the route in game frames
+}; // size = 0x10
+
+struct BenchmarkInput {
+    /*0x00*/ u16 frames; // How long the input is held for, 0 ends the route
+    /*0x02*/ u16 button;
+    /*0x04*/ s8 rawStickX;
+    /*0x05*/ s8 rawStickY;
+}; // size = 0x06
+
+/**
+ * Times are in microseconds. The RSP and audio times are from the last task or audio frame to complete.
+ */
+struct BenchmarkFrame {
+    /*0x00*/ u16 cpu;
+    /*0x02*/ u16 cpuAudio;
+    /*0x04*/ u16 rspGfx;
+    /*0x06*/ u16 rspAudio;
+    /*0x08*/ u16 rdp; // Busiest of the RDP's counters
+    /*0x0A*/ u16 objects;
+}; // size = 0x0C
+
+#if defined(BENCHMARK_RECORD_INPUTS) || defined(BENCHMARK_REPLAY)
+void benchmark_update_controller(struct Controller *controller);
+#else
+#define benchmark_update_controller(controller)
+#endif
+
+#ifdef BENCHMARK_REPLAY
+void benchmark_frame_end(void);
+#else
+#define benchmark_frame_end()
+#endif
+
+#endif // BENCHMARK_H
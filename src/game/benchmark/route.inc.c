@@ -0,0 +1,6 @@
+// Route replayed by BENCHMARK_REPLAY, generated with tools/benchmark.py route.
+// This default route holds no input for 1800 frames, so it idles from boot (or in TEST_LEVEL if one is set).
+static const struct BenchmarkInput sBenchmarkRoute[] = {
+    { 1800, 0x0000, 0, 0 },
+    { 0, 0, 0, 0 },
+};
@@ -347,7 +347,7 @@ void visual_surface_loop(Gfx **gfx) {
      || !gMarioState->marioObj) {
         return;
     }
-    Vtx *verts = alloc_display_list((iterate_surface_count(gMarioState->pos[0], gMarioState->pos[2]) * 3) * sizeof(Vtx));
+    Vtx *verts = FRAME_ALLOC(Vtx, iterate_surface_count(gMarioState->pos[0], gMarioState->pos[2]) * 3);
 
     gVisualSurfaceCount = 0;
     gVisualOffset       = 0;
@@ -450,7 +450,7 @@ static void render_box(Gfx **gfx, int index) {
     Mat4 mtxFloat;
 
     // Allocate the transformation matrix for this box
-    Mtx *mtx = alloc_display_list(sizeof(Mtx));
+    Mtx *mtx = FRAME_ALLOC(Mtx, 1);
 
     if (mtx == NULL) return;
 
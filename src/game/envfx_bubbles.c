@@ -11,6 +11,7 @@
 #include "audio/external.h"
 #include "textures.h"
 #include "level_geo.h"
+#include "frame_budget.h"
 
 /**
  * This file implements environment effects that are not snow:
@@ -389,7 +390,7 @@ void envfx_bubbles_update_switch(s32 mode, Vec3s camTo, Vec3s vertex1, Vec3s ver
 void append_bubble_vertex_buffer(Gfx *gfx, s32 index, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3,
                                  Vtx *template) {
     s32 i = 0;
-    Vtx *vertBuf = alloc_display_list(15 * sizeof(Vtx));
+    Vtx *vertBuf = FRAME_ALLOC(Vtx, 15);
 
     if (vertBuf == NULL) {
         return;
@@ -460,8 +461,7 @@ Gfx *envfx_update_bubble_particles(s32 mode, UNUSED Vec3s marioPos, Vec3s camFro
     Vec3s vertex2;
     Vec3s vertex3;
 
-    Gfx *gfxStart = alloc_display_list(((sBubbleParticleMaxCount / 5) * 10 + sBubbleParticleMaxCount + 3)
-                                       * sizeof(Gfx));
+    Gfx *gfxStart = FRAME_ALLOC(Gfx, (sBubbleParticleMaxCount / 5) * 10 + sBubbleParticleMaxCount + 3);
     if (gfxStart == NULL) {
         return NULL;
     }
@@ -503,7 +503,13 @@ void envfx_set_max_bubble_particles(s32 mode) {
         case ENVFX_JETSTREAM_BUBBLES:
             sBubbleParticleMaxCount = gEnvFxBubbleConfig[ENVFX_STATE_PARTICLECOUNT];
             break;
+        default:
+            sBubbleParticleMaxCount = sBubbleParticleCount;
+            break;
     }
+
+    // Fewer particles are drawn while the frame is over budget.
+    sBubbleParticleMaxCount = frame_budget_particle_count(sBubbleParticleMaxCount);
 }
 
 /**
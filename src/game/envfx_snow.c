@@ -13,6 +13,7 @@
 #include "audio/external.h"
 #include "obj_behaviors.h"
 #include "level_geo.h"
+#include "frame_budget.h"
 
 /**
  * This file contains the function that handles 'environment effects',
@@ -346,7 +347,7 @@ void rotate_triangle_vertices(Vec3s vertex1, Vec3s vertex2, Vec3s vertex3, s16 p
  */
 void append_snowflake_vertex_buffer(Gfx *gfx, s32 index, Vec3s vertex1, Vec3s vertex2, Vec3s vertex3) {
     s32 i = 0;
-    Vtx *vertBuf = (Vtx *) alloc_display_list(15 * sizeof(Vtx));
+    Vtx *vertBuf = FRAME_ALLOC(Vtx, 15);
 
     if (vertBuf == NULL) {
         return;
@@ -388,7 +389,7 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
     vertex2 = gSnowFlakeVertex2;
     vertex3 = gSnowFlakeVertex3;
 
-    gfxStart = (Gfx *) alloc_display_list((gSnowParticleCount * 6 + 3) * sizeof(Gfx));
+    gfxStart = FRAME_ALLOC(Gfx, gSnowParticleCount * 6 + 3);
     gfx = gfxStart;
 
     if (gfxStart == NULL) {
@@ -397,6 +398,10 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
 
     envfx_update_snowflake_count(snowMode, marioPos);
 
+    // Fewer flakes are drawn while the frame is over budget. The full count is put back at the end.
+    s16 fullSnowParticleCount = gSnowParticleCount;
+    gSnowParticleCount = frame_budget_particle_count(gSnowParticleCount);
+
     // Note: to and from are inverted here, so the resulting vector goes towards the camera
     orbit_from_positions(camTo, camFrom, &radius, &pitch, &yaw);
 
@@ -456,6 +461,7 @@ Gfx *envfx_update_snow(s32 snowMode, Vec3s marioPos, Vec3s camFrom, Vec3s camTo)
 
     gSPDisplayList(gfx++, &tiny_bubble_dl_0B006AB0) gSPEndDisplayList(gfx++);
 
+    gSnowParticleCount = fullSnowParticleCount;
     return gfxStart;
 }
 
@@ -0,0 +1,137 @@
+#include <ultra64.h>
+
+/**
+ * @file frame_budget.c
+ * Keeps the frame rate steady in busy scenes by trading away rendering quality.
+ *
+ * Once a frame, the CPU and RDP times of the last frame are compared with the time a frame has at 30 FPS. When the
+ * busier of the two runs over budget for a few frames in a row, the quality drops by a level, which shortens object
+ * draw distances and LOD distances, draws fewer snow and bubble particles and leaves out distant shadows. When there
+ * has been plenty of headroom for a while it goes back up by a level. Nothing here changes what objects do, only
+ * whether and how they are drawn.
+ */
+
+#include "sm64.h"
+#include "frame_budget.h"
+#include "object_list_processor.h"
+#include "profiling.h"
+
+#ifdef FRAME_BUDGET_GOVERNOR
+
+static const struct FrameBudgetLevel sFrameBudgetLevels[] = {
+    //  drawDistance  lodDistance  particles  shadowDistance
+    {   1.0f,         1.0f,        100,       0    },
+    {   0.85f,        1.25f,       75,        6000 },
+    {   0.7f,         1.5f,        50,        4000 },
+    {   0.55f,        2.0f,        25,        2000 },
+};
+
+const struct FrameBudgetLevel *gFrameBudgetLevel = &sFrameBudgetLevels[0];
+s32 gFrameBudgetLevelIndex = 0;
+
+static u16 sFramesOverBudget = 0;
+static u16 sFramesUnderBudget = 0;
+static u16 sFramesSinceRaised = 0;
+static u16 sRaiseDelay = FRAME_BUDGET_UNDER_FRAMES;
+
+static void frame_budget_set_level(s32 index) {
+    gFrameBudgetLevelIndex = index;
+    gFrameBudgetLevel = &sFrameBudgetLevels[index];
+    sFramesOverBudget = 0;
+    sFramesUnderBudget = 0;
+}
+
+/**
+ * Returns how much of its budget the last frame took, in percent, going by whichever of the CPU and RDP was busier.
+ */
+static u32 frame_budget_get_load(void) {
+    u32 budget = (osTvType == OS_TV_PAL) ? 40000 : 33333; // Two fields
+    // Audio runs about twice per frame, the same as in profiler_get_cpu_cycles.
+    u32 cpu = OS_CYCLES_TO_USEC(profiler_get_last_sample(PROFILER_TIME_TOTAL)
+                                + profiler_get_last_sample(PROFILER_TIME_AUDIO) * 2);
+    u32 rdpClocks = MAX(MAX(profiler_get_last_sample(PROFILER_TIME_TMEM), profiler_get_last_sample(PROFILER_TIME_CMD)),
+                        profiler_get_last_sample(PROFILER_TIME_PIPE));
+    u32 rdp = rdpClocks * 2 / 125; // 62.5 MHz
+
+    return MAX(cpu, rdp) * 100 / budget;
+}
+
+/**
+ * Moves the quality one level down or up depending on how the last few frames went. Called once per frame.
+ */
+void frame_budget_update(void) {
+    u32 load = frame_budget_get_load();
+
+    if (sFramesSinceRaised < 0xFFFF) {
+        sFramesSinceRaised++;
+    }
+
+    if (load > FRAME_BUDGET_OVER_PERCENT) {
+        sFramesUnderBudget = 0;
+        if (++sFramesOverBudget >= FRAME_BUDGET_OVER_FRAMES && gFrameBudgetLevelIndex < ARRAY_COUNT(sFrameBudgetLevels) - 1) {
+            // Going straight back over budget after raising the quality means the scene can't afford it yet,
+            // so wait longer before trying again.
+            if (sFramesSinceRaised < sRaiseDelay) {
+                sRaiseDelay = MIN(sRaiseDelay * 2, FRAME_BUDGET_UNDER_FRAMES_MAX);
+            }
+            frame_budget_set_level(gFrameBudgetLevelIndex + 1);
+        }
+    } else if (load < FRAME_BUDGET_UNDER_PERCENT) {
+        sFramesOverBudget = 0;
+        if (++sFramesUnderBudget >= sRaiseDelay && gFrameBudgetLevelIndex > 0) {
+            frame_budget_set_level(gFrameBudgetLevelIndex - 1);
+            sFramesSinceRaised = 0;
+        }
+    } else {
+        sFramesOverBudget = 0;
+        sFramesUnderBudget = 0;
+    }
+
+    // A scene that has held its level for a long time gets the short delay back.
+    if (sFramesSinceRaised >= FRAME_BUDGET_UNDER_FRAMES_MAX) {
+        sRaiseDelay = FRAME_BUDGET_UNDER_FRAMES;
+    }
+}
+
+/**
+ * Returns whether the object is close enough to Mario to be drawn at the current draw distance. Only objects that
+ * already hide themselves with distance in cur_obj_update are affected.
+ */
+s32 frame_budget_object_in_range(struct Object *obj) {
+    f32 scale = gFrameBudgetLevel->drawDistance;
+
+    if (scale >= 1.0f || obj == gMarioObject || obj->oRoom != -1) {
+        return TRUE;
+    }
+    if ((obj->oFlags & (OBJ_FLAG_COMPUTE_DIST_TO_MARIO | OBJ_FLAG_ACTIVE_FROM_AFAR)) != OBJ_FLAG_COMPUTE_DIST_TO_MARIO) {
+        return TRUE;
+    }
+
+    return obj->oDistanceToMario <= obj->oDrawingDistance * scale;
+}
+
+/**
+ * Returns whether the object's shadow should be drawn. Mario's always is.
+ */
+s32 frame_budget_shadow_in_range(struct GraphNodeObject *node) {
+    s16 distance = gFrameBudgetLevel->shadowDistance;
+
+    if (distance == 0 || gMarioObject == NULL || node == &gMarioObject->header.gfx) {
+        return TRUE;
+    }
+
+    return -node->cameraToObject[2] < distance;
+}
+
+/**
+ * Scales a particle count, keeping it a multiple of 5 since particles are drawn five at a time.
+ */
+s32 frame_budget_particle_count(s32 count) {
+    if (gFrameBudgetLevel->particles >= 100) {
+        return count;
+    }
+
+    return (count * gFrameBudgetLevel->particles / 100) / 5 * 5;
+}
+
+#endif
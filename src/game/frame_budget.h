@@ -0,0 +1,48 @@
+#ifndef FRAME_BUDGET_H
+#define FRAME_BUDGET_H
+
+/**
+ * @file frame_budget.h
+ * Lowers rendering quality while frames run over budget, see frame_budget.c for details.
+ */
+
+#include <PR/ultratypes.h>
+
+#include "types.h"
+#include "config.h"
+
+// Lower the quality when a frame takes longer than this much of its budget...
+#define FRAME_BUDGET_OVER_PERCENT   95
+// ...for this many frames in a row.
+#define FRAME_BUDGET_OVER_FRAMES    4
+// Raise it again when frames take less than this much of their budget...
+#define FRAME_BUDGET_UNDER_PERCENT  70
+// ...for this many frames in a row. This doubles each time raising the quality pushes frames back over budget.
+#define FRAME_BUDGET_UNDER_FRAMES   90
+#define FRAME_BUDGET_UNDER_FRAMES_MAX 1440
+
+struct FrameBudgetLevel {
+    f32 drawDistance;   // Scales the draw distance of objects that hide themselves with distance
+    f32 lodDistance;    // Scales the camera distance used to pick a level of detail
+    u8 particles;       // Percentage of snow and bubble particles drawn
+    s16 shadowDistance; // Shadows of objects further from the camera than this aren't drawn, 0 for no limit
+};
+
+#ifdef FRAME_BUDGET_GOVERNOR
+extern const struct FrameBudgetLevel *gFrameBudgetLevel;
+extern s32 gFrameBudgetLevelIndex;
+
+void frame_budget_update(void);
+s32 frame_budget_object_in_range(struct Object *obj);
+s32 frame_budget_shadow_in_range(struct GraphNodeObject *node);
+s32 frame_budget_particle_count(s32 count);
+#define frame_budget_lod_distance(distance) ((distance) * gFrameBudgetLevel->lodDistance)
+#else
+#define frame_budget_update()
+#define frame_budget_object_in_range(obj) TRUE
+#define frame_budget_shadow_in_range(node) TRUE
+#define frame_budget_particle_count(count) (count)
+#define frame_budget_lod_distance(distance) (distance)
+#endif
+
+#endif // FRAME_BUDGET_H
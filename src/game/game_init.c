@@ -31,6 +31,15 @@
 #include "vc_ultra.h"
 #include "profiling.h"
 #include "emutest.h"
+#include "benchmark.h"
+#include "frame_budget.h"
+#ifdef DYNAMIC_GFX_POOL
+#include "debug.h"
+#include "level_table.h"
+#ifdef UNF
+#include "usb/debug.h"
+#endif
+#endif
 
 // Emulators that the Instant Input patch should not be applied to
 #define INSTANT_INPUT_BLACKLIST (EMU_CONSOLE | EMU_WIIVC | EMU_ARES | EMU_SIMPLE64 | EMU_CEN64)
@@ -40,6 +49,10 @@ struct SPTask *gGfxSPTask;
 Gfx *gDisplayListHead;
 u8 *gGfxPoolEnd;
 struct GfxPool *gGfxPool;
+#ifdef DYNAMIC_GFX_POOL
+u32 gGfxPoolSize;
+#endif
+u32 gGfxPoolPeak = 0;
 
 // OS Controllers
 struct Controller gControllers[MAXCONTROLLERS];
@@ -344,7 +357,7 @@ void create_gfx_task_structure(void) {
     gGfxSPTask->task.t.output_buff = gGfxSPTaskOutputBuffer;
     gGfxSPTask->task.t.output_buff_size =
         (u64 *)((u8 *) gGfxSPTaskOutputBuffer + sizeof(gGfxSPTaskOutputBuffer));
-    gGfxSPTask->task.t.data_ptr = (u64 *) &gGfxPool->buffer;
+    gGfxSPTask->task.t.data_ptr = (u64 *) gGfxPool->buffer;
     gGfxSPTask->task.t.data_size = entries * sizeof(Gfx);
     gGfxSPTask->task.t.yield_data_ptr = (u64 *) gGfxSPTaskYieldBuffer;
     gGfxSPTask->task.t.yield_data_size = OS_YIELD_DATA_SIZE;
@@ -370,6 +383,10 @@ void end_master_display_list(void) {
     gDPFullSync(gDisplayListHead++);
     gSPEndDisplayList(gDisplayListHead++);
 
+    // Both ends of the pool count, since anything allocated from the end this frame is also in use.
+    u32 used = (gDisplayListHead - gGfxPool->buffer) + ((gGfxPool->buffer + gGfxPoolSize) - (Gfx *) gGfxPoolEnd);
+    gGfxPoolPeak = MAX(gGfxPoolPeak, used);
+
     create_gfx_task_structure();
 }
 
@@ -410,12 +427,20 @@ void draw_reset_bars(void) {
 void render_init(void) {
 #ifdef DEBUG_FORCE_CRASH_ON_BOOT
     FORCE_CRASH
+#endif
+#ifdef DYNAMIC_GFX_POOL
+    gGfxPools[0].buffer = gGfxPoolFallback[0];
+    gGfxPools[1].buffer = gGfxPoolFallback[1];
+    gGfxPoolSize = GFX_POOL_FALLBACK_SIZE;
 #endif
     gGfxPool = &gGfxPools[0];
     set_segment_base_addr(SEGMENT_RENDER, gGfxPool->buffer);
     gGfxSPTask = &gGfxPool->spTask;
     gDisplayListHead = gGfxPool->buffer;
-    gGfxPoolEnd = (u8 *)(gGfxPool->buffer + GFX_POOL_SIZE);
+    gGfxPoolEnd = (u8 *)(gGfxPool->buffer + gGfxPoolSize);
+#ifdef FRAME_ARENA_SIZE
+    frame_arena_select(0);
+#endif
     init_rcp(CLEAR_ZBUFFER);
     clear_framebuffer(0);
     end_master_display_list();
@@ -438,9 +463,85 @@ void select_gfx_pool(void) {
     set_segment_base_addr(SEGMENT_RENDER, gGfxPool->buffer);
     gGfxSPTask = &gGfxPool->spTask;
     gDisplayListHead = gGfxPool->buffer;
-    gGfxPoolEnd = (u8 *) (gGfxPool->buffer + GFX_POOL_SIZE);
+    gGfxPoolEnd = (u8 *) (gGfxPool->buffer + gGfxPoolSize);
+#ifdef FRAME_ARENA_SIZE
+    frame_arena_select(gGlobalTimer % ARRAY_COUNT(gGfxPools));
+#endif
+}
+
+#ifdef DYNAMIC_GFX_POOL
+#define GFX_POOL_LEVEL_SIZE(level, size) [level] = (size),
+static const u16 sLevelGfxPoolSizes[LEVEL_COUNT] = {
+#include "gfx_pool_sizes.h"
+};
+#undef GFX_POOL_LEVEL_SIZE
+
+static Gfx *sGfxPoolLevelBuffer = NULL;
+static u32 sGfxPoolLevelFreeSpace;
+static s32 sGfxPoolLevelNum;
+
+/**
+ * Point both graphics pools at consecutive buffers of size Gfx, and move this frame's display list to the new one.
+ * This happens from the level script, before anything has been drawn this frame.
+ */
+static void gfx_pool_set_buffers(Gfx *buffer, u32 size) {
+    assert(gDisplayListHead == gGfxPool->buffer && gGfxPoolEnd == (u8 *) (gGfxPool->buffer + gGfxPoolSize),
+           "Graphics pool changed after drawing started");
+    for (s32 i = 0; i < (s32) ARRAY_COUNT(gGfxPools); i++) {
+        gGfxPools[i].buffer = buffer + (i * size);
+    }
+    gGfxPoolSize = size;
+    gGfxPoolPeak = 0;
+    set_segment_base_addr(SEGMENT_RENDER, gGfxPool->buffer);
+    gDisplayListHead = gGfxPool->buffer;
+    gGfxPoolEnd = (u8 *) (gGfxPool->buffer + gGfxPoolSize);
 }
 
+/**
+ * Allocate the graphics pools of the level from the main pool, sized from sLevelGfxPoolSizes.
+ * Called from FREE_LEVEL_POOL once the level's areas are set up, and does nothing if the level already has its pools.
+ * If there's no room, the small static pools stay in use and the scene drops what doesn't fit.
+ */
+void gfx_pool_load_level(s32 levelNum) {
+    u32 size = GFX_POOL_SIZE;
+    Gfx *buffer;
+
+    if (sGfxPoolLevelBuffer != NULL) {
+        return;
+    }
+    if (levelNum > LEVEL_NONE && levelNum < LEVEL_COUNT && sLevelGfxPoolSizes[levelNum] != 0) {
+        size = sLevelGfxPoolSizes[levelNum] + (sLevelGfxPoolSizes[levelNum] / 8);
+    }
+    sGfxPoolLevelFreeSpace = main_pool_available();
+    buffer = main_pool_alloc(size * sizeof(Gfx) * ARRAY_COUNT(gGfxPools), MEMORY_POOL_LEFT);
+    if (buffer == NULL) {
+        return;
+    }
+    sGfxPoolLevelBuffer = buffer;
+    sGfxPoolLevelNum = levelNum;
+    gfx_pool_set_buffers(buffer, size);
+}
+
+/**
+ * Go back to the static pools if the level's pools were just freed by popping the main pool state.
+ * A state pushed before the pools were allocated is the only kind that restores at least as much free space.
+ * The last frame's display list may still be running from the freed pool, so wait for it before anything is loaded over it.
+ */
+void gfx_pool_unload_level(void) {
+    if (sGfxPoolLevelBuffer == NULL || main_pool_available() < sGfxPoolLevelFreeSpace) {
+        return;
+    }
+#ifdef UNF
+    osSyncPrintf("gfx pool peak,%d,%d\n", sGfxPoolLevelNum, gGfxPoolPeak);
+#endif
+    // The only message sent to this queue is the one for the finished graphics task, so put it back for display_and_vsync.
+    osRecvMesg(&gGfxVblankQueue, &gMainReceivedMesg, OS_MESG_BLOCK);
+    osSendMesg(&gGfxVblankQueue, gMainReceivedMesg, OS_MESG_NOBLOCK);
+    sGfxPoolLevelBuffer = NULL;
+    gfx_pool_set_buffers(gGfxPoolFallback[0], GFX_POOL_FALLBACK_SIZE);
+}
+#endif
+
 /**
  * This function:
  * - Sends the current master display list out to be rendered.
@@ -647,6 +748,8 @@ void read_controller_inputs(s32 threadID) {
             controller->stickMag       = 0.0f;
         }
     }
+
+    benchmark_update_controller(gPlayer1Controller);
 }
 
 /**
@@ -756,6 +859,10 @@ void setup_game_memory(void) {
     load_segment(SEGMENT_LEVEL_ENTRY, _entrySegmentRomStart, _entrySegmentRomEnd, MEMORY_POOL_LEFT, NULL, NULL);
     // Setup Segment 2 (Fonts, Text, etc)
     load_segment_decompress(SEGMENT_SEGMENT2, _segment2_mio0SegmentRomStart, _segment2_mio0SegmentRomEnd);
+#ifdef BEHAVIOR_PROFILING
+    // Load the map data so that the behavior profiler can resolve behavior names.
+    map_data_load();
+#endif
 }
 
 /**
@@ -772,6 +879,9 @@ void thread5_game_loop(UNUSED void *arg) {
 #endif
 #ifdef HVQM
     createHvqmThread();
+#endif
+#ifdef PC_SAMPLING_PROFILER
+    profiler_pc_sampler_init();
 #endif
     save_file_load_all();
 #ifdef PUPPYCAM
@@ -824,6 +934,8 @@ void thread5_game_loop(UNUSED void *arg) {
 #endif
 
         display_and_vsync();
+        benchmark_frame_end();
+        frame_budget_update();
 #ifdef VANILLA_DEBUG
         // when debug info is enabled, print the "BUF %d" information.
         if (gShowDebugText) {
@@ -13,11 +13,30 @@
 #define MARIO_ANIMS_POOL_SIZE 0x4000
 #define DEMO_INPUTS_POOL_SIZE 0x800
 
+// Bytes of the graphics pool kept free for everything drawn after the scene (HUD, text, menus, the end of the list).
+// Below twice this, the scene stops adding transparent layers, and below this it stops adding anything.
+#define GFX_POOL_RESERVE 0x1000
+
+#ifdef DYNAMIC_GFX_POOL
+// The size of the static pools used between levels, while no level pool is allocated.
+#define GFX_POOL_FALLBACK_SIZE 1024
+
+struct GfxPool {
+    Gfx *buffer;
+    struct SPTask spTask;
+};
+#else
 struct GfxPool {
     Gfx buffer[GFX_POOL_SIZE];
     struct SPTask spTask;
 };
 
+#define gGfxPoolSize GFX_POOL_SIZE
+#endif
+
+// Bytes left between the master display list and the data allocated from the end of the graphics pool.
+#define GFX_POOL_SPACE_LEFT(head) ((s32) (gGfxPoolEnd - (u8 *) (head)))
+
 struct DemoInput {
     u8 timer; // time until next input. if this value is 0, it means the demo is over
     s8 rawStickX;
@@ -46,6 +65,10 @@ extern struct SPTask *gGfxSPTask;
 extern Gfx *gDisplayListHead;
 extern u8 *gGfxPoolEnd;
 extern struct GfxPool *gGfxPool;
+#ifdef DYNAMIC_GFX_POOL
+extern u32 gGfxPoolSize;
+#endif
+extern u32 gGfxPoolPeak;
 extern u8 gControllerBits;
 extern u8 gBorderHeight;
 #ifdef VANILLA_STYLE_CUSTOM_DEBUG
@@ -89,6 +112,11 @@ void init_rcp(s32 resetZB);
 void end_master_display_list(void);
 void render_init(void);
 void select_gfx_pool(void);
+#ifdef DYNAMIC_GFX_POOL
+void gfx_pool_load_level(s32 levelNum);
+void gfx_pool_unload_level(void);
+#endif
 void display_and_vsync(void);
+void adjust_analog_stick(struct Controller *controller);
 
 #endif // GAME_INIT_H
@@ -164,6 +164,10 @@ Gfx *geo_exec_cake_end_screen(s32 callContext, struct GraphNode *node, UNUSED Ma
         displayList = alloc_display_list(3 * sizeof(*displayList));
         displayListHead = displayList;
 
+        if (displayList == NULL) {
+            return NULL;
+        }
+
         SET_GRAPH_NODE_LAYER(generatedNode->fnNode.node.flags, LAYER_OPAQUE);
 #if MULTILANG
         gSPDisplayList(displayListHead++, dl_cake_end_screen);
@@ -3,19 +3,35 @@
 #include <stdarg.h>
 #include <string.h>
 #include "segments.h"
+#include "memory.h"
 
 #define STACK_TRAVERSAL_LIMIT 100
 
+// Number of recently resolved addresses to remember, must be a power of two
+#define MAP_CACHE_SIZE 64
+
 struct MapEntry {
 	u32 addr;
 	u32 nm_offset;
 	u32 nm_len;
-	u32 pad;
+	u32 size; // 0 if unknown
 };
 extern u8 gMapStrings[];
-extern struct MapEntry gMapEntries[];
+extern struct MapEntry gMapEntries[]; // Sorted by address by tools/mapPacker.py
 extern u32 gMapEntrySize;
+
+struct MapCacheEntry {
+	u32 pc;
+	char *name; // NULL if the slot is empty
+};
+static struct MapCacheEntry sMapCache[MAP_CACHE_SIZE];
 extern u8 _mapDataSegmentRomStart[];
+extern u8 _mapDataSegmentRomEnd[];
+
+// The map data is linked at RAM_END - 0x100000, but map_data_load can put it closer to the end of RAM.
+// Its symbols are read through this offset from where they were linked to where the data is.
+static u32 sMapDataOffset = 0;
+#define MAP_DATA(type, sym) ((type) ((u8 *) (sym) + sMapDataOffset))
 
 
 // code provided by Wiseguy
@@ -39,20 +55,60 @@ static u32 headless_pi_status(void)
 void map_data_init(void) {
 	headless_dma((u32)_mapDataSegmentRomStart, (u32*)(RAM_END - 0x100000), 0x100000);
 	while (headless_pi_status() & (PI_STATUS_DMA_BUSY | PI_STATUS_ERROR));
+	sMapDataOffset = 0;
+	bzero(sMapCache, sizeof(sMapCache));
+}
+
+#ifdef BEHAVIOR_PROFILING
+// Loads the map data through the PI manager into the last MAP_DATA_RESIDENT_SIZE bytes of RAM,
+// for when it is needed while the game is still running. alloc_pool keeps the main pool out of them.
+void map_data_load(void) {
+	u8 *dest = (u8 *)(RAM_END - MAP_DATA_RESIDENT_SIZE);
+
+	dma_read(dest, _mapDataSegmentRomStart, _mapDataSegmentRomEnd);
+	sMapDataOffset = (u32) dest - (RAM_END - 0x100000);
+	bzero(sMapCache, sizeof(sMapCache));
+}
+#endif
+
+// Returns the index of the last symbol starting at or before pc, or -1 if there isn't one.
+static s32 map_find_entry(u32 pc) {
+	struct MapEntry *entries = MAP_DATA(struct MapEntry *, gMapEntries);
+	s32 lo = 0;
+	s32 hi = *MAP_DATA(u32 *, &gMapEntrySize);
+
+	while (lo < hi) {
+		s32 mid = (lo + hi) / 2;
+		if (entries[mid].addr > pc) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+
+	return lo - 1;
 }
 
 char *parse_map(u32 pc) {
-	u32 i;
+	struct MapCacheEntry *cached = &sMapCache[(pc >> 2) & (MAP_CACHE_SIZE - 1)];
+	struct MapEntry *entries = MAP_DATA(struct MapEntry *, gMapEntries);
+	s32 i;
 
-	for (i = 0; i < gMapEntrySize; i++) {
-		if (gMapEntries[i].addr >= pc) break;
+	if (cached->name != NULL && cached->pc == pc) {
+		return cached->name;
 	}
 
-	if (i == gMapEntrySize - 1) {
+	i = map_find_entry(pc);
+	if (i < 0) {
 		return NULL;
-	} else {
-		return (char*) ((u32)gMapStrings + gMapEntries[i - 1].nm_offset);
 	}
+	if (entries[i].size != 0 && pc - entries[i].addr >= entries[i].size) {
+		return NULL;
+	}
+
+	cached->pc = pc;
+	cached->name = MAP_DATA(char *, gMapStrings) + entries[i].nm_offset;
+	return cached->name;
 }
 
 extern u8 _mainSegmentStart[];
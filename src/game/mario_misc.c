@@ -304,10 +304,16 @@ static Gfx *make_gfx_mario_alpha(struct GraphNodeGenerated *node, s16 alpha) {
     if (alpha == 255) {
         SET_GRAPH_NODE_LAYER(node->fnNode.node.flags, LAYER_OPAQUE);
         gfxHead = alloc_display_list(2 * sizeof(*gfxHead));
+        if (gfxHead == NULL) {
+            return NULL;
+        }
         gfx = gfxHead;
     } else {
         SET_GRAPH_NODE_LAYER(node->fnNode.node.flags, LAYER_TRANSPARENT);
         gfxHead = alloc_display_list(3 * sizeof(*gfxHead));
+        if (gfxHead == NULL) {
+            return NULL;
+        }
         gfx = gfxHead;
         if (gMarioState->flags & (MARIO_VANISH_CAP | MARIO_TELEPORTING)) {
             gDPSetAlphaCompare(gfx++, G_AC_DITHER);
@@ -627,6 +633,9 @@ Gfx *geo_mirror_mario_backface_culling(s32 callContext, struct GraphNode *node,
 
     if (callContext == GEO_CONTEXT_RENDER && gCurGraphNodeObject == &gMirrorMario) {
         gfx = alloc_display_list(3 * sizeof(*gfx));
+        if (gfx == NULL) {
+            return NULL;
+        }
 
         if (asGenerated->parameter == 0) {
             gSPClearGeometryMode(&gfx[0], G_CULL_BACK);
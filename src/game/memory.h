@@ -56,6 +56,18 @@ u32 main_pool_available(void);
 u32 main_pool_push_state(void);
 u32 main_pool_pop_state(void);
 
+void dma_read(u8 *dest, u8 *srcStart, u8 *srcEnd);
+
+#ifdef BEHAVIOR_PROFILING
+extern u8 _mapDataSegmentRomStart[];
+extern u8 _mapDataSegmentRomEnd[];
+
+// The behavior profiler keeps the map data loaded this far from the end of RAM, out of the main pool.
+#define MAP_DATA_RESIDENT_SIZE ALIGN16((uintptr_t) _mapDataSegmentRomEnd - (uintptr_t) _mapDataSegmentRomStart)
+
+void map_data_load(void);
+#endif
+
 #ifndef NO_SEGMENTED_MEMORY
 void *load_segment(s32 segment, u8 *srcStart, u8 *srcEnd, u32 side, u8 *bssStart, u8 *bssEnd);
 void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd);
@@ -76,7 +88,105 @@ struct MemoryPool *mem_pool_init(u32 size, u32 side);
 void *mem_pool_alloc(struct MemoryPool *pool, u32 size);
 void mem_pool_free(struct MemoryPool *pool, void *addr);
 
+#ifdef MEMORY_ALLOC_TRACKER
+#define MEM_TRACKER_NUM_ALLOCS     1024 // Allocations that can be live at once. Alloc-only pools use one per caller.
+#define MEM_TRACKER_NUM_CALLERS    128
+#define MEM_TRACKER_HASH_BITS      7
+#define MEM_TRACKER_NUM_POOLS      8
+#define MEM_TRACKER_FREE_SPANS     32
+#define MEM_TRACKER_TOP_COUNT      10
+
+enum MemTrackerAllocator {
+    MEM_TRACKER_MAIN_POOL_LEFT,
+    MEM_TRACKER_MAIN_POOL_RIGHT,
+    MEM_TRACKER_ALLOC_ONLY_POOL,
+    MEM_TRACKER_MEMORY_POOL,
+    MEM_TRACKER_ALLOCATOR_COUNT
+};
+
+/**
+ * A live allocation. Allocations from an alloc-only pool can't be freed on their own, so each caller of a pool shares
+ * a single entry, which is released along with the pool.
+ */
+struct MemTrackerAlloc {
+    uintptr_t addr; // Start of the allocation, or the alloc-only pool it came from. 0 for an unused entry.
+    u32 size;
+    u32 frame;      // gGlobalTimer when it was made
+    u16 count;      // Allocations sharing this entry
+    u8 caller;      // Index into callers
+    u8 allocator;   // enum MemTrackerAllocator
+};
+
+struct MemTrackerCaller {
+    uintptr_t caller; // Return address into the code that allocated, 0 for an unused entry
+    u32 liveBytes;
+    u32 peakBytes;
+    u32 allocs;
+    u32 frees;
+    u32 lifetimeFrames; // Summed over every freed allocation
+    u16 liveCount;
+    u8 allocator;
+};
+
+struct MemTrackerPool {
+    struct MemoryPool *pool; // NULL for an unused entry
+    u32 used;
+    u32 peakUsed;
+    u8 caller;
+};
+
+struct MemTrackerFreeList {
+    u32 totalSpace;
+    u32 freeBytes;
+    u32 largestBlock;
+    u16 numBlocks;
+    u16 numSpans; // Blocks listed in spans. The rest are only counted.
+    struct {
+        u32 offset;
+        u32 size;
+    } spans[MEM_TRACKER_FREE_SPANS];
+};
+
+struct MemTracker {
+    struct MemTrackerAlloc allocs[MEM_TRACKER_NUM_ALLOCS];
+    struct MemTrackerCaller callers[MEM_TRACKER_NUM_CALLERS];
+    struct MemTrackerPool pools[MEM_TRACKER_NUM_POOLS];
+    u32 allocsEnd; // One past the last entry of allocs in use
+    u32 mainPoolPeakUsed;
+    u32 untracked; // Allocations that didn't fit in the tables
+};
+
+extern struct MemTracker gMemTracker;
+extern u8 *sPoolStart;
+extern u8 *sPoolEnd;
+extern struct MainPoolBlock *sPoolListHeadL;
+extern struct MainPoolBlock *sPoolListHeadR;
+
+s32 mem_tracker_get_top(struct MemTrackerCaller **top, s32 count, s32 sortByPeak);
+void mem_tracker_get_free_list(struct MemoryPool *pool, struct MemTrackerFreeList *freeList);
+#ifdef UNF
+void mem_tracker_dump(void);
+#endif
+#endif
+
 void *alloc_display_list(u32 size);
+#ifdef FRAME_ARENA_SIZE
+struct FrameArena {
+    u8 *start;
+    u8 *pos;
+    u8 *end;
+    u32 peakUsed;
+};
+
+extern struct FrameArena gFrameArena;
+
+void frame_arena_select(s32 index);
+void *frame_alloc(u32 size);
+#else
+#define frame_alloc(size) alloc_display_list(size)
+#endif
+// Allocate count items of a type for the current frame.
+#define FRAME_ALLOC(type, count) ((type *) frame_alloc(sizeof(type) * (count)))
 void setup_dma_table_list(struct DmaHandlerList *list, void *srcAddr, void *buffer);
 s32 load_patchable_table(struct DmaHandlerList *list, s32 index);
 
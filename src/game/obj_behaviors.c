@@ -91,6 +91,9 @@ Gfx UNUSED *geo_obj_transparency_something(s32 callContext, struct GraphNode *no
         }
 
         gfxHead = alloc_display_list(3 * sizeof(Gfx));
+        if (gfxHead == NULL) {
+            return NULL;
+        }
         gfx = gfxHead;
         SET_GRAPH_NODE_LAYER(obj->header.gfx.node.flags, LAYER_TRANSPARENT);
 
@@ -54,6 +54,9 @@ Gfx *geo_update_layer_transparency(s32 callContext, struct GraphNode *node, UNUS
 
         s32 objectOpacity = objectGraphNode->oOpacity;
         dlStart = alloc_display_list(sizeof(Gfx) * 3);
+        if (dlStart == NULL) {
+            return NULL;
+        }
 
         Gfx *dlHead = dlStart;
 
@@ -292,8 +292,10 @@ s32 update_objects_starting_at(struct ObjectNode *objList, struct ObjectNode *fi
     while (objList != firstObj) {
         gCurrentObject = (struct Object *) firstObj;
 
+        PROFILER_BEHAVIOR_GET_SNAPSHOT();
         gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_HAS_ANIMATION;
         cur_obj_update();
+        PROFILER_BEHAVIOR_UPDATE(((struct Object *) firstObj)->behavior);
 
         firstObj = firstObj->next;
         count++;
@@ -339,8 +341,10 @@ s32 update_objects_during_time_stop(struct ObjectNode *objList, struct ObjectNod
 
         // Only update if unfrozen
         if (unfrozen) {
+            PROFILER_BEHAVIOR_GET_SNAPSHOT();
             gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_HAS_ANIMATION;
             cur_obj_update();
+            PROFILER_BEHAVIOR_UPDATE(((struct Object *) firstObj)->behavior);
         } else {
             gCurrentObject->header.gfx.node.flags &= ~GRAPH_RENDER_HAS_ANIMATION;
         }
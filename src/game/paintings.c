@@ -835,10 +835,14 @@ Gfx *render_painting(u8 *img, s16 tWidth, s16 tHeight, s16 *textureMap, s16 mapV
     s16 numVtx = mapTris * 3;
 
     s16 commands = triGroups * 2 + remGroupTris + 7;
-    Vtx *verts = alloc_display_list(numVtx * sizeof(Vtx));
-    Gfx *dlist = alloc_display_list(commands * sizeof(Gfx));
+    Vtx *verts = FRAME_ALLOC(Vtx, numVtx);
+    Gfx *dlist = FRAME_ALLOC(Gfx, commands);
     Gfx *gfx = dlist;
 
+    if (verts == NULL || dlist == NULL) {
+        return NULL;
+    }
+
     gLoadBlockTexture(gfx++, tWidth, tHeight, G_IM_FMT_RGBA, img);
 
     // Draw the groups of 5 first
@@ -898,13 +902,17 @@ Gfx *render_painting(u8 *img, s16 tWidth, s16 tHeight, s16 *textureMap, s16 mapV
  */
 Gfx *painting_model_view_transform(struct Painting *painting) {
     f32 sizeRatio = painting->size / PAINTING_SIZE;
-    Mtx *rotX = alloc_display_list(sizeof(Mtx));
-    Mtx *rotY = alloc_display_list(sizeof(Mtx));
-    Mtx *translate = alloc_display_list(sizeof(Mtx));
-    Mtx *scale = alloc_display_list(sizeof(Mtx));
-    Gfx *dlist = alloc_display_list(5 * sizeof(Gfx));
+    Mtx *rotX = FRAME_ALLOC(Mtx, 1);
+    Mtx *rotY = FRAME_ALLOC(Mtx, 1);
+    Mtx *translate = FRAME_ALLOC(Mtx, 1);
+    Mtx *scale = FRAME_ALLOC(Mtx, 1);
+    Gfx *dlist = FRAME_ALLOC(Gfx, 5);
     Gfx *gfx = dlist;
 
+    if (rotX == NULL || rotY == NULL || translate == NULL || scale == NULL || dlist == NULL) {
+        return NULL;
+    }
+
     guTranslate(translate, painting->posX, painting->posY, painting->posZ);
     guRotate(rotX, painting->pitch, 1.0f, 0.0f, 0.0f);
     guRotate(rotY, painting->yaw, 0.0f, 1.0f, 0.0f);
@@ -932,14 +940,16 @@ Gfx *painting_ripple_image(struct Painting *painting) {
     PaintingData tHeight = painting->textureHeight;
     PaintingData **textureMaps = segmented_to_virtual(painting->textureMaps);
     Texture **textures = segmented_to_virtual(painting->textureArray);
-    Gfx *dlist = alloc_display_list((imageCount + 6) * sizeof(Gfx));
+    Gfx *dlist = FRAME_ALLOC(Gfx, imageCount + 6);
     Gfx *gfx = dlist;
 
-    if (dlist == NULL) {
-        return dlist;
+    Gfx *transform = painting_model_view_transform(painting);
+
+    if (dlist == NULL || transform == NULL) {
+        return NULL;
     }
 
-    gSPDisplayList(gfx++, painting_model_view_transform(painting));
+    gSPDisplayList(gfx++, transform);
     gSPDisplayList(gfx++, dl_paintings_rippling_begin);
     gSPDisplayList(gfx++, painting->rippleDisplayList);
 
@@ -948,7 +958,10 @@ Gfx *painting_ripple_image(struct Painting *painting) {
         textureMap = segmented_to_virtual(textureMaps[i]);
         meshVerts = textureMap[0];
         meshTris = textureMap[meshVerts * 3 + 1];
-        gSPDisplayList(gfx++, render_painting(textures[i], tWidth, tHeight, textureMap, meshVerts, meshTris, painting->alpha));
+        Gfx *image = render_painting(textures[i], tWidth, tHeight, textureMap, meshVerts, meshTris, painting->alpha);
+        if (image != NULL) {
+            gSPDisplayList(gfx++, image);
+        }
     }
 
     // Update the ripple, may automatically reset the painting's state.
@@ -971,14 +984,16 @@ Gfx *painting_ripple_env_mapped(struct Painting *painting) {
     s16 tHeight = painting->textureHeight;
     s16 **textureMaps = segmented_to_virtual(painting->textureMaps);
     u8 **tArray = segmented_to_virtual(painting->textureArray);
-    Gfx *dlist = alloc_display_list(7 * sizeof(Gfx));
+    Gfx *dlist = FRAME_ALLOC(Gfx, 7);
     Gfx *gfx = dlist;
 
-    if (dlist == NULL) {
-        return dlist;
+    Gfx *transform = painting_model_view_transform(painting);
+
+    if (dlist == NULL || transform == NULL) {
+        return NULL;
     }
 
-    gSPDisplayList(gfx++, painting_model_view_transform(painting));
+    gSPDisplayList(gfx++, transform);
     gSPDisplayList(gfx++, dl_paintings_env_mapped_begin);
     gSPDisplayList(gfx++, painting->rippleDisplayList);
 
@@ -986,7 +1001,10 @@ Gfx *painting_ripple_env_mapped(struct Painting *painting) {
     textureMap = segmented_to_virtual(textureMaps[0]);
     meshVerts = textureMap[0];
     meshTris = textureMap[meshVerts * 3 + 1];
-    gSPDisplayList(gfx++, render_painting(tArray[0], tWidth, tHeight, textureMap, meshVerts, meshTris, painting->alpha));
+    Gfx *image = render_painting(tArray[0], tWidth, tHeight, textureMap, meshVerts, meshTris, painting->alpha);
+    if (image != NULL) {
+        gSPDisplayList(gfx++, image);
+    }
 
     // Update the ripple, may automatically reset the painting's state.
     painting_update_ripple_state(painting);
@@ -1033,13 +1051,15 @@ Gfx *display_painting_rippling(struct Painting *painting) {
  * Render a normal painting.
  */
 Gfx *display_painting_not_rippling(struct Painting *painting) {
-    Gfx *dlist = alloc_display_list(4 * sizeof(Gfx));
+    Gfx *dlist = FRAME_ALLOC(Gfx, 4);
     Gfx *gfx = dlist;
 
-    if (dlist == NULL) {
-        return dlist;
+    Gfx *transform = painting_model_view_transform(painting);
+
+    if (dlist == NULL || transform == NULL) {
+        return NULL;
     }
-    gSPDisplayList(gfx++, painting_model_view_transform(painting));
+    gSPDisplayList(gfx++, transform);
     gSPDisplayList(gfx++, painting->normalDisplayList);
     gSPPopMatrix(gfx++, G_MTX_MODELVIEW);
     gSPEndDisplayList(gfx);
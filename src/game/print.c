@@ -426,7 +426,7 @@ void render_text_labels(void) {
         return;
     }
 
-    mtx = alloc_display_list(sizeof(*mtx));
+    mtx = FRAME_ALLOC(Mtx, 1);
 
     if (mtx == NULL) {
         sTextLabelsCount = 0;
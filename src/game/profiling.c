@@ -1,10 +1,18 @@
 #include <ultra64.h>
 #include <PR/os_internal_reg.h>
+#include <PR/os_internal_thread.h>
+#include <string.h>
 #include "game_init.h"
+#include "main.h"
+#include "engine/graph_node.h"
 
 #include "profiling.h"
 #include "fasttext.h"
 #include "puppyprint.h"
+#include "farcall.h"
+#ifdef UNF
+#include "usb/debug.h"
+#endif
 
 #ifdef USE_PROFILER
 
@@ -29,6 +37,109 @@ u32 audio_subset_starts[AUDIO_SUBSET_SIZE];
 u32 audio_subset_tallies[AUDIO_SUBSET_SIZE];
 #endif
 
+#ifdef BEHAVIOR_PROFILING
+BehaviorProfileData behavior_profiling_data[BEHAVIOR_PROFILER_NUM_ENTRIES];
+static BehaviorProfileData behavior_profiling_scratch[BEHAVIOR_PROFILER_NUM_ENTRIES];
+// Cycles spent in behaviors that could not be given an entry because the table was full
+u32 behavior_profiling_untracked;
+static u32 behavior_untracked_tally;
+static u32 behavior_preempted_snapshot;
+#endif
+
+#ifdef PROFILER_TRACE
+static ProfilerTraceDump sProfilerTrace;
+static u32 sProfilerTraceWriteIndex = 0;
+static u8 sProfilerTraceRecording = TRUE;
+static u8 sProfilerTraceRspGfxRunning = FALSE;
+
+static const char *sProfilerTraceScopeNames[PROFILER_TRACE_SCOPE_COUNT] = {
+    [PROFILER_TIME_CONTROLLERS]          = "Controllers",
+    [PROFILER_TIME_SPAWNER]              = "Spawner",
+    [PROFILER_TIME_DYNAMIC]              = "Dynamic Surfaces",
+    [PROFILER_TIME_BEHAVIOR_BEFORE_MARIO] = "Behaviors Before Mario",
+    [PROFILER_TIME_MARIO]                = "Mario",
+    [PROFILER_TIME_BEHAVIOR_AFTER_MARIO] = "Behaviors After Mario",
+    [PROFILER_TIME_GFX]                  = "Graph",
+    [PROFILER_TIME_CAMERA]               = "Camera",
+#ifdef PUPPYPRINT_DEBUG
+    [PROFILER_TIME_PUPPYPRINT1]          = "Puppyprint Render",
+    [PROFILER_TIME_PUPPYPRINT2]          = "Puppyprint Process",
+#endif
+    [PROFILER_TIME_AUDIO]                = "Audio",
+    [PROFILER_TIME_RSP_GFX]              = "RSP Gfx",
+    [PROFILER_TIME_RSP_AUDIO]            = "RSP Audio",
+    [PROFILER_TRACE_SCOPE_FRAME]         = "Frame",
+};
+
+/**
+ * Appends an event to the ring buffer. Can be called from any thread, including while handling interrupts.
+ */
+void profiler_trace_event(u32 scope, u32 type, u32 thread, u32 time) {
+    u32 saved = __osDisableInt();
+
+    if (sProfilerTraceRecording) {
+        ProfilerTraceEvent *event = &sProfilerTrace.events[sProfilerTraceWriteIndex & (PROFILER_TRACE_NUM_EVENTS - 1)];
+
+        event->time = time;
+        event->frame = gGlobalTimer;
+        event->scope = scope;
+        event->typeAndThread = (type << 6) | (thread & 0x3F);
+        sProfilerTraceWriteIndex++;
+    }
+
+    __osRestoreInt(saved);
+}
+
+static void profiler_trace_reverse(ProfilerTraceEvent *events, u32 count) {
+    ProfilerTraceEvent *end = events + count - 1;
+
+    while (events < end) {
+        ProfilerTraceEvent temp = *events;
+        *events++ = *end;
+        *end-- = temp;
+    }
+}
+
+/**
+ * Sends everything in the ring buffer over USB, oldest event first, and starts recording again from an empty buffer.
+ */
+void profiler_trace_dump() {
+    u32 saved = __osDisableInt();
+    u32 numEvents = MIN(sProfilerTraceWriteIndex, PROFILER_TRACE_NUM_EVENTS);
+    u32 oldest = (sProfilerTraceWriteIndex > PROFILER_TRACE_NUM_EVENTS) ? (sProfilerTraceWriteIndex & (PROFILER_TRACE_NUM_EVENTS - 1)) : 0;
+
+    sProfilerTraceRecording = FALSE;
+    __osRestoreInt(saved);
+
+    // Rotate the ring buffer in place so that it starts at the oldest event.
+    if (oldest != 0) {
+        profiler_trace_reverse(sProfilerTrace.events, oldest);
+        profiler_trace_reverse(sProfilerTrace.events + oldest, PROFILER_TRACE_NUM_EVENTS - oldest);
+        profiler_trace_reverse(sProfilerTrace.events, PROFILER_TRACE_NUM_EVENTS);
+    }
+
+    sProfilerTrace.magic = PROFILER_TRACE_MAGIC;
+    sProfilerTrace.version = PROFILER_TRACE_VERSION;
+    sProfilerTrace.numScopes = PROFILER_TRACE_SCOPE_COUNT;
+    sProfilerTrace.numEvents = numEvents;
+    sProfilerTrace.numDropped = sProfilerTraceWriteIndex - numEvents;
+    sProfilerTrace.counterRate = OS_CPU_COUNTER;
+    for (s32 i = 0; i < PROFILER_TRACE_SCOPE_COUNT; i++) {
+        bzero(sProfilerTrace.scopeNames[i], PROFILER_TRACE_NAME_LENGTH);
+        if (sProfilerTraceScopeNames[i] != NULL) {
+            strncpy(sProfilerTrace.scopeNames[i], sProfilerTraceScopeNames[i], PROFILER_TRACE_NAME_LENGTH - 1);
+        }
+    }
+
+    debug_dumpbinary(&sProfilerTrace, offsetof(ProfilerTraceDump, events) + numEvents * sizeof(ProfilerTraceEvent));
+
+    saved = __osDisableInt();
+    sProfilerTraceWriteIndex = 0;
+    sProfilerTraceRecording = TRUE;
+    __osRestoreInt(saved);
+}
+#endif
+
 static void buffer_update(ProfileTimeData* data, u32 new, int buffer_index) {
     u32 old = data->counts[buffer_index];
     data->total -= old;
@@ -53,11 +164,25 @@ void profiler_update(enum ProfilerTime which, u32 delta) {
     }
     
     buffer_update(cur_data, diff, profile_buffer_index);
+#ifdef PROFILER_TRACE
+    // The total is a sum over the frame rather than a section of it.
+    if (which != PROFILER_TIME_TOTAL) {
+        u32 thread = osGetThreadId(NULL);
+        profiler_trace_event(which, PROFILER_TRACE_BEGIN, thread, prev_time);
+        profiler_trace_event(which, PROFILER_TRACE_END, thread, cur_time);
+    }
+#endif
     prev_time = cur_time;
 }
 
 void profiler_rsp_started(enum ProfilerRSPTime which) {
     rsp_pending_times[which] = osGetCount();
+#ifdef PROFILER_TRACE
+    profiler_trace_event(PROFILER_TIME_RSP_GFX + which, PROFILER_TRACE_BEGIN, PROFILER_TRACE_THREAD_RSP, rsp_pending_times[which]);
+    if (which == PROFILER_RSP_GFX) {
+        sProfilerTraceRspGfxRunning = TRUE;
+    }
+#endif
 }
 
 void profiler_rsp_completed(enum ProfilerRSPTime which) {
@@ -65,6 +190,12 @@ void profiler_rsp_completed(enum ProfilerRSPTime which) {
     int cur_index = rsp_buffer_indices[which];
     u32 time = osGetCount() - rsp_pending_times[which];
     rsp_pending_times[which] = 0;
+#ifdef PROFILER_TRACE
+    profiler_trace_event(PROFILER_TIME_RSP_GFX + which, PROFILER_TRACE_END, PROFILER_TRACE_THREAD_RSP, osGetCount());
+    if (which == PROFILER_RSP_GFX) {
+        sProfilerTraceRspGfxRunning = FALSE;
+    }
+#endif
 
     buffer_update(cur_data, time, cur_index);
     cur_index++;
@@ -76,6 +207,12 @@ void profiler_rsp_completed(enum ProfilerRSPTime which) {
 
 void profiler_rsp_resumed() {
     rsp_pending_times[PROFILER_RSP_GFX] = osGetCount() - rsp_pending_times[PROFILER_RSP_GFX];
+#ifdef PROFILER_TRACE
+    // Also called when the gfx task yields to an audio task, so end the slice if it is running.
+    profiler_trace_event(PROFILER_TIME_RSP_GFX, sProfilerTraceRspGfxRunning ? PROFILER_TRACE_END : PROFILER_TRACE_BEGIN,
+                         PROFILER_TRACE_THREAD_RSP, osGetCount());
+    sProfilerTraceRspGfxRunning ^= TRUE;
+#endif
 }
 
 // This ends up being the same math as resumed, so we just use resumed for both
@@ -85,6 +222,9 @@ void profiler_rsp_resumed() {
 
 void profiler_audio_started() {
     audio_start = osGetCount();
+#ifdef PROFILER_TRACE
+    profiler_trace_event(PROFILER_TIME_AUDIO, PROFILER_TRACE_BEGIN, osGetThreadId(NULL), audio_start);
+#endif
 
 #ifdef AUDIO_PROFILING
     for (s32 i = 0; i < AUDIO_SUBSET_SIZE; i++) {
@@ -112,6 +252,604 @@ void profiler_collision_completed() {
 
 #endif
 
+#ifdef BEHAVIOR_PROFILING
+
+#define BEHAVIOR_PROFILER_HASH_BITS 7
+STATIC_ASSERT(BEHAVIOR_PROFILER_NUM_ENTRIES == (1 << BEHAVIOR_PROFILER_HASH_BITS), "BEHAVIOR_PROFILER_HASH_BITS does not match BEHAVIOR_PROFILER_NUM_ENTRIES!");
+
+static BehaviorProfileData *behavior_profiler_find(BehaviorProfileData *table, const BehaviorScript *behavior) {
+    // Behavior scripts are word aligned, so drop the low bits before hashing.
+    u32 index = (((uintptr_t) behavior >> 2) * 0x9E3779B1) >> (32 - BEHAVIOR_PROFILER_HASH_BITS);
+
+    for (s32 i = 0; i < BEHAVIOR_PROFILER_NUM_ENTRIES; i++) {
+        BehaviorProfileData *entry = &table[index];
+        if (entry->behavior == behavior) {
+            return entry;
+        }
+        if (entry->behavior == NULL) {
+            entry->behavior = behavior;
+            return entry;
+        }
+        index = (index + 1) & (BEHAVIOR_PROFILER_NUM_ENTRIES - 1);
+    }
+
+    return NULL;
+}
+
+u32 profiler_behavior_get_snapshot() {
+    behavior_preempted_snapshot = preempted_time;
+    return osGetCount();
+}
+
+void profiler_behavior_update(const BehaviorScript *behavior, u32 start, u32 collisionStart) {
+    s32 time = osGetCount() - start;
+    u32 cur_preempted_time = preempted_time;
+
+    // The audio thread overwrites preempted_time when it completes, so a change means it ran during this update.
+    if (cur_preempted_time != behavior_preempted_snapshot) {
+        time -= cur_preempted_time;
+    }
+    // Collision is profiled separately, so leave it out like the aggregate behavior timers do.
+    time -= profiler_get_delta(PROFILER_DELTA_COLLISION) - collisionStart;
+    if (time < 0) {
+        time = 0;
+    }
+
+    BehaviorProfileData *entry = behavior_profiler_find(behavior_profiling_data, behavior);
+    if (entry != NULL) {
+        entry->tally += time;
+        entry->objTally++;
+    } else {
+        behavior_untracked_tally += time;
+    }
+}
+
+/**
+ * Publish the tallies once every PROFILING_BUFFER_SIZE frames, and rebuild the table so that
+ * behaviors which are no longer running free up their slots.
+ */
+static void behavior_profiler_roll_window() {
+    bcopy(behavior_profiling_data, behavior_profiling_scratch, sizeof(behavior_profiling_data));
+    bzero(behavior_profiling_data, sizeof(behavior_profiling_data));
+
+    for (s32 i = 0; i < BEHAVIOR_PROFILER_NUM_ENTRIES; i++) {
+        BehaviorProfileData *old = &behavior_profiling_scratch[i];
+        if (old->behavior == NULL || old->objTally == 0) {
+            continue;
+        }
+        BehaviorProfileData *entry = behavior_profiler_find(behavior_profiling_data, old->behavior);
+        entry->total = old->tally;
+        entry->objTotal = old->objTally;
+    }
+
+    behavior_profiling_untracked = behavior_untracked_tally;
+    behavior_untracked_tally = 0;
+}
+
+/**
+ * Fill out with up to count entries from the last completed window, ordered by time or by update count.
+ * Returns the number of entries written.
+ */
+s32 profiler_behavior_get_top(BehaviorProfileData **out, s32 count, s32 sortByCount) {
+    s32 numFound = 0;
+
+    for (s32 i = 0; i < BEHAVIOR_PROFILER_NUM_ENTRIES; i++) {
+        BehaviorProfileData *entry = &behavior_profiling_data[i];
+        if (entry->behavior == NULL || entry->objTotal == 0) {
+            continue;
+        }
+        u32 key = (sortByCount ? entry->objTotal : entry->total);
+
+        // Insertion into the sorted output, dropping whatever falls off the end.
+        s32 j = MIN(numFound, count - 1);
+        if (j == count - 1 && numFound == count) {
+            BehaviorProfileData *last = out[j];
+            if ((sortByCount ? last->objTotal : last->total) >= key) {
+                continue;
+            }
+        }
+        while (j > 0 && (sortByCount ? out[j - 1]->objTotal : out[j - 1]->total) < key) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = entry;
+        if (numFound < count) {
+            numFound++;
+        }
+    }
+
+    return numFound;
+}
+
+#endif
+
+#ifdef PC_SAMPLING_PROFILER
+
+#define PC_SAMPLER_HASH_BITS 8
+STATIC_ASSERT(PC_SAMPLER_NUM_ENTRIES == (1 << PC_SAMPLER_HASH_BITS), "PC_SAMPLER_HASH_BITS does not match PC_SAMPLER_NUM_ENTRIES!");
+
+extern far char *parse_map(u32 pc);
+
+PCSampleData pc_sampling_data[PC_SAMPLER_NUM_ENTRIES];
+static PCSampleData pc_sampling_scratch[PC_SAMPLER_NUM_ENTRIES];
+u32 pc_sampling_total;
+u32 pc_sampling_idle;
+u32 pc_sampling_unknown;
+static u32 pc_sampling_total_tally;
+static u32 pc_sampling_unknown_tally;
+static u32 pc_sampling_idle_last;
+
+// Written by the sampler thread and drained by the game thread once a frame.
+static u32 pc_sampler_ring[PC_SAMPLER_RING_SIZE];
+static volatile u32 pc_sampler_write_index;
+static u32 pc_sampler_read_index;
+static volatile u32 pc_sampler_idle_count;
+
+static OSThread pc_sampler_thread;
+static ALIGNED8 u8 pc_sampler_stack[0x400];
+static OSMesgQueue pc_sampler_queue;
+static OSMesg pc_sampler_mesg;
+static OSTimer pc_sampler_timer;
+
+/**
+ * Wakes up on a periodic timer and records the PC of the thread that was interrupted, which is the highest priority
+ * thread that is ready to run. Its registers were saved to its context when this thread preempted it.
+ */
+static void thread10_pc_sampler(UNUSED void *arg) {
+    osCreateMesgQueue(&pc_sampler_queue, &pc_sampler_mesg, 1);
+    osSetTimer(&pc_sampler_timer, OS_USEC_TO_CYCLES(PC_SAMPLER_INTERVAL_USEC), OS_USEC_TO_CYCLES(PC_SAMPLER_INTERVAL_USEC),
+               &pc_sampler_queue, NULL);
+
+    while (TRUE) {
+        OSThread *sampled = NULL;
+
+        osRecvMesg(&pc_sampler_queue, NULL, OS_MESG_BLOCK);
+
+        for (OSThread *thread = __osGetActiveQueue(); thread->priority != -1; thread = thread->tlnext) {
+            if (thread->state == OS_STATE_RUNNABLE && (sampled == NULL || thread->priority > sampled->priority)) {
+                sampled = thread;
+            }
+        }
+
+        if (sampled == NULL || sampled == &gIdleThread) {
+            pc_sampler_idle_count++;
+        } else {
+            pc_sampler_ring[pc_sampler_write_index & (PC_SAMPLER_RING_SIZE - 1)] = sampled->context.pc;
+            pc_sampler_write_index++;
+        }
+    }
+}
+
+void profiler_pc_sampler_init() {
+    osCreateThread(&pc_sampler_thread, THREAD_10_PC_SAMPLER, thread10_pc_sampler, NULL,
+                   pc_sampler_stack + sizeof(pc_sampler_stack), 120);
+    osStartThread(&pc_sampler_thread);
+}
+
+static PCSampleData *pc_sampler_find(PCSampleData *table, const char *name) {
+    u32 index = (((uintptr_t) name >> 2) * 0x9E3779B1) >> (32 - PC_SAMPLER_HASH_BITS);
+
+    for (s32 i = 0; i < PC_SAMPLER_NUM_ENTRIES; i++) {
+        PCSampleData *entry = &table[index];
+        if (entry->name == name) {
+            return entry;
+        }
+        if (entry->name == NULL) {
+            entry->name = name;
+            return entry;
+        }
+        index = (index + 1) & (PC_SAMPLER_NUM_ENTRIES - 1);
+    }
+
+    return NULL;
+}
+
+/**
+ * Resolves the samples taken since the last frame to functions.
+ */
+static void pc_sampler_drain() {
+    u32 end = pc_sampler_write_index;
+
+    // Samples that were overwritten before they could be read are lost.
+    if (end - pc_sampler_read_index > PC_SAMPLER_RING_SIZE) {
+        pc_sampler_read_index = end - PC_SAMPLER_RING_SIZE;
+    }
+
+    for (; pc_sampler_read_index != end; pc_sampler_read_index++) {
+        char *name = parse_map(pc_sampler_ring[pc_sampler_read_index & (PC_SAMPLER_RING_SIZE - 1)]);
+        PCSampleData *entry = (name != NULL) ? pc_sampler_find(pc_sampling_data, name) : NULL;
+
+        if (entry != NULL) {
+            entry->tally++;
+        } else {
+            pc_sampling_unknown_tally++;
+        }
+        pc_sampling_total_tally++;
+    }
+}
+
+/**
+ * Publish the tallies once every PROFILING_BUFFER_SIZE frames, and rebuild the table so that
+ * functions which are no longer being hit free up their slots.
+ */
+static void pc_sampler_roll_window() {
+    u32 idle = pc_sampler_idle_count;
+
+    bcopy(pc_sampling_data, pc_sampling_scratch, sizeof(pc_sampling_data));
+    bzero(pc_sampling_data, sizeof(pc_sampling_data));
+
+    for (s32 i = 0; i < PC_SAMPLER_NUM_ENTRIES; i++) {
+        PCSampleData *old = &pc_sampling_scratch[i];
+        if (old->name == NULL || old->tally == 0) {
+            continue;
+        }
+        pc_sampler_find(pc_sampling_data, old->name)->total = old->tally;
+    }
+
+    pc_sampling_idle = idle - pc_sampling_idle_last;
+    pc_sampling_idle_last = idle;
+    pc_sampling_total = pc_sampling_total_tally + pc_sampling_idle;
+    pc_sampling_unknown = pc_sampling_unknown_tally;
+    pc_sampling_total_tally = 0;
+    pc_sampling_unknown_tally = 0;
+}
+
+/**
+ * Fill out with up to count functions from the last completed window, ordered by sample count.
+ * Returns the number of entries written.
+ */
+s32 profiler_pc_sampler_get_top(PCSampleData **out, s32 count) {
+    s32 numFound = 0;
+
+    for (s32 i = 0; i < PC_SAMPLER_NUM_ENTRIES; i++) {
+        PCSampleData *entry = &pc_sampling_data[i];
+        if (entry->name == NULL || entry->total == 0) {
+            continue;
+        }
+
+        // Insertion into the sorted output, dropping whatever falls off the end.
+        s32 j = MIN(numFound, count - 1);
+        if (j == count - 1 && numFound == count && out[j]->total >= entry->total) {
+            continue;
+        }
+        while (j > 0 && out[j - 1]->total < entry->total) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = entry;
+        if (numFound < count) {
+            numFound++;
+        }
+    }
+
+    return numFound;
+}
+
+#ifdef UNF
+/**
+ * Prints every function sampled in the last window as CSV.
+ */
+void profiler_pc_sampler_dump() {
+    osSyncPrintf("samples,function\n");
+    for (s32 i = 0; i < PC_SAMPLER_NUM_ENTRIES; i++) {
+        PCSampleData *entry = &pc_sampling_data[i];
+        if (entry->name != NULL && entry->total != 0) {
+            osSyncPrintf("%d,%s\n", entry->total, entry->name);
+        }
+    }
+    osSyncPrintf("%d,(unknown)\n%d,(idle)\n", pc_sampling_unknown, pc_sampling_idle);
+}
+#endif
+
+#endif
+
+#ifdef RDP_BREAKDOWN_PROFILER
+
+/**
+ * Every frame, one layer (or one display list in RDP_BREAKDOWN_OBJECTS mode) is chosen and wrapped in full syncs.
+ * A full sync raises a DP interrupt once the RDP has finished everything before it, where the scheduler reads the RDP's
+ * counters, so the difference between the two readings is what that layer or display list took. Over many frames each
+ * of them gets measured, and what a key costs per frame is estimated from its average cost and how often it is drawn.
+ */
+
+#define RDP_BREAKDOWN_HASH_BITS 7
+STATIC_ASSERT(RDP_BREAKDOWN_NUM_ENTRIES == (1 << RDP_BREAKDOWN_HASH_BITS), "RDP_BREAKDOWN_HASH_BITS does not match RDP_BREAKDOWN_NUM_ENTRIES!");
+
+typedef struct {
+    struct SPTask *task;    // Gfx task that contains the syncs, or NULL when the slot is free
+    uintptr_t key;
+    u32 counters[2][3];     // TMEM, CMD and PIPE counters read at each sync
+    volatile u8 numSyncs;   // Sync interrupts taken so far
+    volatile u8 done;       // Set by the scheduler once the frame has finished rendering
+    u8 discard;             // Set when the mode changed while the frame was rendering
+} RDPBreakdownFrame;
+
+RDPBreakdownData rdp_breakdown_data[RDP_BREAKDOWN_NUM_ENTRIES];
+static RDPBreakdownData rdp_breakdown_scratch[RDP_BREAKDOWN_NUM_ENTRIES];
+u32 rdp_breakdown_frames;
+enum RDPBreakdownMode rdp_breakdown_mode = RDP_BREAKDOWN_LAYERS;
+
+// One per gfx pool, since a frame can be rendering while the next one is built.
+static RDPBreakdownFrame rdp_breakdown_tasks[2];
+static RDPBreakdownFrame *rdp_breakdown_measuring;
+static u32 rdp_breakdown_slot;
+static u32 rdp_breakdown_target;
+static u32 rdp_breakdown_counter;
+static u32 rdp_breakdown_stale_interrupts;
+
+static RDPBreakdownData *rdp_breakdown_find(RDPBreakdownData *table, uintptr_t key) {
+    u32 index = ((key >> 1) * 0x9E3779B1) >> (32 - RDP_BREAKDOWN_HASH_BITS);
+
+    for (s32 i = 0; i < RDP_BREAKDOWN_NUM_ENTRIES; i++) {
+        RDPBreakdownData *entry = &table[index];
+        if (entry->key == key) {
+            return entry;
+        }
+        if (entry->key == 0) {
+            entry->key = key;
+            return entry;
+        }
+        index = (index + 1) & (RDP_BREAKDOWN_NUM_ENTRIES - 1);
+    }
+
+    return NULL;
+}
+
+static void rdp_breakdown_slot_begin(Gfx **gfx, enum RDPBreakdownMode mode, uintptr_t key) {
+    RDPBreakdownFrame *frame = NULL;
+
+    if (mode != rdp_breakdown_mode) {
+        return;
+    }
+
+    RDPBreakdownData *entry = rdp_breakdown_find(rdp_breakdown_data, key);
+    if (entry != NULL) {
+        entry->slots++;
+    }
+
+    if (rdp_breakdown_slot++ != rdp_breakdown_target || entry == NULL) {
+        return;
+    }
+
+    for (s32 i = 0; i < ARRAY_COUNT(rdp_breakdown_tasks); i++) {
+        // The last frame built in this pool has finished by now, so its slot can be reused.
+        if (rdp_breakdown_tasks[i].task == gGfxSPTask) {
+            rdp_breakdown_tasks[i].task = NULL;
+        }
+        if (rdp_breakdown_tasks[i].task == NULL && frame == NULL) {
+            frame = &rdp_breakdown_tasks[i];
+        }
+    }
+    if (frame == NULL) {
+        return;
+    }
+
+    frame->key = key;
+    frame->numSyncs = 0;
+    frame->done = FALSE;
+    frame->discard = FALSE;
+    frame->task = gGfxSPTask;
+    rdp_breakdown_measuring = frame;
+    gDPFullSync((*gfx)++);
+}
+
+static void rdp_breakdown_slot_end(Gfx **gfx, enum RDPBreakdownMode mode) {
+    if (mode != rdp_breakdown_mode || rdp_breakdown_measuring == NULL) {
+        return;
+    }
+
+    rdp_breakdown_measuring = NULL;
+    gDPFullSync((*gfx)++);
+}
+
+void profiler_rdp_breakdown_layer_begin(Gfx **gfx, s32 layer, struct DisplayListNode *list) {
+    if (list != NULL) {
+        rdp_breakdown_slot_begin(gfx, RDP_BREAKDOWN_LAYERS, (layer << 1) | 1);
+    }
+}
+
+void profiler_rdp_breakdown_layer_end(Gfx **gfx) {
+    rdp_breakdown_slot_end(gfx, RDP_BREAKDOWN_LAYERS);
+}
+
+void profiler_rdp_breakdown_node_begin(Gfx **gfx, struct DisplayListNode *node) {
+    rdp_breakdown_slot_begin(gfx, RDP_BREAKDOWN_OBJECTS, (uintptr_t) node->behavior | 1);
+}
+
+void profiler_rdp_breakdown_node_end(Gfx **gfx) {
+    rdp_breakdown_slot_end(gfx, RDP_BREAKDOWN_OBJECTS);
+}
+
+static RDPBreakdownFrame *rdp_breakdown_find_task(struct SPTask *task) {
+    for (s32 i = 0; i < ARRAY_COUNT(rdp_breakdown_tasks); i++) {
+        RDPBreakdownFrame *frame = &rdp_breakdown_tasks[i];
+        if (task != NULL && frame->task == task && !frame->done) {
+            return frame;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Once the SP has finished, the RDP being idle with every command read means it has passed the final full sync.
+ */
+static s32 rdp_breakdown_reached_end(struct SPTask *task) {
+    return task->state == SPTASK_STATE_FINISHED
+        && !(IO_READ(DPC_STATUS_REG) & (DPC_STATUS_CMD_BUSY | DPC_STATUS_PIPE_BUSY | DPC_STATUS_START_VALID))
+        && IO_READ(DPC_CURRENT_REG) == IO_READ(DPC_END_REG);
+}
+
+/**
+ * Called by the scheduler for each DP interrupt, with the number of DP interrupts still queued.
+ * Returns TRUE if it came from one of the breakdown's syncs rather than from the end of the frame.
+ */
+s32 profiler_rdp_breakdown_dp_interrupt(struct SPTask *task, s32 pendingInterrupts) {
+    if (rdp_breakdown_stale_interrupts != 0) {
+        rdp_breakdown_stale_interrupts--;
+        return TRUE;
+    }
+
+    RDPBreakdownFrame *frame = rdp_breakdown_find_task(task);
+    if (frame == NULL) {
+        return FALSE;
+    }
+
+    if (!rdp_breakdown_reached_end(task)) {
+        if (frame->numSyncs < 2) {
+            frame->counters[frame->numSyncs][0] = IO_READ(DPC_TMEM_REG);
+            frame->counters[frame->numSyncs][1] = IO_READ(DPC_BUFBUSY_REG);
+            frame->counters[frame->numSyncs][2] = IO_READ(DPC_PIPEBUSY_REG);
+        }
+        frame->numSyncs++;
+        return TRUE;
+    }
+
+    // Syncs that completed close to the end of the frame either shared this interrupt, or are still queued behind it.
+    rdp_breakdown_stale_interrupts = pendingInterrupts;
+    frame->done = TRUE;
+    return FALSE;
+}
+
+/**
+ * Called by the scheduler after each SP task. If the RDP finished the frame before the SP task was marked as done,
+ * the interrupt at the end of the frame was taken for a sync, so this returns TRUE to finish the frame here instead.
+ */
+s32 profiler_rdp_breakdown_sp_complete(struct SPTask *task, s32 pendingInterrupts) {
+    RDPBreakdownFrame *frame = rdp_breakdown_find_task(task);
+
+    if (frame == NULL || pendingInterrupts != 0 || !rdp_breakdown_reached_end(task)) {
+        return FALSE;
+    }
+
+    // The readings can only be told apart if the two syncs and the end of the frame each had their own interrupt.
+    frame->numSyncs = (frame->numSyncs == 3) ? 2 : 0;
+    frame->done = TRUE;
+    return TRUE;
+}
+
+/**
+ * Halve every tally once the window is full, and rebuild the table so that keys which are no longer drawn free up
+ * their slots.
+ */
+static void rdp_breakdown_decay() {
+    bcopy(rdp_breakdown_data, rdp_breakdown_scratch, sizeof(rdp_breakdown_data));
+    bzero(rdp_breakdown_data, sizeof(rdp_breakdown_data));
+
+    for (s32 i = 0; i < RDP_BREAKDOWN_NUM_ENTRIES; i++) {
+        RDPBreakdownData *old = &rdp_breakdown_scratch[i];
+        if (old->key == 0 || (old->slots < 2 && old->samples < 2)) {
+            continue;
+        }
+        RDPBreakdownData *entry = rdp_breakdown_find(rdp_breakdown_data, old->key);
+        entry->clocks = old->clocks / 2;
+        entry->samples = old->samples / 2;
+        entry->slots = old->slots / 2;
+    }
+
+    rdp_breakdown_frames /= 2;
+}
+
+/**
+ * Tallies the measurements of frames that have finished rendering, and picks what to measure in the next one.
+ */
+static void rdp_breakdown_update() {
+    for (s32 i = 0; i < ARRAY_COUNT(rdp_breakdown_tasks); i++) {
+        RDPBreakdownFrame *frame = &rdp_breakdown_tasks[i];
+        if (frame->task == NULL || !frame->done) {
+            continue;
+        }
+        frame->task = NULL;
+        if (frame->discard || frame->numSyncs != 2) {
+            continue;
+        }
+
+        u32 clocks = 0;
+        s32 valid = TRUE;
+        for (s32 j = 0; j < 3; j++) {
+            // The counters are cleared once a frame, which may have happened between the two syncs.
+            if (frame->counters[1][j] < frame->counters[0][j]) {
+                valid = FALSE;
+            }
+            clocks = MAX(clocks, frame->counters[1][j] - frame->counters[0][j]);
+        }
+
+        RDPBreakdownData *entry = rdp_breakdown_find(rdp_breakdown_data, frame->key);
+        if (valid && entry != NULL) {
+            entry->clocks += clocks;
+            entry->samples++;
+        }
+    }
+
+    rdp_breakdown_frames++;
+    rdp_breakdown_target = (rdp_breakdown_slot != 0) ? (rdp_breakdown_counter++ % rdp_breakdown_slot) : 0;
+    rdp_breakdown_slot = 0;
+
+    if (rdp_breakdown_frames >= RDP_BREAKDOWN_WINDOW) {
+        rdp_breakdown_decay();
+    }
+}
+
+void profiler_rdp_breakdown_set_mode(enum RDPBreakdownMode mode) {
+    for (s32 i = 0; i < ARRAY_COUNT(rdp_breakdown_tasks); i++) {
+        rdp_breakdown_tasks[i].discard = TRUE;
+    }
+    bzero(rdp_breakdown_data, sizeof(rdp_breakdown_data));
+    rdp_breakdown_frames = 0;
+    rdp_breakdown_mode = mode;
+}
+
+/**
+ * Returns how long one of the entry's layers or display lists takes on average, or how long all of them take per frame.
+ */
+u32 profiler_rdp_breakdown_get_microseconds(RDPBreakdownData *entry, s32 perFrame) {
+    if (entry->samples == 0 || rdp_breakdown_frames == 0) {
+        return 0;
+    }
+
+    u64 clocks = entry->clocks;
+    if (perFrame) {
+        return RDP_CYCLE_CONV((clocks * entry->slots) / ((u64) entry->samples * rdp_breakdown_frames));
+    }
+    return RDP_CYCLE_CONV(clocks / entry->samples);
+}
+
+/**
+ * Fill out with up to count entries that have been measured, ordered by their time per frame.
+ * Returns the number of entries written, and the time per frame of every entry in totalMicroseconds.
+ */
+s32 profiler_rdp_breakdown_get_top(RDPBreakdownData **out, s32 count, u32 *totalMicroseconds) {
+    s32 numFound = 0;
+
+    *totalMicroseconds = 0;
+    for (s32 i = 0; i < RDP_BREAKDOWN_NUM_ENTRIES; i++) {
+        RDPBreakdownData *entry = &rdp_breakdown_data[i];
+        if (entry->key == 0 || entry->samples == 0) {
+            continue;
+        }
+        u32 key = profiler_rdp_breakdown_get_microseconds(entry, TRUE);
+        *totalMicroseconds += key;
+
+        // Insertion into the sorted output, dropping whatever falls off the end.
+        s32 j = MIN(numFound, count - 1);
+        if (j == count - 1 && numFound == count && profiler_rdp_breakdown_get_microseconds(out[j], TRUE) >= key) {
+            continue;
+        }
+        while (j > 0 && profiler_rdp_breakdown_get_microseconds(out[j - 1], TRUE) < key) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = entry;
+        if (numFound < count) {
+            numFound++;
+        }
+    }
+
+    return numFound;
+}
+
+#endif
+
 u32 profiler_get_delta(enum ProfilerDeltaTime which) {
     if (which == PROFILER_DELTA_COLLISION) {
         return collision_time;
@@ -127,6 +865,9 @@ void profiler_audio_completed() {
 
     preempted_time = time - audio_start;
     buffer_update(cur_data, time - audio_start, cur_index);
+#ifdef PROFILER_TRACE
+    profiler_trace_event(PROFILER_TIME_AUDIO, PROFILER_TRACE_END, osGetThreadId(NULL), time);
+#endif
 
 #ifdef AUDIO_PROFILING
     audio_subset_tallies[PROFILER_TIME_SUB_AUDIO_UPDATE - PROFILER_TIME_SUB_AUDIO_START] += time - audio_subset_starts[PROFILER_TIME_SUB_AUDIO_UPDATE - PROFILER_TIME_SUB_AUDIO_START];
@@ -229,6 +970,27 @@ u32 profiler_get_rdp_microseconds() {
     return RDP_CYCLE_CONV(rdp_max_cycles / PROFILING_BUFFER_SIZE);
 }
 
+/**
+ * Returns the most recent sample of a timer rather than the average, in CPU cycles or RDP clocks.
+ * The RSP and audio timers are only updated when their task or frame completes, so they can be a frame behind.
+ */
+u32 profiler_get_last_sample(enum ProfilerTime which) {
+    s32 index;
+
+    if (which == PROFILER_TIME_RSP_GFX || which == PROFILER_TIME_RSP_AUDIO) {
+        index = rsp_buffer_indices[which - PROFILER_TIME_RSP_GFX] - 1;
+    } else if (which == PROFILER_TIME_AUDIO) {
+        index = (s32) audio_buffer_index - 1;
+    } else {
+        index = profile_buffer_index;
+    }
+    if (index < 0) {
+        index += PROFILING_BUFFER_SIZE;
+    }
+
+    return all_profiling_data[which].counts[index];
+}
+
 void profiler_print_times() {
     u32 microseconds[PROFILER_TIME_COUNT];
     char text_buffer[196];
@@ -237,6 +999,12 @@ void profiler_print_times() {
     update_total_timer();
     update_rdp_timers();
 
+#ifdef PROFILER_TRACE
+    if ((gPlayer1Controller->buttonPressed & (L_TRIG | D_JPAD)) && (gPlayer1Controller->buttonDown & L_TRIG) && (gPlayer1Controller->buttonDown & D_JPAD)) {
+        profiler_trace_dump();
+    }
+#endif
+
 #ifndef PUPPYPRINT_DEBUG
     static u8 show_profiler = 0;
     if ((gPlayer1Controller->buttonPressed & (L_TRIG | U_JPAD)) && (gPlayer1Controller->buttonDown & L_TRIG) && (gPlayer1Controller->buttonDown & U_JPAD)) {
@@ -330,9 +1098,24 @@ void profiler_frame_setup() {
 
     if (profile_buffer_index >= PROFILING_BUFFER_SIZE) {
         profile_buffer_index = 0;
+#ifdef BEHAVIOR_PROFILING
+        behavior_profiler_roll_window();
+#endif
+#ifdef PC_SAMPLING_PROFILER
+        pc_sampler_roll_window();
+#endif
     }
+#ifdef PC_SAMPLING_PROFILER
+    pc_sampler_drain();
+#endif
+#ifdef RDP_BREAKDOWN_PROFILER
+    rdp_breakdown_update();
+#endif
 
     prev_time = cur_start = osGetCount();
+#ifdef PROFILER_TRACE
+    profiler_trace_event(PROFILER_TRACE_SCOPE_FRAME, PROFILER_TRACE_INSTANT, osGetThreadId(NULL), cur_start);
+#endif
 }
 
 #endif
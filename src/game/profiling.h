@@ -3,6 +3,7 @@
 
 #include <ultra64.h>
 #include "macros.h"
+#include "types.h"
 #include "config/config_debug.h"
 #include "config/config_safeguards.h"
 
@@ -110,6 +111,7 @@ u32 profiler_get_delta(enum ProfilerDeltaTime which);
 u32 profiler_get_cpu_microseconds();
 u32 profiler_get_rsp_microseconds();
 u32 profiler_get_rdp_microseconds();
+u32 profiler_get_last_sample(enum ProfilerTime which);
 // See profiling.c to see why profiler_rsp_yielded isn't its own function
 static ALWAYS_INLINE void profiler_rsp_yielded() {
     profiler_rsp_resumed();
@@ -135,6 +137,151 @@ static ALWAYS_INLINE void profiler_rsp_yielded() {
 #define profiler_get_cpu_microseconds() 0
 #define profiler_get_rsp_microseconds() 0
 #define profiler_get_rdp_microseconds() 0
+#define profiler_get_last_sample(which) 0
+#endif
+
+#ifdef PROFILER_TRACE
+#define PROFILER_TRACE_NUM_EVENTS   4096 // Must be a power of two
+#define PROFILER_TRACE_NAME_LENGTH  24
+#define PROFILER_TRACE_MAGIC        0x54524345 // "TRCE"
+#define PROFILER_TRACE_VERSION      1
+
+// Events from tasks running on the RSP are put on their own track rather than the thread that started them.
+#define PROFILER_TRACE_THREAD_RSP   0x3F
+
+// Scopes below PROFILER_TIME_COUNT are the enum ProfilerTime buckets.
+enum ProfilerTraceScope {
+    PROFILER_TRACE_SCOPE_FRAME = PROFILER_TIME_COUNT,
+    // Add custom scopes here and name them in sProfilerTraceScopeNames.
+    PROFILER_TRACE_SCOPE_COUNT
+};
+
+enum ProfilerTraceEventType {
+    PROFILER_TRACE_BEGIN,
+    PROFILER_TRACE_END,
+    PROFILER_TRACE_INSTANT,
+};
+
+typedef struct {
+    u32 time;           // osGetCount()
+    u16 frame;          // gGlobalTimer
+    u8 scope;           // enum ProfilerTime or enum ProfilerTraceScope
+    u8 typeAndThread;   // enum ProfilerTraceEventType in the top 2 bits, thread id in the low 6
+} ProfilerTraceEvent; // size = 0x8
+
+// Layout of a dump sent over USB. Everything is big endian.
+typedef struct {
+    u32 magic;
+    u16 version;
+    u16 numScopes;
+    u32 numEvents;
+    u32 numDropped;     // Events that were overwritten since the last dump
+    u32 counterRate;    // osGetCount() ticks per second
+    char scopeNames[PROFILER_TRACE_SCOPE_COUNT][PROFILER_TRACE_NAME_LENGTH];
+    ProfilerTraceEvent events[PROFILER_TRACE_NUM_EVENTS];
+} ProfilerTraceDump;
+
+void profiler_trace_event(u32 scope, u32 type, u32 thread, u32 time);
+void profiler_trace_dump();
+
+// Mark the start and end of a custom scope on the calling thread
+#define PROFILER_TRACE_SCOPE_BEGIN(scope) profiler_trace_event(scope, PROFILER_TRACE_BEGIN, osGetThreadId(NULL), osGetCount())
+#define PROFILER_TRACE_SCOPE_END(scope)   profiler_trace_event(scope, PROFILER_TRACE_END, osGetThreadId(NULL), osGetCount())
+#else
+#define PROFILER_TRACE_SCOPE_BEGIN(scope)
+#define PROFILER_TRACE_SCOPE_END(scope)
+#endif
+
+#ifdef BEHAVIOR_PROFILING
+#define BEHAVIOR_PROFILER_NUM_ENTRIES 128 // Must be a power of two
+#define BEHAVIOR_PROFILER_TOP_COUNT   14
+
+typedef struct {
+    const BehaviorScript *behavior;
+    u32 tally;      // Cycles accumulated in the current window
+    u32 total;      // Cycles accumulated in the last completed window
+    u32 objTally;   // Object updates counted in the current window
+    u32 objTotal;   // Object updates counted in the last completed window
+} BehaviorProfileData;
+
+extern BehaviorProfileData behavior_profiling_data[BEHAVIOR_PROFILER_NUM_ENTRIES];
+extern u32 behavior_profiling_untracked;
+
+u32 profiler_behavior_get_snapshot();
+void profiler_behavior_update(const BehaviorScript *behavior, u32 start, u32 collisionStart);
+s32 profiler_behavior_get_top(BehaviorProfileData **out, s32 count, s32 sortByCount);
+
+#define PROFILER_BEHAVIOR_GET_SNAPSHOT() \
+    u32 bhvCollisionStart = profiler_get_delta(PROFILER_DELTA_COLLISION); \
+    u32 bhvStart = profiler_behavior_get_snapshot()
+#define PROFILER_BEHAVIOR_UPDATE(behavior) profiler_behavior_update(behavior, bhvStart, bhvCollisionStart)
+#else
+#define PROFILER_BEHAVIOR_GET_SNAPSHOT()
+#define PROFILER_BEHAVIOR_UPDATE(behavior)
+#endif
+
+#ifdef PC_SAMPLING_PROFILER
+#define PC_SAMPLER_INTERVAL_USEC 500
+#define PC_SAMPLER_RING_SIZE     512 // Must be a power of two
+#define PC_SAMPLER_NUM_ENTRIES   256 // Must be a power of two
+#define PC_SAMPLER_TOP_COUNT     14
+
+typedef struct {
+    const char *name; // Function name from the map data
+    u32 tally;        // Samples taken in the current window
+    u32 total;        // Samples taken in the last completed window
+} PCSampleData;
+
+extern PCSampleData pc_sampling_data[PC_SAMPLER_NUM_ENTRIES];
+// Counts from the last completed window
+extern u32 pc_sampling_total;
+extern u32 pc_sampling_idle;
+extern u32 pc_sampling_unknown;
+
+void profiler_pc_sampler_init();
+s32 profiler_pc_sampler_get_top(PCSampleData **out, s32 count);
+#ifdef UNF
+void profiler_pc_sampler_dump();
+#endif
+#endif
+
+#ifdef RDP_BREAKDOWN_PROFILER
+#define RDP_BREAKDOWN_NUM_ENTRIES 128 // Must be a power of two
+#define RDP_BREAKDOWN_TOP_COUNT   14
+#define RDP_BREAKDOWN_WINDOW      512 // The tallies are halved every this many frames, so that old scenes fade out
+
+enum RDPBreakdownMode {
+    RDP_BREAKDOWN_LAYERS,
+    RDP_BREAKDOWN_OBJECTS,
+};
+
+typedef struct {
+    uintptr_t key;  // (layer << 1) | 1, or the object's behavior | 1, so that neither can be 0
+    u32 clocks;     // RDP clocks over every sample
+    u32 samples;    // Times that one of its layers or display lists was measured
+    u32 slots;      // Layers or display lists drawn over rdp_breakdown_frames frames
+} RDPBreakdownData;
+
+struct DisplayListNode;
+
+extern RDPBreakdownData rdp_breakdown_data[RDP_BREAKDOWN_NUM_ENTRIES];
+extern u32 rdp_breakdown_frames;
+extern enum RDPBreakdownMode rdp_breakdown_mode;
+
+void profiler_rdp_breakdown_layer_begin(Gfx **gfx, s32 layer, struct DisplayListNode *list);
+void profiler_rdp_breakdown_layer_end(Gfx **gfx);
+void profiler_rdp_breakdown_node_begin(Gfx **gfx, struct DisplayListNode *node);
+void profiler_rdp_breakdown_node_end(Gfx **gfx);
+s32 profiler_rdp_breakdown_dp_interrupt(struct SPTask *task, s32 pendingInterrupts);
+s32 profiler_rdp_breakdown_sp_complete(struct SPTask *task, s32 pendingInterrupts);
+void profiler_rdp_breakdown_set_mode(enum RDPBreakdownMode mode);
+u32 profiler_rdp_breakdown_get_microseconds(RDPBreakdownData *entry, s32 perFrame);
+s32 profiler_rdp_breakdown_get_top(RDPBreakdownData **out, s32 count, u32 *totalMicroseconds);
+#else
+#define profiler_rdp_breakdown_layer_begin(gfx, layer, list)
+#define profiler_rdp_breakdown_layer_end(gfx)
+#define profiler_rdp_breakdown_node_begin(gfx, node)
+#define profiler_rdp_breakdown_node_end(gfx)
 #endif
 
 #ifdef AUDIO_PROFILING
@@ -45,12 +45,15 @@ a modern game engine's developer's console.
 #include "audio/external.h"
 #include "audio/heap.h"
 #include "audio/load.h"
+#include "audio/playback.h"
 #include "hud.h"
 #include "debug_box.h"
 #include "color_presets.h"
 #include "buffers/buffers.h"
 #include "profiling.h"
+#include "segment_names.h"
 #include "segment_symbols.h"
+#include "farcall.h"
 
 #ifdef PUPPYPRINT
 
@@ -389,6 +392,33 @@ static void print_audio_overview(void) {
     print_set_envcolour(255, 255, 255, 255);
     print_small_text_light(x, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
 
+#if defined(AUDIO_NOTE_PRIORITY_BUCKETS) || defined(AUDIO_SAMPLE_PREFETCH)
+    s32 statsY = y;
+#endif
+#ifdef AUDIO_NOTE_PRIORITY_BUCKETS
+    {
+        u32 steals, drops;
+        s32 busiestPlayer, busiestChannel;
+
+        puppyprint_get_note_steal_stats(&steals, &drops, &busiestPlayer, &busiestChannel);
+        sprintf(textBytes, "Steals: %d  Drops: %d", steals, drops);
+        print_small_text_light(SCREEN_WIDTH - x, statsY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        statsY += 12;
+        if (busiestChannel >= 0) {
+            sprintf(textBytes, "Most: P%d C%d", busiestPlayer, busiestChannel);
+            print_small_text_light(SCREEN_WIDTH - x, statsY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+            statsY += 12;
+        }
+    }
+#endif
+#ifdef AUDIO_SAMPLE_PREFETCH
+    // Totals since boot, over all notes
+    sprintf(textBytes, "DMA Hits: %d  Misses: %d", gSampleDmaStats.hits, gSampleDmaStats.misses);
+    print_small_text_light(SCREEN_WIDTH - x, statsY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    sprintf(textBytes, "Prefetches: %d  Used: %d", gSampleDmaStats.prefetches, gSampleDmaStats.prefetchHits);
+    print_small_text_light(SCREEN_WIDTH - x, statsY + 12, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+#endif
+
 #ifdef AUDIO_PROFILING
     for (s32 i = 0; i < ARRAY_COUNT(audioBenchmarkNames); i++) {
         y += 12;
@@ -418,6 +448,112 @@ static void print_audio_overview(void) {
     print_audio_ram_overview(x, textBytes);
 }
 
+#ifdef AUDIO_HEAP_TELEMETRY
+#define AUDIO_HEAP_LIST_TOP 88
+
+static u32 sAudioHeapScroll = 0;
+static u32 sAudioHeapScrollMax = 0;
+
+static void print_audio_heap_overview(void) {
+    static const char *poolNames[AUDIO_HEAP_KIND_COUNT][AUDIO_HEAP_POOL_TYPE_COUNT] = {
+        { "Seq Persistent:",  "Seq Temporary:"  },
+        { "Bank Persistent:", "Bank Temporary:" },
+    };
+    static const char *residenceNames[] = { "-", "Pers", "Temp L", "Temp R" };
+    struct SoundMultiPool *multiPools[AUDIO_HEAP_KIND_COUNT] = { &gSeqLoadedPool, &gBankLoadedPool };
+    char textBytes[64];
+    s32 y = 8;
+    s32 kind, poolType;
+    u32 i;
+
+    prepare_blank_box();
+    render_blank_box(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 168);
+    finish_blank_box();
+
+    // Pool usage, with the peak since boot to size EXPAND_AUDIO_HEAP pools from.
+    print_set_envcolour(255, 255, 159, 255);
+    print_small_text_light(16, y, "Pool", PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(172, y, "Used / Size", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(220, y, "Peak", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 16, y, "Evict/Fail/Ovf", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    for (kind = 0; kind < AUDIO_HEAP_KIND_COUNT; kind++) {
+        for (poolType = 0; poolType < AUDIO_HEAP_POOL_TYPE_COUNT; poolType++) {
+            struct AudioHeapPoolStats *pool = &gAudioHeapTelemetry.pools[kind][poolType];
+            u32 size = (poolType == AUDIO_HEAP_POOL_PERSISTENT) ? multiPools[kind]->persistent.pool.size
+                                                                 : multiPools[kind]->temporary.pool.size;
+
+            y += 12;
+            print_set_envcolour(colourChart[2 + kind + poolType * 2][0],
+                                colourChart[2 + kind + poolType * 2][1],
+                                colourChart[2 + kind + poolType * 2][2], 255);
+            print_small_text_light(16, y, poolNames[kind][poolType], PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%X / %X", audio_heap_pool_used(multiPools[kind], poolType), size);
+            print_small_text_light(172, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%X", pool->peakUsed);
+            print_small_text_light(220, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%d / %d / %d", pool->evictions, pool->failedAllocs, pool->overflows);
+            print_small_text_light(SCREEN_WIDTH - 16, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        }
+    }
+
+    // Every sequence and bank that has been loaded at least once.
+    y = AUDIO_HEAP_LIST_TOP - 12;
+    print_set_envcolour(255, 255, 159, 255);
+    print_small_text_light(16, y, "ID", PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(64, y, "Where", PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(140, y, "Size", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(176, y, "Loads", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(212, y, "Evict", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(244, y, "Hits", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 16, y, "Load us", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+
+    y = AUDIO_HEAP_LIST_TOP;
+    for (kind = 0; kind < AUDIO_HEAP_KIND_COUNT; kind++) {
+        u32 count = (kind == AUDIO_HEAP_SEQ) ? ARRAY_COUNT(gAudioHeapTelemetry.seqs) : ARRAY_COUNT(gAudioHeapTelemetry.banks);
+
+        for (i = 0; i < count; i++) {
+            struct AudioHeapEntryStats *entry = (kind == AUDIO_HEAP_SEQ) ? &gAudioHeapTelemetry.seqs[i] : &gAudioHeapTelemetry.banks[i];
+            s32 drawY = y - sAudioHeapScroll;
+
+            if (entry->loads == 0) {
+                continue;
+            }
+            y += 12;
+            if (drawY < AUDIO_HEAP_LIST_TOP || drawY > SCREEN_HEIGHT - 32) {
+                continue;
+            }
+
+            if (entry->residence == AUDIO_HEAP_NOT_RESIDENT) {
+                print_set_envcolour(159, 159, 159, 255);
+            } else {
+                print_set_envcolour(255, 255, 255, 255);
+            }
+            sprintf(textBytes, "%s %02X", (kind == AUDIO_HEAP_SEQ) ? "Seq" : "Bank", i);
+            print_small_text_light(16, drawY, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+            print_small_text_light(64, drawY, residenceNames[entry->residence], PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%X", entry->size);
+            print_small_text_light(140, drawY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%d", entry->loads);
+            print_small_text_light(176, drawY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%d", entry->evictions);
+            print_small_text_light(212, drawY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%d", entry->hits);
+            print_small_text_light(244, drawY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+            sprintf(textBytes, "%d (%d)", (u32) OS_CYCLES_TO_USEC(entry->lastLoadCycles), (u32) OS_CYCLES_TO_USEC(entry->maxLoadCycles));
+            print_small_text_light(SCREEN_WIDTH - 16, drawY, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        }
+    }
+    sAudioHeapScrollMax = MAX(y - (SCREEN_HEIGHT - 32), 0);
+
+    print_set_envcolour(255, 255, 255, 255);
+#ifdef UNF
+    print_small_text_light(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, "Dpad Up/Down: Scroll, A: Dump over USB", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#else
+    print_small_text_light(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, "Dpad Up/Down: Scroll", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#endif
+}
+#endif
+
 char consoleLogTable[LOG_BUFFER_SIZE][255];
 
 static char *write_to_buf(char *buffer, const char *data, size_t size) {
@@ -521,6 +657,300 @@ void puppyprint_render_minimal(void) {
     print_basic_profiling();
 }
 
+#ifdef BEHAVIOR_PROFILING
+extern far char *parse_map(u32 pc);
+
+static u8 sBehaviorSortByCount = FALSE;
+
+void puppyprint_render_behaviors(void) {
+    BehaviorProfileData *top[BEHAVIOR_PROFILER_TOP_COUNT];
+    char textBytes[64];
+    s32 y = 28;
+    s32 count = profiler_behavior_get_top(top, BEHAVIOR_PROFILER_TOP_COUNT, sBehaviorSortByCount);
+
+    prepare_blank_box();
+    render_blank_box(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 127);
+    finish_blank_box();
+
+    print_set_envcolour(255, 255, 159, 255);
+    print_small_text_light(16, 12, (sBehaviorSortByCount ? "Behavior (by count)" : "Behavior (by time)"), PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 80, 12, "Objs", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 16, 12, "Time", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+
+    print_set_envcolour(255, 255, 255, 255);
+    for (s32 i = 0; i < count; i++) {
+        BehaviorProfileData *entry = top[i];
+        char *name = parse_map((u32) virtual_to_segmented(SEGMENT_BEHAVIOR_DATA, entry->behavior));
+
+        if (name != NULL) {
+            sprintf(textBytes, "%.28s", name);
+        } else {
+            sprintf(textBytes, "0x%08X", (u32) entry->behavior);
+        }
+        print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+        // Both values are summed over PROFILING_BUFFER_SIZE frames, so show per frame averages.
+        sprintf(textBytes, "%d", (entry->objTotal + (PROFILING_BUFFER_SIZE / 2)) / PROFILING_BUFFER_SIZE);
+        print_small_text_light(SCREEN_WIDTH - 80, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        sprintf(textBytes, "%d" PP_CYCLE_STRING, (u32) PP_CYCLE_CONV(entry->total / PROFILING_BUFFER_SIZE));
+        print_small_text_light(SCREEN_WIDTH - 16, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        y += 12;
+    }
+
+    if (behavior_profiling_untracked != 0) {
+        print_set_envcolour(255, 95, 95, 255);
+        sprintf(textBytes, "Untracked: %d" PP_CYCLE_STRING, (u32) PP_CYCLE_CONV(behavior_profiling_untracked / PROFILING_BUFFER_SIZE));
+        print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    }
+
+    print_set_envcolour(255, 255, 255, 255);
+    print_small_text_light(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, "Dpad Left/Right: Sort by time / count", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+}
+#endif
+
+#ifdef PC_SAMPLING_PROFILER
+void puppyprint_render_pc_samples(void) {
+    PCSampleData *top[PC_SAMPLER_TOP_COUNT];
+    char textBytes[64];
+    s32 y = 28;
+    s32 count = profiler_pc_sampler_get_top(top, PC_SAMPLER_TOP_COUNT);
+    // Percentages are of the time spent outside of the idle thread.
+    u32 busy = MAX(pc_sampling_total - pc_sampling_idle, 1U);
+
+    prepare_blank_box();
+    render_blank_box(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 127);
+    finish_blank_box();
+
+    print_set_envcolour(255, 255, 159, 255);
+    print_small_text_light(16, 12, "Function", PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 64, 12, "Hits", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 16, 12, "Busy", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+
+    print_set_envcolour(255, 255, 255, 255);
+    for (s32 i = 0; i < count; i++) {
+        PCSampleData *entry = top[i];
+
+        sprintf(textBytes, "%.28s", entry->name);
+        print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+        sprintf(textBytes, "%d", entry->total);
+        print_small_text_light(SCREEN_WIDTH - 64, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        sprintf(textBytes, "%d%%", (entry->total * 100) / busy);
+        print_small_text_light(SCREEN_WIDTH - 16, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        y += 12;
+    }
+
+    print_set_envcolour(159, 159, 159, 255);
+    sprintf(textBytes, "Idle: %d%%  Unknown: %d  Samples: %d", (pc_sampling_idle * 100) / MAX(pc_sampling_total, 1U),
+            pc_sampling_unknown, pc_sampling_total);
+    print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+#ifdef UNF
+    print_set_envcolour(255, 255, 255, 255);
+    print_small_text_light(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, "A: Print all functions over USB", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#endif
+}
+#endif
+
+#ifdef RDP_BREAKDOWN_PROFILER
+static const char *sRDPBreakdownLayerNames[LAYER_COUNT] = {
+    [LAYER_FORCE]                       = "Force",
+    [LAYER_OPAQUE]                      = "Opaque",
+    [LAYER_OPAQUE_INTER]                = "Opaque Inter",
+    [LAYER_OPAQUE_DECAL]                = "Opaque Decal",
+    [LAYER_ALPHA]                       = "Alpha",
+#if SILHOUETTE
+    [LAYER_ALPHA_DECAL]                 = "Alpha Decal",
+    [LAYER_SILHOUETTE_OPAQUE]           = "Silhouette Opaque",
+    [LAYER_SILHOUETTE_ALPHA]            = "Silhouette Alpha",
+    [LAYER_OCCLUDE_SILHOUETTE_OPAQUE]   = "Occlude Sil. Opaque",
+    [LAYER_OCCLUDE_SILHOUETTE_ALPHA]    = "Occlude Sil. Alpha",
+#endif
+    [LAYER_TRANSPARENT_DECAL]           = "Transparent Decal",
+    [LAYER_TRANSPARENT]                 = "Transparent",
+    [LAYER_TRANSPARENT_INTER]           = "Transparent Inter",
+};
+
+void puppyprint_render_rdp_breakdown(void) {
+    RDPBreakdownData *top[RDP_BREAKDOWN_TOP_COUNT];
+    char textBytes[64];
+    s32 y = 28;
+    u32 measured;
+    s32 count = profiler_rdp_breakdown_get_top(top, RDP_BREAKDOWN_TOP_COUNT, &measured);
+
+    prepare_blank_box();
+    render_blank_box(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 127);
+    finish_blank_box();
+
+    print_set_envcolour(255, 255, 159, 255);
+    print_small_text_light(16, 12, (rdp_breakdown_mode == RDP_BREAKDOWN_LAYERS ? "Layer" : "Object"), PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 72, 12, "Each", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 16, 12, "Frame", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+
+    print_set_envcolour(255, 255, 255, 255);
+    for (s32 i = 0; i < count; i++) {
+        RDPBreakdownData *entry = top[i];
+        const BehaviorScript *behavior = (const BehaviorScript *) (entry->key & ~1);
+
+        if (rdp_breakdown_mode == RDP_BREAKDOWN_LAYERS) {
+            sprintf(textBytes, "%s", sRDPBreakdownLayerNames[entry->key >> 1]);
+        } else if (behavior == NULL) {
+            sprintf(textBytes, "No object");
+        } else {
+            char *name = parse_map((u32) virtual_to_segmented(SEGMENT_BEHAVIOR_DATA, behavior));
+            if (name != NULL) {
+                sprintf(textBytes, "%.28s", name);
+            } else {
+                sprintf(textBytes, "0x%08X", (u32) behavior);
+            }
+        }
+        print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+        sprintf(textBytes, "%dus", profiler_rdp_breakdown_get_microseconds(entry, FALSE));
+        print_small_text_light(SCREEN_WIDTH - 72, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        sprintf(textBytes, "%dus", profiler_rdp_breakdown_get_microseconds(entry, TRUE));
+        print_small_text_light(SCREEN_WIDTH - 16, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        y += 12;
+    }
+
+    // Layers and display lists that have not been measured yet, and everything outside of the master lists, are missing.
+    print_set_envcolour(159, 159, 159, 255);
+    sprintf(textBytes, "Measured: %dus of %dus", measured, profiler_get_rdp_microseconds());
+    print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+
+    print_set_envcolour(255, 255, 255, 255);
+    print_small_text_light(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, "Dpad Left/Right: Layers / Objects", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+}
+#endif
+
+#ifdef MEMORY_ALLOC_TRACKER
+#define MEM_TRACKER_BAR_WIDTH (SCREEN_WIDTH - 32)
+
+static u8 sMemTrackerSortByPeak = FALSE;
+
+// Draws the part of a memory bar taken up by the given span of memory.
+static void print_memory_span(s32 y1, s32 y2, uintptr_t start, u32 size, uintptr_t base, u32 range, const ColorRGB colour) {
+    s32 x1 = 16 + (s32) (((f32) (start - base) / range) * MEM_TRACKER_BAR_WIDTH);
+    s32 x2 = 16 + (s32) (((f32) (start + size - base) / range) * MEM_TRACKER_BAR_WIDTH);
+
+    render_blank_box(x1, y1, MAX(x2, x1 + 1), y2, colour[0], colour[1], colour[2], 255);
+}
+
+static void print_memory_tracker(void) {
+    static const char *allocatorNames[MEM_TRACKER_ALLOCATOR_COUNT] = { "Main L", "Main R", "Alloc", "Pool" };
+    static const ColorRGB untrackedColour = { 95, 95, 95 };
+    static const ColorRGB freeColour = { 31, 31, 31 };
+    struct MemTrackerCaller *top[MEM_TRACKER_TOP_COUNT];
+    struct MemTrackerFreeList freeList;
+    char textBytes[64];
+    uintptr_t poolStart = (uintptr_t) sPoolStart;
+    u32 poolSize = sPoolEnd - sPoolStart;
+    s32 count = mem_tracker_get_top(top, MEM_TRACKER_TOP_COUNT, sMemTrackerSortByPeak);
+    s32 y = 8;
+    s32 i;
+
+    prepare_blank_box();
+    render_blank_box(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, 0, 168);
+    finish_blank_box();
+
+    // Main pool, with each tracked allocation coloured by its caller. Untracked memory is grey.
+    print_set_envcolour(255, 255, 159, 255);
+    print_small_text_light(16, y, "Main Pool", PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    sprintf(textBytes, "Used %X / %X  Peak %X", poolSize - main_pool_available(), poolSize, gMemTracker.mainPoolPeakUsed);
+    print_small_text_light(SCREEN_WIDTH - 16, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    y += 12;
+
+    prepare_blank_box();
+    print_memory_span(y, y + 8, poolStart, poolSize, poolStart, poolSize, untrackedColour);
+    print_memory_span(y, y + 8, (uintptr_t) sPoolListHeadL, (uintptr_t) sPoolListHeadR - (uintptr_t) sPoolListHeadL,
+                      poolStart, poolSize, freeColour);
+    for (u32 j = 0; j < gMemTracker.allocsEnd; j++) {
+        struct MemTrackerAlloc *entry = &gMemTracker.allocs[j];
+
+        if (entry->addr != 0 && entry->allocator <= MEM_TRACKER_MAIN_POOL_RIGHT) {
+            print_memory_span(y, y + 8, entry->addr - 16, entry->size, poolStart, poolSize, colourChart[entry->caller % 31]);
+        }
+    }
+    finish_blank_box();
+    y += 14;
+
+    // Memory pools, with their free blocks drawn dark.
+    for (i = 0; i < MEM_TRACKER_NUM_POOLS; i++) {
+        struct MemTrackerPool *pool = &gMemTracker.pools[i];
+        char *name;
+
+        if (pool->pool == NULL) {
+            continue;
+        }
+        mem_tracker_get_free_list(pool->pool, &freeList);
+        name = parse_map(gMemTracker.callers[pool->caller].caller);
+
+        print_set_envcolour(colourChart[pool->caller % 31][0], colourChart[pool->caller % 31][1], colourChart[pool->caller % 31][2], 255);
+        sprintf(textBytes, "%.20s", (name != NULL) ? name : "Pool");
+        print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+        print_set_envcolour(255, 255, 255, 255);
+        sprintf(textBytes, "%X / %X  Peak %X  Frag %d%% (%d)", pool->used, freeList.totalSpace, pool->peakUsed,
+                (freeList.freeBytes != 0) ? 100 - (freeList.largestBlock * 100) / freeList.freeBytes : 0, freeList.numBlocks);
+        print_small_text_light(SCREEN_WIDTH - 16, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        y += 12;
+
+        prepare_blank_box();
+        print_memory_span(y, y + 4, 0, freeList.totalSpace, 0, freeList.totalSpace, colourChart[pool->caller % 31]);
+        for (s32 j = 0; j < freeList.numSpans; j++) {
+            print_memory_span(y, y + 4, freeList.spans[j].offset, freeList.spans[j].size, 0, freeList.totalSpace, freeColour);
+        }
+        finish_blank_box();
+        y += 8;
+    }
+
+    // Callers holding the most memory.
+    y += 4;
+    print_set_envcolour(255, 255, 159, 255);
+    print_small_text_light(16, y, "Caller", PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(144, y, "Kind", PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(216, y, "Live", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(256, y, "Peak", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    print_small_text_light(SCREEN_WIDTH - 16, y, "Life", PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    for (i = 0; i < count && y < SCREEN_HEIGHT - 44; i++) {
+        struct MemTrackerCaller *entry = top[i];
+        u32 index = entry - gMemTracker.callers;
+        char *name = parse_map(entry->caller);
+
+        y += 12;
+        print_set_envcolour(colourChart[index % 31][0], colourChart[index % 31][1], colourChart[index % 31][2], 255);
+        if (name != NULL) {
+            sprintf(textBytes, "%.20s", name);
+        } else {
+            sprintf(textBytes, "0x%08X", (u32) entry->caller);
+        }
+        print_small_text_light(16, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+        print_set_envcolour(255, 255, 255, 255);
+        sprintf(textBytes, "%s x%d", allocatorNames[entry->allocator], entry->liveCount);
+        print_small_text_light(144, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+        sprintf(textBytes, "%X", entry->liveBytes);
+        print_small_text_light(216, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        sprintf(textBytes, "%X", entry->peakBytes);
+        print_small_text_light(256, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+        // Average lifetime of the allocations that have been freed, in seconds.
+        if (entry->frees != 0) {
+            sprintf(textBytes, "%ds", entry->lifetimeFrames / entry->frees / 30);
+        } else {
+            sprintf(textBytes, "-");
+        }
+        print_small_text_light(SCREEN_WIDTH - 16, y, textBytes, PRINT_TEXT_ALIGN_RIGHT, PRINT_ALL, FONT_OUTLINE);
+    }
+
+    if (gMemTracker.untracked != 0) {
+        print_set_envcolour(159, 159, 159, 255);
+        sprintf(textBytes, "Untracked: %d", gMemTracker.untracked);
+        print_small_text_light(16, y + 12, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+    }
+
+    print_set_envcolour(255, 255, 255, 255);
+#ifdef UNF
+    print_small_text_light(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, "Dpad Left/Right: Live / Peak, A: Dump over USB", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#else
+    print_small_text_light(SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, "Dpad Left/Right: Sort by live / peak", PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#endif
+}
+#endif
+
 void render_coverage_map(void) {
     Gfx *tempGfxHead = gDisplayListHead;
 
@@ -1022,8 +1452,12 @@ void puppyprint_render_general_vars(void) {
             (s32)(gMarioState->waterLevel)
             );
         print_small_text_light(16, 36, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
-        sprintf(textBytes, "Gfx Pool: %d / %d", ((u32)gDisplayListHead - ((u32)gGfxPool->buffer)) / 4, GFX_POOL_SIZE);
+        sprintf(textBytes, "Gfx Pool: %d / %d  Peak %d", (u32)(gDisplayListHead - gGfxPool->buffer), gGfxPoolSize, gGfxPoolPeak);
         print_small_text_light(SCREEN_WIDTH/2, SCREEN_HEIGHT-16, textBytes, PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#ifdef FRAME_ARENA_SIZE
+        sprintf(textBytes, "Frame Arena: %d / %d  Peak %d", (u32)(gFrameArena.pos - gFrameArena.start), FRAME_ARENA_SIZE, gFrameArena.peakUsed);
+        print_small_text_light(SCREEN_WIDTH/2, SCREEN_HEIGHT-28, textBytes, PRINT_TEXT_ALIGN_CENTRE, PRINT_ALL, FONT_OUTLINE);
+#endif
     }
 #endif
 }
@@ -1032,10 +1466,25 @@ struct PuppyPrintPage ppPages[] = {
 #ifdef USE_PROFILER
     [PUPPYPRINT_PAGE_PROFILER]      = {&puppyprint_render_standard,     "Profiler"},
     [PUPPYPRINT_PAGE_MINIMAL]       = {&puppyprint_render_minimal,      "Minimal"},
+#endif
+#ifdef BEHAVIOR_PROFILING
+    [PUPPYPRINT_PAGE_BEHAVIORS]     = {&puppyprint_render_behaviors,    "Behaviors"},
+#endif
+#ifdef PC_SAMPLING_PROFILER
+    [PUPPYPRINT_PAGE_PC_SAMPLES]    = {&puppyprint_render_pc_samples,   "Hot Functions"},
+#endif
+#ifdef RDP_BREAKDOWN_PROFILER
+    [PUPPYPRINT_PAGE_RDP_BREAKDOWN] = {&puppyprint_render_rdp_breakdown, "RDP Breakdown"},
 #endif
     [PUPPYPRINT_PAGE_GENERAL]       = {&puppyprint_render_general_vars, "General"},
     [PUPPYPRINT_PAGE_AUDIO]         = {&print_audio_overview,           "Audio"},
+#ifdef AUDIO_HEAP_TELEMETRY
+    [PUPPYPRINT_PAGE_AUDIO_HEAP]    = {&print_audio_heap_overview,      "Audio Heap"},
+#endif
     [PUPPYPRINT_PAGE_RAM]           = {&print_ram_overview,             "Segments"},
+#ifdef MEMORY_ALLOC_TRACKER
+    [PUPPYPRINT_PAGE_MEMORY]        = {&print_memory_tracker,           "Memory"},
+#endif
     [PUPPYPRINT_PAGE_COLLISION]     = {&puppyprint_render_collision,    "Collision"},
     [PUPPYPRINT_PAGE_LOG]           = {&print_console_log,              "Log"},
     [PUPPYPRINT_PAGE_LEVEL_SELECT]  = {&puppyprint_level_select_menu,   "Level Select"},
@@ -1185,6 +1634,39 @@ void puppyprint_profiler_process(void) {
             if (viewCycle == 255)
                 viewCycle = 3;
         }
+#endif
+#ifdef BEHAVIOR_PROFILING
+        if (sPPDebugPage == PUPPYPRINT_PAGE_BEHAVIORS) {
+            if (gPlayer1Controller->buttonPressed & (L_JPAD | R_JPAD)) {
+                sBehaviorSortByCount ^= TRUE;
+            }
+        }
+#endif
+#ifdef RDP_BREAKDOWN_PROFILER
+        if (sPPDebugPage == PUPPYPRINT_PAGE_RDP_BREAKDOWN) {
+            if (gPlayer1Controller->buttonPressed & (L_JPAD | R_JPAD)) {
+                profiler_rdp_breakdown_set_mode((rdp_breakdown_mode == RDP_BREAKDOWN_LAYERS) ? RDP_BREAKDOWN_OBJECTS : RDP_BREAKDOWN_LAYERS);
+            }
+        }
+#endif
+#if defined(PC_SAMPLING_PROFILER) && defined(UNF)
+        if (sPPDebugPage == PUPPYPRINT_PAGE_PC_SAMPLES) {
+            if (gPlayer1Controller->buttonPressed & A_BUTTON) {
+                profiler_pc_sampler_dump();
+            }
+        }
+#endif
+#ifdef MEMORY_ALLOC_TRACKER
+        if (sPPDebugPage == PUPPYPRINT_PAGE_MEMORY) {
+            if (gPlayer1Controller->buttonPressed & (L_JPAD | R_JPAD)) {
+                sMemTrackerSortByPeak ^= TRUE;
+            }
+#ifdef UNF
+            if (gPlayer1Controller->buttonPressed & A_BUTTON) {
+                mem_tracker_dump();
+            }
+#endif
+        }
 #endif
         if (sPPDebugPage == PUPPYPRINT_PAGE_RAM) {
             if (gPlayer1Controller->buttonDown & U_JPAD && gPPSegScroll > 0)  {
@@ -1193,6 +1675,20 @@ void puppyprint_profiler_process(void) {
                 gPPSegScroll += 4;
             }
         }
+#ifdef AUDIO_HEAP_TELEMETRY
+        if (sPPDebugPage == PUPPYPRINT_PAGE_AUDIO_HEAP) {
+            if (gPlayer1Controller->buttonDown & U_JPAD && sAudioHeapScroll > 0) {
+                sAudioHeapScroll -= MIN(sAudioHeapScroll, 4);
+            } else if (gPlayer1Controller->buttonDown & D_JPAD && sAudioHeapScroll < sAudioHeapScrollMax) {
+                sAudioHeapScroll += 4;
+            }
+#ifdef UNF
+            if (gPlayer1Controller->buttonPressed & A_BUTTON) {
+                audio_heap_telemetry_dump();
+            }
+#endif
+        }
+#endif
 #ifdef BETTER_REVERB
         if (sPPDebugPage == PUPPYPRINT_PAGE_BETTER_REVERB)
         {
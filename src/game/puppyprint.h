@@ -87,10 +87,25 @@ enum PPPages {
 #ifdef USE_PROFILER
     PUPPYPRINT_PAGE_PROFILER,
     PUPPYPRINT_PAGE_MINIMAL,
+#endif
+#ifdef BEHAVIOR_PROFILING
+    PUPPYPRINT_PAGE_BEHAVIORS,
+#endif
+#ifdef PC_SAMPLING_PROFILER
+    PUPPYPRINT_PAGE_PC_SAMPLES,
+#endif
+#ifdef RDP_BREAKDOWN_PROFILER
+    PUPPYPRINT_PAGE_RDP_BREAKDOWN,
 #endif
     PUPPYPRINT_PAGE_GENERAL,
     PUPPYPRINT_PAGE_AUDIO,
+#ifdef AUDIO_HEAP_TELEMETRY
+    PUPPYPRINT_PAGE_AUDIO_HEAP,
+#endif
     PUPPYPRINT_PAGE_RAM,
+#ifdef MEMORY_ALLOC_TRACKER
+    PUPPYPRINT_PAGE_MEMORY,
+#endif
     PUPPYPRINT_PAGE_COLLISION,
     PUPPYPRINT_PAGE_LOG,
     PUPPYPRINT_PAGE_LEVEL_SELECT,
@@ -14,10 +14,12 @@
 #include "puppyprint.h"
 #include "debug_box.h"
 #include "level_update.h"
+#include "mario_misc.h"
 #include "behavior_data.h"
 #include "string.h"
 #include "color_presets.h"
 #include "emutest.h"
+#include "frame_budget.h"
 
 #include "config.h"
 #include "config/config_world.h"
@@ -302,8 +304,10 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
                                                      mode2List->modes[currLayer]);
             }
 #endif
-            // Iterate through all the displaylists on the current layer.
-            while (currList != NULL) {
+            profiler_rdp_breakdown_layer_begin(&tempGfxHead, currLayer, currList);
+            // Iterate through all the displaylists on the current layer, leaving the end of the pool for the HUD.
+            while (currList != NULL && GFX_POOL_SPACE_LEFT(tempGfxHead) >= GFX_POOL_RESERVE) {
+                profiler_rdp_breakdown_node_begin(&tempGfxHead, currList);
                 // Add the display list's transformation to the master list.
                 gSPMatrix(tempGfxHead++, VIRTUAL_TO_PHYSICAL(currList->transform),
                           (G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH));
@@ -321,9 +325,11 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
                 // Add the current display list to the master list.
                 gSPDisplayList(tempGfxHead++, currList->displayList);
 #endif
+                profiler_rdp_breakdown_node_end(&tempGfxHead);
                 // Move to the next DisplayListNode.
                 currList = currList->next;
             }
+            profiler_rdp_breakdown_layer_end(&tempGfxHead);
         }
     }
 
@@ -348,6 +354,13 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
  * render modes of layers.
  */
 void geo_append_display_list(void *displayList, s32 layer) {
+    s32 spaceLeft = GFX_POOL_SPACE_LEFT(gDisplayListHead);
+
+    // When the graphics pool is nearly full, drop the transparent layers first, then everything.
+    if (gMatStackFixed[gMatStackIndex] == NULL || spaceLeft < GFX_POOL_RESERVE
+        || (spaceLeft < (GFX_POOL_RESERVE * 2) && layer >= LAYER_TRANSPARENT_DECAL)) {
+        return;
+    }
 #ifdef F3DEX_GBI_2
     gSPLookAt(gDisplayListHead++, gCurLookAt);
 #endif
@@ -374,6 +387,11 @@ void geo_append_display_list(void *displayList, s32 layer) {
         listNode->transform = gMatStackFixed[gMatStackIndex];
         listNode->displayList = displayList;
         listNode->next = NULL;
+#ifdef RDP_BREAKDOWN_PROFILER
+        // gMirrorMario is a bare GraphNodeObject, not the header of an Object
+        listNode->behavior = (gCurGraphNodeObject != NULL && gCurGraphNodeObject != &gMirrorMario)
+                             ? ((struct Object *) gCurGraphNodeObject)->behavior : NULL;
+#endif
         if (gCurGraphNodeMasterList->listHeads[layer] == NULL) {
             gCurGraphNodeMasterList->listHeads[layer] = listNode;
         } else {
@@ -386,7 +404,10 @@ void geo_append_display_list(void *displayList, s32 layer) {
 static void inc_mat_stack() {
     Mtx *mtx = alloc_display_list(sizeof(*mtx));
     gMatStackIndex++;
-    mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+    // Out of graphics pool: geo_append_display_list skips anything drawn with a NULL matrix.
+    if (mtx != NULL) {
+        mtxf_to_mtx(mtx, gMatStack[gMatStackIndex]);
+    }
     gMatStackFixed[gMatStackIndex] = mtx;
 }
 
@@ -423,6 +444,10 @@ void geo_process_master_list(struct GraphNodeMasterList *node) {
  void geo_process_ortho_projection(struct GraphNodeOrthoProjection *node) {
     if (node->node.children != NULL) {
         Mtx *mtx = alloc_display_list(sizeof(*mtx));
+        // Out of graphics pool: skip everything drawn with this projection.
+        if (mtx == NULL) {
+            return;
+        }
         f32 scale = node->scale / 2.0f;
         f32 left = (gCurGraphNodeRoot->x - gCurGraphNodeRoot->width) * scale;
         f32 right = (gCurGraphNodeRoot->x + gCurGraphNodeRoot->width) * scale;
@@ -447,6 +472,9 @@ void geo_process_perspective(struct GraphNodePerspective *node) {
     if (node->fnNode.node.children != NULL) {
         u16 perspNorm;
         Mtx *mtx = alloc_display_list(sizeof(*mtx));
+        if (mtx == NULL) {
+            return;
+        }
 #ifdef WIDE
         if (gConfig.widescreen && gCurrLevelNum != 0x01){
             sAspectRatio = 16.0f / 9.0f; // 1.775f
@@ -500,6 +528,28 @@ void geo_process_level_of_detail(struct GraphNodeLevelOfDetail *node) {
 #else
     f32 distanceFromCam = get_dist_from_camera(gMatStack[gMatStackIndex][3]);
 #endif
+#ifdef FRAME_BUDGET_GOVERNOR
+    f32 scaledDistance = frame_budget_lod_distance(distanceFromCam);
+
+    if (scaledDistance > distanceFromCam) {
+        // Don't push an object that is in range past the furthest level of detail of this node and its siblings,
+        // so it switches to its lowest detail instead of disappearing.
+        struct GraphNode *sibling = &node->node;
+        s16 furthestDistance = node->maxDistance;
+
+        do {
+            if (sibling->type == GRAPH_NODE_TYPE_LEVEL_OF_DETAIL) {
+                furthestDistance = MAX(furthestDistance, ((struct GraphNodeLevelOfDetail *) sibling)->maxDistance);
+            }
+        } while ((sibling = sibling->next) != &node->node);
+
+        if (distanceFromCam < (f32)furthestDistance) {
+            distanceFromCam = MIN(scaledDistance, (f32)(furthestDistance - 1));
+        }
+    } else {
+        distanceFromCam = scaledDistance;
+    }
+#endif
 
     if ((f32)node->minDistance <= distanceFromCam
         && distanceFromCam < (f32)node->maxDistance
@@ -538,6 +588,10 @@ Vec3f globalLightDirection = { 0x28, 0x28, 0x28 };
 
 void setup_global_light() {
     Lights1* curLight = (Lights1*)alloc_display_list(sizeof(Lights1));
+    // Out of graphics pool: keep the lights that are already loaded.
+    if (curLight == NULL) {
+        return;
+    }
     bcopy(&defaultLight, curLight, sizeof(Lights1));
 
 #ifdef WORLDSPACE_LIGHTING
@@ -565,6 +619,10 @@ void geo_process_camera(struct GraphNodeCamera *node) {
     if (node->fnNode.func != NULL) {
         node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node, gMatStack[gMatStackIndex]);
     }
+    // Out of graphics pool: the camera still updates above, but nothing is drawn through it.
+    if (rollMtx == NULL || viewMtx == NULL) {
+        return;
+    }
     mtxf_rotate_xy(rollMtx, node->rollScreen);
 
     gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(rollMtx), G_MTX_PROJECTION | G_MTX_MUL | G_MTX_NOPUSH);
@@ -746,16 +804,19 @@ void geo_process_background(struct GraphNodeBackground *node) {
 #endif
         Gfx *gfx = gfxStart;
 
-        gDPPipeSync(gfx++);
-        gDPSetCycleType(gfx++, G_CYC_FILL);
-        gDPSetFillColor(gfx++, node->background);
-        gDPFillRectangle(gfx++, GFX_DIMENSIONS_RECT_FROM_LEFT_EDGE(0), gBorderHeight,
-        GFX_DIMENSIONS_RECT_FROM_RIGHT_EDGE(0) - 1, SCREEN_HEIGHT - gBorderHeight - 1);
-        gDPPipeSync(gfx++);
-        gDPSetCycleType(gfx++, G_CYC_1CYCLE);
-        gSPEndDisplayList(gfx++);
-
-        geo_append_display_list((void *) VIRTUAL_TO_PHYSICAL(gfxStart), LAYER_FORCE);
+        // Out of graphics pool: leave the background undrawn.
+        if (gfxStart != NULL) {
+            gDPPipeSync(gfx++);
+            gDPSetCycleType(gfx++, G_CYC_FILL);
+            gDPSetFillColor(gfx++, node->background);
+            gDPFillRectangle(gfx++, GFX_DIMENSIONS_RECT_FROM_LEFT_EDGE(0), gBorderHeight,
+            GFX_DIMENSIONS_RECT_FROM_RIGHT_EDGE(0) - 1, SCREEN_HEIGHT - gBorderHeight - 1);
+            gDPPipeSync(gfx++);
+            gDPSetCycleType(gfx++, G_CYC_1CYCLE);
+            gSPEndDisplayList(gfx++);
+
+            geo_append_display_list((void *) VIRTUAL_TO_PHYSICAL(gfxStart), LAYER_FORCE);
+        }
     }
     if (node->fnNode.node.children != NULL) {
         geo_process_node_and_siblings(node->fnNode.node.children);
@@ -855,7 +916,7 @@ void geo_set_animation_globals(struct AnimInfo *node, s32 hasAnimation) {
  */
 void geo_process_shadow(struct GraphNodeShadow *node) {
 #ifndef DISABLE_SHADOWS
-    if (gCurGraphNodeCamera != NULL && gCurGraphNodeObject != NULL) {
+    if (gCurGraphNodeCamera != NULL && gCurGraphNodeObject != NULL && frame_budget_shadow_in_range(gCurGraphNodeObject)) {
         Vec3f shadowPos;
         f32 shadowScale;
 
@@ -1068,7 +1129,7 @@ void geo_process_object(struct Object *node) {
             geo_set_animation_globals(&node->header.gfx.animInfo, (node->header.gfx.node.flags & GRAPH_RENDER_HAS_ANIMATION) != 0);
         }
 
-        if (!isInvisible && obj_is_in_view(&node->header.gfx)) {
+        if (!isInvisible && obj_is_in_view(&node->header.gfx) && frame_budget_object_in_range(node)) {
             gMatStackIndex--;
             inc_mat_stack();
 
@@ -1242,12 +1303,15 @@ void geo_process_node_and_siblings(struct GraphNode *firstNode) {
  */
 void geo_process_root(struct GraphNodeRoot *node, Vp *b, Vp *c, s32 clearColor) {
     if (node->node.flags & GRAPH_RENDER_ACTIVE) {
-        Mtx *initialMatrix;
         Vp *viewport = alloc_display_list(sizeof(*viewport));
+        Mtx *initialMatrix = alloc_display_list(sizeof(*initialMatrix));
 
-        gDisplayListHeap = alloc_only_pool_init(main_pool_available() - sizeof(struct AllocOnlyPool), MEMORY_POOL_LEFT);
-        initialMatrix = alloc_display_list(sizeof(*initialMatrix));
         gCurLookAt = (LookAt*)alloc_display_list(sizeof(LookAt));
+        // Out of graphics pool: skip the whole scene.
+        if (viewport == NULL || initialMatrix == NULL || gCurLookAt == NULL) {
+            return;
+        }
+        gDisplayListHeap = alloc_only_pool_init(main_pool_available() - sizeof(struct AllocOnlyPool), MEMORY_POOL_LEFT);
         bzero(gCurLookAt, sizeof(LookAt));
 
         gMatStackIndex = 0;
@@ -224,6 +224,9 @@ void draw_skybox_tile_grid(Gfx **dlist, s8 background, s8 player, s8 colorIndex)
             const Texture *const texture =
                 (*(SkyboxTexture *) segmented_to_virtual(sSkyboxTextures[background]))[tileIndex];
             Vtx *vertices = make_skybox_rect(tileIndex, colorIndex);
+            if (vertices == NULL) {
+                continue;
+            }
 
             gLoadBlockTexture((*dlist)++, 32, 32, G_IM_FMT_RGBA, texture);
             gSPVertex((*dlist)++, VIRTUAL_TO_PHYSICAL(vertices), 4, 0);
@@ -268,6 +271,9 @@ Gfx *init_skybox_display_list(s8 player, s8 background, s8 colorIndex) {
         return NULL;
     } else {
         Mtx *ortho = create_skybox_ortho_matrix(player);
+        if (ortho == NULL) {
+            return NULL;
+        }
 
         gSPDisplayList(dlist++, dl_skybox_begin);
         gSPMatrix(dlist++, VIRTUAL_TO_PHYSICAL(ortho), G_MTX_PROJECTION | G_MTX_MUL | G_MTX_NOPUSH);
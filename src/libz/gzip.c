@@ -72,3 +72,64 @@ expand_gzip(char *in, char *outbuf, unsigned int inLength, unsigned int outbufLe
     return d_stream.total_out;
 
 }
+
+/*
+ * When inflating a piece at a time, inflate needs a window to look back into
+ * the output of earlier calls. It's too big for gzip_mem, so the caller gives it.
+ */
+static void *stream_alloc(voidpf opaque, unsigned int nItems, unsigned int size)
+{
+    if (nItems * size == (1U << MAX_WBITS)) {
+        return opaque;
+    }
+    return myalloc(opaque, nItems, size);
+}
+
+/*
+ * Same as expand_gzip, but the input is given a piece at a time by fill,
+ * which returns the next piece and its length, or a length of 0 at the end.
+ * window must have room for 1 << MAX_WBITS bytes.
+ * Returns -ve value for error, or number of output bytes for success
+ */
+int
+expand_gzip_stream(unsigned char *(*fill)(void *arg, unsigned int *length), void *arg, void *window, char *outbuf, unsigned int outbufLength)
+{
+    int err;
+    z_stream d_stream; /* decompression stream */
+
+    d_stream.zalloc = (alloc_func) stream_alloc;
+    d_stream.zfree = (free_func) myfree;
+    d_stream.opaque = (voidpf) window;
+
+    d_stream.next_in  = Z_NULL;
+    d_stream.avail_in = 0;
+    d_stream.next_out = outbuf;
+    d_stream.avail_out = outbufLength;
+
+    err = inflateInit2(&d_stream, -MAX_WBITS);
+    if (err != Z_OK) {
+        return err;
+    }
+
+    do {
+        if (d_stream.avail_in == 0) {
+            d_stream.next_in = fill(arg, &d_stream.avail_in);
+            if (d_stream.avail_in == 0) {
+                break;
+            }
+        }
+        err = inflate(&d_stream, Z_NO_FLUSH);
+    } while (err == Z_OK);
+
+    if (err != Z_STREAM_END) {
+        inflateEnd(&d_stream);
+        return (err < 0) ? err : Z_DATA_ERROR;
+    }
+
+    err = inflateEnd(&d_stream);
+    if (err != Z_OK) {
+        return err;
+    }
+
+    return d_stream.total_out;
+}
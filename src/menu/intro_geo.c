@@ -52,6 +52,9 @@ Gfx *geo_intro_super_mario_64_logo(s32 callContext, struct GraphNode *node, UNUS
         SET_GRAPH_NODE_LAYER(graphNode->flags, LAYER_OPAQUE);
         Mtx *scaleMat = alloc_display_list(sizeof(*scaleMat));
         dl = alloc_display_list(4 * sizeof(*dl));
+        if (scaleMat == NULL || dl == NULL) {
+            return NULL;
+        }
         dlIter = dl;
         Vec3f scale;
 
@@ -93,6 +96,9 @@ Gfx *geo_intro_tm_copyright(s32 callContext, struct GraphNode *node, UNUSED void
         sTmCopyrightAlpha = 0;
     } else if (callContext == GEO_CONTEXT_RENDER) { // draw
         dl = alloc_display_list(5 * sizeof(*dl));
+        if (dl == NULL) {
+            return NULL;
+        }
         dlIter = dl;
         gSPDisplayList(dlIter++, dl_proj_mtx_fullscreen);
         gDPSetEnvColor(dlIter++, 255, 255, 255, sTmCopyrightAlpha);
@@ -155,6 +161,9 @@ static Gfx *intro_backdrop_one_image(s32 index, s8 *backgroundTable) {
     const Texture *const *vIntroBgTable = segmented_to_virtual(textureTables[backgroundTable[index]]);
     s32 i;
 
+    if (mtx == NULL || displayList == NULL) {
+        return NULL;
+    }
     guTranslate(mtx, xCoords[index], yCoords[index], 0.0f);
     gSPMatrix(displayListIter++, mtx, G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_PUSH);
     gSPDisplayList(displayListIter++, &title_screen_bg_dl_0A000118);
@@ -191,12 +200,18 @@ Gfx *geo_intro_regular_backdrop(s32 callContext, struct GraphNode *node, UNUSED
 
     if (callContext == GEO_CONTEXT_RENDER) {  // draw
         dl = alloc_display_list(16 * sizeof(*dl));
+        if (dl == NULL) {
+            return NULL;
+        }
         dlIter = dl;
         SET_GRAPH_NODE_LAYER(graphNode->node.flags, LAYER_OPAQUE);
         gSPDisplayList(dlIter++, &dl_proj_mtx_fullscreen);
         gSPDisplayList(dlIter++, &title_screen_bg_dl_start);
         for (i = 0; i < 12; ++i) {
-            gSPDisplayList(dlIter++, intro_backdrop_one_image(i, backgroundTable));
+            Gfx *tile = intro_backdrop_one_image(i, backgroundTable);
+            if (tile != NULL) {
+                gSPDisplayList(dlIter++, tile);
+            }
         }
         gSPDisplayList(dlIter++, &title_screen_bg_dl_end);
         gSPEndDisplayList(dlIter);
@@ -250,12 +265,18 @@ Gfx *geo_intro_gameover_backdrop(s32 callContext, struct GraphNode *node, UNUSED
             sGameOverFrameCounter++;
         }
         SET_GRAPH_NODE_LAYER(graphNode->flags, LAYER_OPAQUE);
+        if (dl == NULL) {
+            return NULL;
+        }
 
         // draw all the tiles
         gSPDisplayList(dlIter++, &dl_proj_mtx_fullscreen);
         gSPDisplayList(dlIter++, &title_screen_bg_dl_start);
         for (j = 0; j < ARRAY_COUNT(gameOverBackgroundTable); ++j) {
-            gSPDisplayList(dlIter++, intro_backdrop_one_image(j, gameOverBackgroundTable));
+            Gfx *tile = intro_backdrop_one_image(j, gameOverBackgroundTable);
+            if (tile != NULL) {
+                gSPDisplayList(dlIter++, tile);
+            }
         }
         gSPDisplayList(dlIter++, &title_screen_bg_dl_end);
         gSPEndDisplayList(dlIter);
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# Runs a conversion step through a content-addressed cache, used when building with ASSET_CACHE set.
+#
+# usage: asset_cache.py cachedir output input... -- command...
+#        asset_cache.py cachedir --batch manifest -- command...
+#
+# The output is stored under a hash of the command line, the contents of the inputs, and the
+# contents of any file the command names other than the output (the tool itself, for example).
+# If the hash is already in the cache the output is copied out of it instead of running the command,
+# so outputs survive make clean, switching branches and switching compression modes.
+#
+# A command given as a single argument is run through the shell, so it can use pipes and redirects.
+#
+# In batch mode each line of the manifest is "output input... -- arguments...", and is looked up as if
+# it were "command[0] arguments..." run on its own, so it shares cache entries with single conversions.
+# The arguments of the lines that miss are written to a new manifest, the command is run once with its
+# path appended (n64graphics -b, for example), and the outputs are stored.
+#
+# The cache is never pruned; delete the directory to empty it.
+
+import sys, os, hashlib, shutil, subprocess, tempfile
+
+CACHE_VERSION = b"1"
+
+def usage():
+	print("usage: asset_cache.py cachedir output input... -- command...", file=sys.stderr)
+	print("       asset_cache.py cachedir --batch manifest -- command...", file=sys.stderr)
+	sys.exit(1)
+
+def hash_file(h, path):
+	with open(path, "rb") as f:
+		for block in iter(lambda: f.read(1 << 16), b""):
+			h.update(block)
+
+def cache_path(output, inputs, command, shell):
+	h = hashlib.sha256(CACHE_VERSION)
+	for arg in command:
+		h.update(b"\0" + arg.encode())
+	for path in inputs:
+		h.update(b"\0in\0" + path.encode() + b"\0")
+		hash_file(h, path)
+	words = command[0].split() if shell else command
+	for word in words:
+		if word != output and word not in inputs and os.path.isfile(word):
+			h.update(b"\0file\0" + word.encode() + b"\0")
+			hash_file(h, word)
+
+	key = h.hexdigest()
+	return os.path.join(cache_dir, key[:2], key)
+
+def store(output, cached):
+	# Write under a temporary name first, so parallel builds sharing the cache never see half a file.
+	os.makedirs(os.path.dirname(cached), exist_ok=True)
+	fd, temp = tempfile.mkstemp(dir=os.path.dirname(cached))
+	os.close(fd)
+	shutil.copyfile(output, temp)
+	os.replace(temp, cached)
+
+def run_single(output, inputs, command):
+	shell = len(command) == 1
+	cached = cache_path(output, inputs, command, shell)
+
+	if os.path.isfile(cached):
+		shutil.copyfile(cached, output)
+		return 0
+
+	result = subprocess.call(command[0] if shell else command, shell=shell)
+	if result != 0:
+		return result
+	store(output, cached)
+	return 0
+
+def run_batch(manifest, command):
+	misses = []
+	with open(manifest) as f:
+		for line_num, line in enumerate(f, 1):
+			words = line.split()
+			if not words or words[0].startswith("#"):
+				continue
+			if "--" not in words or words.index("--") < 1:
+				print("asset_cache.py: bad line %d in %s" % (line_num, manifest), file=sys.stderr)
+				return 1
+			split = words.index("--")
+			output = words[0]
+			inputs = words[1:split]
+			args = words[split + 1:]
+			cached = cache_path(output, inputs, command[:1] + args, False)
+
+			if os.path.isfile(cached):
+				shutil.copyfile(cached, output)
+			else:
+				misses.append((output, cached, args))
+
+	if not misses:
+		return 0
+
+	fd, pending = tempfile.mkstemp(suffix=".manifest")
+	with os.fdopen(fd, "w") as f:
+		for output, cached, args in misses:
+			f.write(" ".join(args) + "\n")
+	try:
+		result = subprocess.call(command + [pending])
+	finally:
+		os.remove(pending)
+	if result != 0:
+		return result
+
+	for output, cached, args in misses:
+		store(output, cached)
+	return 0
+
+if "--" not in sys.argv or sys.argv.index("--") < 3 or sys.argv.index("--") == len(sys.argv) - 1:
+	usage()
+
+split = sys.argv.index("--")
+cache_dir = sys.argv[1]
+command = sys.argv[split + 1:]
+
+if sys.argv[2] == "--batch":
+	if split != 4:
+		usage()
+	sys.exit(run_batch(sys.argv[3], command))
+sys.exit(run_single(sys.argv[2], sys.argv[3:split], command))
@@ -0,0 +1,281 @@
+/**
+ * Offline audio renderer.
+ *
+ * Runs the game's sequence player, note playback and synthesis code natively, executes the
+ * resulting audio command lists with a software implementation of the audio microcode and
+ * writes the output to a WAV file. The CPU time spent in synthesis_execute (sequence processing
+ * plus command list generation) and in the software microcode is measured for every audio frame.
+ *
+ * See the Makefile in this directory for how to build it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ultra64.h>
+
+#include "config.h"
+#include "audio/data.h"
+#include "audio/external.h"
+#include "audio/heap.h"
+#include "audio/internal.h"
+#include "audio/load.h"
+#include "audio/synthesis.h"
+#include "game/emutest.h"
+#include "rsp_audio.h"
+
+// Matches create_next_audio_frame_task in src/audio/external.c.
+#define SAMPLES_TO_OVERPRODUCE 0x10
+#define EXTRA_BUFFERED_AI_SAMPLES_TARGET 0x40
+
+extern struct Config gConfig;
+extern u16 gSequenceCount;
+extern s32 gMaxAudioCmds;
+extern s32 gVerbose;
+
+struct FrameTimes {
+    u64 *synthesisNs;
+    u64 *rspNs;
+};
+
+static void usage(const char *progName) {
+    fprintf(stderr,
+            "Usage: %s -s <sequence id> [options]\n"
+            "\n"
+            "Options:\n"
+            "    -s <id>       Sequence to play (decimal or 0x hex)\n"
+            "    -o <file>     Output WAV file (default: out.wav, '-' for none)\n"
+            "    -t <seconds>  Length to render (default: 30)\n"
+            "    -p <id>       Audio session preset passed to audio_reset_session (default: 0)\n"
+#ifdef BETTER_REVERB
+            "    -r <id>       BETTER_REVERB preset (default: 0)\n"
+#endif
+            "    -c            Use the console note limit instead of the emulator one\n"
+            "    -v            Print audio driver messages\n",
+            progName);
+    exit(1);
+}
+
+static u64 time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void write_u16_le(FILE *f, u16 v) {
+    fputc(v & 0xFF, f);
+    fputc(v >> 8, f);
+}
+
+static void write_u32_le(FILE *f, u32 v) {
+    write_u16_le(f, v & 0xFFFF);
+    write_u16_le(f, v >> 16);
+}
+
+static void write_wav_header(FILE *f, u32 frequency, u32 numSamples) {
+    u32 dataSize = numSamples * 2 * sizeof(s16);
+
+    fwrite("RIFF", 1, 4, f);
+    write_u32_le(f, 36 + dataSize);
+    fwrite("WAVEfmt ", 1, 8, f);
+    write_u32_le(f, 16);
+    write_u16_le(f, 1); // PCM
+    write_u16_le(f, 2); // Stereo
+    write_u32_le(f, frequency);
+    write_u32_le(f, frequency * 2 * sizeof(s16));
+    write_u16_le(f, 2 * sizeof(s16));
+    write_u16_le(f, 16);
+    fwrite("data", 1, 4, f);
+    write_u32_le(f, dataSize);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    u64 x = *(const u64 *) a;
+    u64 y = *(const u64 *) b;
+
+    return (x > y) - (x < y);
+}
+
+static void print_time_stats(const char *name, u64 *times, s32 numFrames) {
+    u64 total = 0;
+    s32 i;
+
+    for (i = 0; i < numFrames; i++) {
+        total += times[i];
+    }
+    qsort(times, numFrames, sizeof(u64), compare_u64);
+    printf("%-10s avg %8.2f us  p50 %8.2f us  p99 %8.2f us  max %8.2f us  (per update avg %7.2f us)\n", name,
+           total / 1000.0 / numFrames, times[numFrames / 2] / 1000.0, times[numFrames * 99 / 100] / 1000.0,
+           times[numFrames - 1] / 1000.0, total / 1000.0 / numFrames / gAudioUpdatesPerFrame);
+}
+
+static s32 count_active_notes(void) {
+    s32 count = 0;
+    s32 i;
+
+    for (i = 0; i < gMaxSimultaneousNotes; i++) {
+        if (gNotes[i].enabled) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int main(int argc, char **argv) {
+    const char *outPath = "out.wav";
+    s32 seqId = -1;
+    s32 sessionPreset = 0;
+    f32 seconds = 30.0f;
+    s32 useConsoleLimits = FALSE;
+    struct FrameTimes times;
+    FILE *out = NULL;
+    s32 aiSamplesQueued = 0;
+    u32 numSamplesWritten = 0;
+    u32 maxCmds = 0;
+    u64 totalActiveNotes = 0;
+    u32 peakActiveNotes = 0;
+    s32 numFrames;
+    s32 frame;
+    s32 opt;
+
+    while ((opt = getopt(argc, argv, "s:o:t:p:r:cv")) != -1) {
+        switch (opt) {
+            case 's':
+                seqId = strtol(optarg, NULL, 0);
+                break;
+            case 'o':
+                outPath = optarg;
+                break;
+            case 't':
+                seconds = strtof(optarg, NULL);
+                break;
+            case 'p':
+                sessionPreset = strtol(optarg, NULL, 0);
+                break;
+#ifdef BETTER_REVERB
+            case 'r':
+                gBetterReverbPresetValue = strtol(optarg, NULL, 0);
+                break;
+#endif
+            case 'c':
+                useConsoleLimits = TRUE;
+                break;
+            case 'v':
+                gVerbose = TRUE;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (seqId < 0 || seconds <= 0.0f) {
+        usage(argv[0]);
+    }
+
+    gConfig.audioFrequency = 1.0f;
+    gEmulator = useConsoleLimits ? EMU_CONSOLE : EMU_PARALLELN64;
+
+    audio_init();
+    if (seqId >= gSequenceCount) {
+        fprintf(stderr, "Sequence 0x%X does not exist (%d sequences)\n", seqId, gSequenceCount);
+        return 1;
+    }
+
+    // There is no audio thread to wait for here, so skip the frame wait in audio_reset_session.
+    gEmulator |= EMU_WIIVC;
+    audio_reset_session(sessionPreset);
+    gEmulator &= ~EMU_WIIVC;
+
+    load_sequence(SEQ_PLAYER_LEVEL, seqId, FALSE);
+
+    numFrames = (s32) (seconds * 60.0f);
+    times.synthesisNs = calloc(numFrames, sizeof(u64));
+    times.rspNs = calloc(numFrames, sizeof(u64));
+
+    if (strcmp(outPath, "-") != 0) {
+        out = fopen(outPath, "wb");
+        if (out == NULL) {
+            perror(outPath);
+            return 1;
+        }
+        write_wav_header(out, gAiFrequency, 0);
+    }
+
+    for (frame = 0; frame < numFrames; frame++) {
+        s16 *aiBuf;
+        s32 aiBufLen;
+        s32 writtenCmds;
+        u32 activeNotes;
+        s32 samplesPerVi = gAiFrequency / 60;
+        u64 start;
+
+        gAudioFrameCount++;
+        gCurrAudioFrameDmaCount = 0;
+        gCurrAiBufferIndex = (gCurrAiBufferIndex + 1) % NUMAIBUFFERS;
+
+        // Model the audio interface draining one video frame's worth of samples, so buffer
+        // lengths vary the same way as on hardware.
+        aiSamplesQueued = (aiSamplesQueued > samplesPerVi) ? aiSamplesQueued - samplesPerVi : 0;
+        aiBufLen = ((gSamplesPerFrameTarget - aiSamplesQueued + EXTRA_BUFFERED_AI_SAMPLES_TARGET) & ~0xF)
+                   + SAMPLES_TO_OVERPRODUCE;
+        if (aiBufLen < gMinAiBufferLength) {
+            aiBufLen = gMinAiBufferLength;
+        }
+        if (aiBufLen > gSamplesPerFrameTarget + SAMPLES_TO_OVERPRODUCE) {
+            aiBufLen = gSamplesPerFrameTarget + SAMPLES_TO_OVERPRODUCE;
+        }
+        aiSamplesQueued += aiBufLen;
+        aiBuf = gAiBuffers[gCurrAiBufferIndex];
+
+        start = time_ns();
+        synthesis_execute(gAudioCmdBuffers[0], &writtenCmds, aiBuf, aiBufLen);
+        times.synthesisNs[frame] = time_ns() - start;
+
+        if (writtenCmds > gMaxAudioCmds) {
+            fprintf(stderr, "Frame %d: command list overflow (%d > %d commands)\n", frame, writtenCmds, gMaxAudioCmds);
+            return 1;
+        }
+
+        start = time_ns();
+        rsp_audio_execute((Acmd *) gAudioCmdBuffers[0], writtenCmds);
+        times.rspNs[frame] = time_ns() - start;
+
+        activeNotes = count_active_notes();
+        totalActiveNotes += activeNotes;
+        if (activeNotes > peakActiveNotes) {
+            peakActiveNotes = activeNotes;
+        }
+        if ((u32) writtenCmds > maxCmds) {
+            maxCmds = writtenCmds;
+        }
+
+        decrease_sample_dma_ttls();
+
+        if (out != NULL) {
+            fwrite(aiBuf, sizeof(s16), aiBufLen * 2, out);
+            numSamplesWritten += aiBufLen;
+        }
+    }
+
+    if (out != NULL) {
+        fseek(out, 0, SEEK_SET);
+        write_wav_header(out, gAiFrequency, numSamplesWritten);
+        fclose(out);
+    }
+
+    printf("Sequence 0x%02X: %d frames at %d Hz, %d updates per frame, %d notes max\n", seqId, numFrames,
+           gAiFrequency, gAudioUpdatesPerFrame, gMaxSimultaneousNotes);
+    printf("Notes:     avg %.2f active, peak %u\n", (f64) totalActiveNotes / numFrames, peakActiveNotes);
+    printf("Commands:  peak %u of %d\n", maxCmds, gMaxAudioCmds);
+    print_time_stats("Synthesis", times.synthesisNs, numFrames);
+    print_time_stats("RSP", times.rspNs, numFrames);
+    if (gAudioErrorFlags != 0) {
+        printf("Audio error flags: 0x%08X\n", gAudioErrorFlags);
+    }
+
+    free(times.synthesisNs);
+    free(times.rspNs);
+    return 0;
+}
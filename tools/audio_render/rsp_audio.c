@@ -0,0 +1,502 @@
+/**
+ * Software implementation of the audio microcode (aspMain) commands used by src/audio/synthesis.c.
+ * DMEM is modelled as a flat 4 KiB buffer and DRAM addresses in the command list are host pointers.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rsp_audio.h"
+#include "audio/synthesis.h"
+
+#define DMEM_SIZE 0x1000
+
+#define ROUND_UP_32(v) (((v) + 31) & ~31)
+#define ROUND_UP_16(v) (((v) + 15) & ~15)
+#define ROUND_UP_8(v)  (((v) +  7) &  ~7)
+
+static struct {
+    u16 in;
+    u16 out;
+    u16 nbytes;
+
+    u16 dryRight;
+    u16 wetLeft;
+    u16 wetRight;
+
+    s16 vol[2];
+    s16 target[2];
+    s32 rate[2];
+    s16 volDry;
+    s16 volWet;
+
+    s16 *adpcmLoopState;
+    s16 adpcmTable[8][2][8];
+
+    union {
+        s16 as_s16[DMEM_SIZE / sizeof(s16)];
+        u8 as_u8[DMEM_SIZE];
+    } dmem;
+} sRsp;
+
+// Interpolation coefficients used by the resampler, indexed by the top 6 bits of the
+// fractional sample position. The second half of the table mirrors the first.
+static const s16 sResampleTableHalf[32][4] = {
+    { 0x0c39, 0x66ad, 0x0d46, 0xffdf }, { 0x0b39, 0x6696, 0x0e5f, 0xffd8 },
+    { 0x0a44, 0x6669, 0x0f83, 0xffd0 }, { 0x095a, 0x6626, 0x10b4, 0xffc8 },
+    { 0x087d, 0x65cd, 0x11f0, 0xffbf }, { 0x07ab, 0x655e, 0x1338, 0xffb6 },
+    { 0x06e4, 0x64d9, 0x148c, 0xffac }, { 0x0628, 0x643f, 0x15eb, 0xffa1 },
+    { 0x0577, 0x638f, 0x1756, 0xff96 }, { 0x04d1, 0x62cb, 0x18cb, 0xff8a },
+    { 0x0435, 0x61f3, 0x1a4c, 0xff7e }, { 0x03a4, 0x6106, 0x1bd7, 0xff71 },
+    { 0x031c, 0x6007, 0x1d6c, 0xff64 }, { 0x029f, 0x5ef5, 0x1f0b, 0xff56 },
+    { 0x022a, 0x5dd0, 0x20b3, 0xff48 }, { 0x01be, 0x5c9a, 0x2264, 0xff3a },
+    { 0x015b, 0x5b53, 0x241e, 0xff2c }, { 0x0101, 0x59fc, 0x25e0, 0xff1e },
+    { 0x00ae, 0x5896, 0x27a9, 0xff10 }, { 0x0063, 0x5720, 0x297a, 0xff02 },
+    { 0x001f, 0x559d, 0x2b50, 0xfef4 }, { 0xffe2, 0x540d, 0x2d2c, 0xfee8 },
+    { 0xffac, 0x5270, 0x2f0d, 0xfedb }, { 0xff7c, 0x50c7, 0x30f3, 0xfed0 },
+    { 0xff53, 0x4f14, 0x32dc, 0xfec6 }, { 0xff2e, 0x4d57, 0x34c8, 0xfebd },
+    { 0xff0f, 0x4b91, 0x36b6, 0xfeb6 }, { 0xfef5, 0x49c2, 0x38a5, 0xfeb0 },
+    { 0xfedf, 0x47ed, 0x3a95, 0xfeac }, { 0xfece, 0x4611, 0x3c85, 0xfeab },
+    { 0xfec0, 0x4430, 0x3e74, 0xfeac }, { 0xfeb6, 0x424a, 0x4060, 0xfeaf },
+};
+
+static s16 sResampleTable[64][4];
+
+static s16 clamp16(s32 v) {
+    if (v < -0x8000) {
+        return -0x8000;
+    } else if (v > 0x7FFF) {
+        return 0x7FFF;
+    }
+    return (s16) v;
+}
+
+static s32 clamp32(s64 v) {
+    if (v < -0x7FFFFFFF - 1) {
+        return -0x7FFFFFFF - 1;
+    } else if (v > 0x7FFFFFFF) {
+        return 0x7FFFFFFF;
+    }
+    return (s32) v;
+}
+
+static void *dmem_ptr(u32 addr, u32 size) {
+    if (addr + size > DMEM_SIZE) {
+        fprintf(stderr, "rsp_audio: DMEM access out of range (0x%X, 0x%X bytes)\n", addr, size);
+        exit(1);
+    }
+    return &sRsp.dmem.as_u8[addr];
+}
+
+static void init_resample_table(void) {
+    s32 i, j;
+
+    for (i = 0; i < 32; i++) {
+        for (j = 0; j < 4; j++) {
+            sResampleTable[i][j] = sResampleTableHalf[i][j];
+            sResampleTable[63 - i][j] = sResampleTableHalf[i][3 - j];
+        }
+    }
+}
+
+static void a_set_buffer(u8 flags, u16 in, u16 out, u16 nbytes) {
+    if (flags & A_AUX) {
+        sRsp.dryRight = in;
+        sRsp.wetLeft = out;
+        sRsp.wetRight = nbytes;
+    } else {
+        sRsp.in = in;
+        sRsp.out = out;
+        sRsp.nbytes = nbytes;
+    }
+}
+
+static void a_set_volume(u8 flags, s16 v, u32 w1) {
+    if (flags & A_AUX) {
+        sRsp.volDry = v;
+        sRsp.volWet = (s16) (w1 & 0xFFFF);
+    } else if (flags & A_VOL) {
+        sRsp.vol[(flags & A_LEFT) ? 0 : 1] = v;
+    } else {
+        sRsp.target[(flags & A_LEFT) ? 0 : 1] = v;
+        sRsp.rate[(flags & A_LEFT) ? 0 : 1] = (s32) w1;
+    }
+}
+
+static void a_adpcm_dec(u8 flags, s16 *state) {
+    u8 *in = dmem_ptr(sRsp.in, 0);
+    s16 *out = dmem_ptr(sRsp.out, ROUND_UP_32(sRsp.nbytes) + 16 * sizeof(s16));
+    s32 nbytes = ROUND_UP_32(sRsp.nbytes);
+
+    if (flags & A_INIT) {
+        memset(out, 0, 16 * sizeof(s16));
+    } else if (flags & A_LOOP) {
+        memcpy(out, sRsp.adpcmLoopState, 16 * sizeof(s16));
+    } else {
+        memcpy(out, state, 16 * sizeof(s16));
+    }
+    out += 16;
+
+    while (nbytes > 0) {
+        s32 shift = *in >> 4;
+        s16 (*tbl)[8] = sRsp.adpcmTable[*in++ & 0x7];
+        s32 i, j, k;
+
+        for (i = 0; i < 2; i++) {
+            s16 ins[8];
+            s16 prev1 = out[-1];
+            s16 prev2 = out[-2];
+
+            for (j = 0; j < 4; j++) {
+                ins[j * 2 + 0] = (s16) (((s32) ((u32) (*in >> 4) << 28) >> 28) << shift);
+                ins[j * 2 + 1] = (s16) (((s32) ((u32) (*in & 0xF) << 28) >> 28) << shift);
+                in++;
+            }
+            for (j = 0; j < 8; j++) {
+                s32 acc = tbl[0][j] * prev2 + tbl[1][j] * prev1 + (ins[j] << 11);
+
+                for (k = 0; k < j; k++) {
+                    acc += tbl[1][j - k - 1] * ins[k];
+                }
+                *out++ = clamp16(acc >> 11);
+            }
+        }
+        nbytes -= 16 * sizeof(s16);
+    }
+    memcpy(state, out - 16, 16 * sizeof(s16));
+}
+
+static void a_resample(u8 flags, u16 pitch, s16 *state) {
+    s16 tmp[16];
+    s16 *inInitial = dmem_ptr(sRsp.in, 0);
+    s16 *in = inInitial;
+    s16 *out = dmem_ptr(sRsp.out, ROUND_UP_16(sRsp.nbytes));
+    s32 nbytes = ROUND_UP_16(sRsp.nbytes);
+    u32 pitchAccumulator;
+    s32 i;
+
+    if (flags & A_INIT) {
+        memset(tmp, 0, sizeof(tmp));
+    } else {
+        memcpy(tmp, state, sizeof(tmp));
+    }
+    if (flags & 2) {
+        memcpy(in - 8, tmp + 8, 8 * sizeof(s16));
+        in -= tmp[5] / (s32) sizeof(s16);
+    }
+    in -= 4;
+    pitchAccumulator = (u16) tmp[4];
+    memcpy(in, tmp, 4 * sizeof(s16));
+
+    do {
+        for (i = 0; i < 8; i++) {
+            const s16 *tbl = sResampleTable[pitchAccumulator * 64 >> 16];
+            s32 sample = ((in[0] * tbl[0] + 0x4000) >> 15)
+                       + ((in[1] * tbl[1] + 0x4000) >> 15)
+                       + ((in[2] * tbl[2] + 0x4000) >> 15)
+                       + ((in[3] * tbl[3] + 0x4000) >> 15);
+
+            *out++ = clamp16(sample);
+            pitchAccumulator += (pitch << 1);
+            in += pitchAccumulator >> 16;
+            pitchAccumulator &= 0xFFFF;
+        }
+        nbytes -= 8 * sizeof(s16);
+    } while (nbytes > 0);
+
+    state[4] = (s16) pitchAccumulator;
+    memcpy(state, in, 4 * sizeof(s16));
+    i = (in - inInitial + 4) & 7;
+    in -= i;
+    if (i != 0) {
+        i = -8 - i;
+    }
+    state[5] = i;
+    memcpy(state + 8, in, 8 * sizeof(s16));
+}
+
+static void a_env_mixer(u8 flags, s16 *state) {
+    s32 nbytes = ROUND_UP_16(sRsp.nbytes);
+    s16 *in = dmem_ptr(sRsp.in, nbytes);
+    s16 *dry[2] = { dmem_ptr(sRsp.out, nbytes), dmem_ptr(sRsp.dryRight, nbytes) };
+    s16 *wet[2] = { dmem_ptr(sRsp.wetLeft, nbytes), dmem_ptr(sRsp.wetRight, nbytes) };
+    s16 target[2];
+    s32 rate[2];
+    s32 vols[2][8];
+    s16 volDry, volWet;
+    s32 c, i;
+
+    if (flags & A_INIT) {
+        for (c = 0; c < 2; c++) {
+            s32 stepDiff = sRsp.vol[c] * (sRsp.rate[c] - 0x10000) / 8;
+
+            target[c] = sRsp.target[c];
+            rate[c] = sRsp.rate[c];
+            for (i = 0; i < 8; i++) {
+                vols[c][i] = clamp32(((s64) sRsp.vol[c] << 16) + (s64) stepDiff * (i + 1));
+            }
+        }
+        volDry = sRsp.volDry;
+        volWet = sRsp.volWet;
+    } else {
+        memcpy(vols[0], state, sizeof(vols[0]));
+        memcpy(vols[1], state + 16, sizeof(vols[1]));
+        target[0] = state[32];
+        target[1] = state[35];
+        rate[0] = (state[33] << 16) | (u16) state[34];
+        rate[1] = (state[36] << 16) | (u16) state[37];
+        volDry = state[38];
+        volWet = state[39];
+    }
+
+    do {
+        for (c = 0; c < 2; c++) {
+            for (i = 0; i < 8; i++) {
+                if ((rate[c] >> 16) > 0) {
+                    // Increasing volume
+                    if ((vols[c][i] >> 16) > target[c]) {
+                        vols[c][i] = target[c] << 16;
+                    }
+                } else {
+                    // Decreasing volume
+                    if ((vols[c][i] >> 16) < target[c]) {
+                        vols[c][i] = target[c] << 16;
+                    }
+                }
+                dry[c][i] = clamp16((dry[c][i] * 0x7FFF + in[i] * (((vols[c][i] >> 16) * volDry + 0x4000) >> 15)) >> 15);
+                if (flags & A_AUX) {
+                    wet[c][i] = clamp16((wet[c][i] * 0x7FFF + in[i] * (((vols[c][i] >> 16) * volWet + 0x4000) >> 15)) >> 15);
+                }
+                vols[c][i] = clamp32((s64) vols[c][i] * rate[c] >> 16);
+            }
+            dry[c] += 8;
+            if (flags & A_AUX) {
+                wet[c] += 8;
+            }
+        }
+        nbytes -= 8 * sizeof(s16);
+        in += 8;
+    } while (nbytes > 0);
+
+    memcpy(state, vols[0], sizeof(vols[0]));
+    memcpy(state + 16, vols[1], sizeof(vols[1]));
+    state[32] = target[0];
+    state[35] = target[1];
+    state[33] = (s16) (rate[0] >> 16);
+    state[34] = (s16) rate[0];
+    state[36] = (s16) (rate[1] >> 16);
+    state[37] = (s16) rate[1];
+    state[38] = volDry;
+    state[39] = volWet;
+}
+
+static void a_mix(s16 gain, u16 inAddr, u16 outAddr) {
+    s32 nbytes = ROUND_UP_32(sRsp.nbytes);
+    s16 *in = dmem_ptr(inAddr, nbytes);
+    s16 *out = dmem_ptr(outAddr, nbytes);
+    s32 i;
+
+    if (gain == -0x8000) {
+        for (i = 0; i < nbytes / (s32) sizeof(s16); i++) {
+            out[i] = clamp16(out[i] - in[i]);
+        }
+        return;
+    }
+    for (i = 0; i < nbytes / (s32) sizeof(s16); i++) {
+        out[i] = clamp16((out[i] * 0x7FFF + in[i] * gain + 0x4000) >> 15);
+    }
+}
+
+static void a_interleave(u16 left, u16 right) {
+    s32 count = ROUND_UP_16(sRsp.nbytes) / sizeof(s16);
+    s16 *l = dmem_ptr(left, count * sizeof(s16));
+    s16 *r = dmem_ptr(right, count * sizeof(s16));
+    s16 *d = dmem_ptr(sRsp.out, count * 2 * sizeof(s16));
+    s32 i;
+
+    // The output may overlap the inputs, so go through a copy.
+    s16 tmp[DMEM_SIZE / sizeof(s16)];
+    for (i = 0; i < count; i++) {
+        tmp[i * 2 + 0] = l[i];
+        tmp[i * 2 + 1] = r[i];
+    }
+    memcpy(d, tmp, count * 2 * sizeof(s16));
+}
+
+#ifdef BETTER_REVERB_RSP
+// Undoes the (x & 0xFF) << 8 and x >> 8 pairs of better_reverb_rsp_set_coefs.
+static s32 reverb_coef(const u16 *coefs, s32 i) {
+    return (s16) coefs[i * 2 + 1] * 0x100 + (coefs[i * 2] >> 8);
+}
+
+// Returns the sample offset bytes past the write position of a delay line, which may be negative.
+static s16 *reverb_line(struct BetterReverbRspFilter *filter, s32 offset) {
+    s32 pos = filter->writePos + offset;
+
+    if (pos < 0) {
+        pos += filter->size;
+    } else if (pos >= filter->size) {
+        pos -= filter->size;
+    }
+    return (s16 *) (uintptr_t) filter->buf + pos / sizeof(s16);
+}
+
+static void reverb_advance(struct BetterReverbRspFilter *filter, s32 nbytes) {
+    filter->writePos += nbytes;
+    if (filter->writePos >= filter->size) {
+        filter->writePos -= filter->size;
+    }
+}
+
+/**
+ * Runs one filter of cmd_REVERB over n samples: the history is the sample from delay bytes ago, the new sample is the
+ * incoming carry plus the history scaled by the first coefficient. Stores the new sample when store is set.
+ */
+static void reverb_filter(struct BetterReverbRspFilter *filter, const u16 *coefs, s16 *carry, s16 *out, s32 n, s32 store) {
+    s32 i;
+
+    for (i = 0; i < n; i++) {
+        s32 h = *reverb_line(filter, i * (s32) sizeof(s16) - filter->delay);
+        s16 newSample = clamp16(carry[i] + ((h * reverb_coef(coefs, 0)) >> 8));
+
+        out[i] = clamp16(out[i] + ((h * reverb_coef(coefs, 3)) >> 8));
+        carry[i] = clamp16((h * reverb_coef(coefs, 1) + newSample * reverb_coef(coefs, 2)) >> 8);
+        if (store) {
+            *reverb_line(filter, i * (s32) sizeof(s16)) = newSample;
+        }
+    }
+}
+
+// Same as cmd_REVERB in rsp/audio.s, which gives the same results as reverb_samples and reverb_samples_light.
+static void a_better_reverb(s32 filterCount, s32 lightweight, struct BetterReverbRspParams *params) {
+    s32 n = sRsp.nbytes / sizeof(s16);
+    s16 *in = dmem_ptr(sRsp.in, n * sizeof(s16));
+    s16 *out = dmem_ptr(sRsp.out, n * sizeof(s16));
+    struct BetterReverbRspFilter *last = &params->filters[filterCount - 1];
+    s32 chunk, i, j;
+
+    if (lightweight) {
+        // Each output sample feeds into the next one, so this goes one sample at a time. Its output coefficient is 0.
+        s16 carry = params->history;
+        s16 unusedOut = 0;
+
+        for (i = 0; i < n; i++) {
+            carry = clamp16(in[i] + ((carry * reverb_coef(params->coefs[0], 0)) >> 8));
+            for (j = 0; j < BETTER_REVERB_FILTER_COUNT_LIGHT; j++) {
+                reverb_filter(&params->filters[j], params->coefs[1], &carry, &unusedOut, 1, TRUE);
+                reverb_advance(&params->filters[j], sizeof(s16));
+            }
+            in[i] = carry;
+        }
+        params->history = carry;
+        return;
+    }
+
+    // Chunks are no longer than the last delay, so mixing in the history of the last filter only reads samples it
+    // stored in earlier chunks.
+    for (; n > 0; n -= chunk) {
+        chunk = MIN(n, (last->delay & ~0xF) / (s32) sizeof(s16));
+        reverb_filter(last, params->coefs[0], in, out, chunk, FALSE);
+        for (i = 0; i < filterCount; i++) {
+            reverb_filter(&params->filters[i], params->coefs[i + 1], in, out, chunk, TRUE);
+            reverb_advance(&params->filters[i], chunk * sizeof(s16));
+        }
+        in += chunk;
+        out += chunk;
+    }
+}
+#endif
+
+void rsp_audio_execute(Acmd *cmdList, s32 numCmds) {
+    static s32 sInitialized = FALSE;
+    s32 i;
+
+    if (!sInitialized) {
+        init_resample_table();
+        sInitialized = TRUE;
+    }
+
+    for (i = 0; i < numCmds; i++) {
+        u32 w0 = cmdList[i].words.w0;
+        u32 w1 = cmdList[i].words.w1;
+        u8 flags = (w0 >> 16) & 0xFF;
+        u32 size;
+
+        switch (w0 >> 24) {
+            case A_SPNOOP:
+            case A_SEGMENT:
+                // Addresses are host pointers, so segments are never used.
+                break;
+
+            case A_ADPCM:
+                a_adpcm_dec(flags, (s16 *) (uintptr_t) w1);
+                break;
+
+            case A_CLEARBUFF:
+                size = ROUND_UP_16(w1);
+                memset(dmem_ptr(w0 & 0xFFFFFF, size), 0, size);
+                break;
+
+            case A_ENVMIXER:
+                a_env_mixer(flags, (s16 *) (uintptr_t) w1);
+                break;
+
+            case A_LOADBUFF:
+                size = ROUND_UP_8(sRsp.nbytes);
+                memcpy(dmem_ptr(sRsp.in, size), (void *) (uintptr_t) w1, size);
+                break;
+
+            case A_RESAMPLE:
+                a_resample(flags, w0 & 0xFFFF, (s16 *) (uintptr_t) w1);
+                break;
+
+            case A_SAVEBUFF:
+                size = ROUND_UP_8(sRsp.nbytes);
+                memcpy((void *) (uintptr_t) w1, dmem_ptr(sRsp.out, size), size);
+                break;
+
+            case A_SETBUFF:
+                a_set_buffer(flags, w0 & 0xFFFF, w1 >> 16, w1 & 0xFFFF);
+                break;
+
+            case A_SETVOL:
+                a_set_volume(flags, (s16) (w0 & 0xFFFF), w1);
+                break;
+
+            case A_DMEMMOVE:
+                size = ROUND_UP_16(w1 & 0xFFFF);
+                memmove(dmem_ptr(w1 >> 16, size), dmem_ptr(w0 & 0xFFFFFF, size), size);
+                break;
+
+            case A_LOADADPCM:
+                size = w0 & 0xFFFFFF;
+                if (size > sizeof(sRsp.adpcmTable)) {
+                    size = sizeof(sRsp.adpcmTable);
+                }
+                memcpy(sRsp.adpcmTable, (void *) (uintptr_t) w1, size);
+                break;
+
+            case A_MIXER:
+                a_mix((s16) (w0 & 0xFFFF), w1 >> 16, w1 & 0xFFFF);
+                break;
+
+            case A_INTERLEAVE:
+                a_interleave(w1 >> 16, w1 & 0xFFFF);
+                break;
+
+            case A_SETLOOP:
+                sRsp.adpcmLoopState = (s16 *) (uintptr_t) w1;
+                break;
+
+#ifdef BETTER_REVERB_RSP
+            case A_BETTER_REVERB:
+                a_better_reverb((w0 >> 4) & 0xFFF, w0 & 1, (struct BetterReverbRspParams *) (uintptr_t) w1);
+                break;
+#endif
+
+            default:
+                fprintf(stderr, "rsp_audio: unsupported command 0x%02X\n", w0 >> 24);
+                exit(1);
+        }
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef RSP_AUDIO_H
+#define RSP_AUDIO_H
+
+#include <ultra64.h>
+
+/**
+ * Runs an audio command list produced by synthesis_execute on the CPU, in place of the
+ * aspMain microcode. Only the commands emitted by the US/JP synthesis code are supported.
+ */
+void rsp_audio_execute(Acmd *cmdList, s32 numCmds);
+
+#endif // RSP_AUDIO_H
@@ -0,0 +1,28 @@
+# Native endian copies of build/<version>/sound/*, generated by the Makefile in this directory.
+# The include path for .incbin is passed with -Wa,-I.
+
+.section .rodata
+
+.balign 16
+.globl gSoundDataADSR
+gSoundDataADSR:
+.incbin "sound_data.ctl"
+
+.balign 16
+.globl gSoundDataRaw
+gSoundDataRaw:
+.incbin "sound_data.tbl"
+
+.balign 16
+.globl gMusicData
+gMusicData:
+.incbin "sequences.bin"
+
+.balign 16
+.globl gBankSetsData
+gBankSetsData:
+.incbin "bank_sets"
+
+.balign 16
+
+.section .note.GNU-stack,"",@progbits
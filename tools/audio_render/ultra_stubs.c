@@ -0,0 +1,106 @@
+/**
+ * Host replacements for the libultra and game symbols referenced by the audio driver.
+ * PI DMAs complete immediately, since ROM addresses are host pointers into the sound data.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ultra64.h>
+
+#include "types.h"
+#include "config.h"
+#include "audio/data.h"
+#include "game/emutest.h"
+
+#define VI_NTSC_CLOCK 48681812
+
+ALIGNED16 u8 gAudioHeap[DOUBLE_SIZE_ON_64_BIT(AUDIO_HEAP_SIZE)];
+struct Config gConfig;
+enum Emulator gEmulator = EMU_CONSOLE;
+s32 gAudioErrorFlags = 0;
+s32 gVerbose = FALSE;
+
+void osCreateMesgQueue(OSMesgQueue *mq, OSMesg *msg, s32 count) {
+    mq->mtqueue = NULL;
+    mq->fullqueue = NULL;
+    mq->validCount = 0;
+    mq->first = 0;
+    mq->msgCount = count;
+    mq->msg = msg;
+}
+
+s32 osSendMesg(OSMesgQueue *mq, OSMesg msg, UNUSED s32 flag) {
+    if (mq->validCount >= mq->msgCount) {
+        return -1;
+    }
+    mq->msg[(mq->first + mq->validCount) % mq->msgCount] = msg;
+    mq->validCount++;
+    return 0;
+}
+
+s32 osRecvMesg(OSMesgQueue *mq, OSMesg *msg, s32 flag) {
+    if (mq->validCount == 0) {
+        if (flag == OS_MESG_BLOCK) {
+            // Nothing else can ever post to the queue, so this would hang forever.
+            fprintf(stderr, "osRecvMesg: blocking receive on an empty queue\n");
+            exit(1);
+        }
+        return -1;
+    }
+    if (msg != NULL) {
+        *msg = mq->msg[mq->first];
+    }
+    mq->first = (mq->first + 1) % mq->msgCount;
+    mq->validCount--;
+    return 0;
+}
+
+s32 osPiStartDma(OSIoMesg *mb, UNUSED s32 priority, UNUSED s32 direction, u32 devAddr, void *vAddr, u32 nbytes,
+                 OSMesgQueue *mq) {
+    memcpy(vAddr, (void *) (uintptr_t) devAddr, nbytes);
+    mb->hdr.retQueue = mq;
+    mb->dramAddr = vAddr;
+    mb->devAddr = devAddr;
+    mb->size = nbytes;
+    return osSendMesg(mq, (OSMesg) mb, OS_MESG_NOBLOCK);
+}
+
+s32 osAiSetFrequency(u32 frequency) {
+    u32 dacRate = (u32) (((f32) VI_NTSC_CLOCK / frequency) + 0.5f);
+
+    return VI_NTSC_CLOCK / dacRate;
+}
+
+void osInvalDCache(UNUSED void *vaddr, UNUSED s32 nbytes) {
+}
+
+void osWritebackDCache(UNUSED void *vaddr, UNUSED s32 nbytes) {
+}
+
+void osWritebackDCacheAll(void) {
+}
+
+void osSyncPrintf(const char *fmt, ...) {
+    va_list args;
+
+    if (gVerbose) {
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+    }
+}
+
+void alSeqFileNew(ALSeqFile *file, u8 *base) {
+    s32 i;
+
+    for (i = 0; i < file->seqCount; i++) {
+        file->seqArray[i].offset = base + (uintptr_t) file->seqArray[i].offset;
+    }
+}
+
+void __n64Assert(char *fileName, u32 lineNum, char *message) {
+    fprintf(stderr, "%s:%u: %s\n", fileName, lineNum, message);
+    exit(1);
+}
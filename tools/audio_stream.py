@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""
+Converts audio into the chunked stream format played by AUDIO_STREAMING (see src/audio/stream.h).
+
+PCM streams are made from 16-bit WAV files (mono or stereo). VADPCM streams are made from one
+.aifc file per channel, as produced by the tabledesign/vadpcm_enc tools used for sound samples.
+Stereo VADPCM streams must use the same codebook for both channels (vadpcm_enc -c <table>).
+
+Loops always start on a chunk boundary, so the start of the stream is padded with silence until
+the loop start lines up with one.
+
+Usage:
+    tools/audio_stream.py [--loop SAMPLE] [--chunk-samples N] out.stream in.wav
+    tools/audio_stream.py [--loop SAMPLE] [--chunk-samples N] out.stream left.aifc [right.aifc]
+"""
+import argparse
+import struct
+import sys
+import wave
+
+MAGIC = 0x5354524D
+CODEC_PCM16 = 0
+CODEC_ADPCM = 1
+
+HEADER_SIZE = 0x130
+BOOK_MAX_ENTRIES = 2 * 8 * 8
+BUFFER_SIZE = 0x2000
+MIN_CHUNK_SAMPLES = 0x200
+DEFAULT_CHUNK_SAMPLES = 0x800
+
+ADPCM_FRAME_SAMPLES = 16
+ADPCM_FRAME_BYTES = 9
+
+
+def fail(msg):
+    print("audio_stream.py: " + msg, file=sys.stderr)
+    sys.exit(1)
+
+
+def align(val, al):
+    return (val + (al - 1)) & -al
+
+
+def parse_f80(data):
+    exp_bits, mantissa_bits = struct.unpack(">HQ", data)
+    sign = -1 if exp_bits & 0x8000 else 1
+    exp_bits &= 0x7FFF
+    if exp_bits == mantissa_bits == 0:
+        return 0.0
+    return sign * float(mantissa_bits) / 2 ** 63 * pow(2, exp_bits - 0x3FFF)
+
+
+def read_aifc(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"FORM" or data[8:12] != b"AIFC":
+        fail(path + ": not an AIFC file")
+
+    sample_rate = None
+    sound_data = None
+    book = None
+    i = 12
+    while i < len(data):
+        tp = data[i : i + 4]
+        (length,) = struct.unpack(">I", data[i + 4 : i + 8])
+        chunk = data[i + 8 : i + 8 + length]
+        i = align(i + 8 + length, 2)
+
+        if tp == b"COMM":
+            num_channels = struct.unpack(">h", chunk[:2])[0]
+            if num_channels != 1:
+                fail(path + ": VADPCM inputs must be mono, use one file per channel")
+            sample_rate = parse_f80(chunk[8:18])
+        elif tp == b"SSND":
+            sound_data = chunk[8:]
+        elif tp == b"APPL" and chunk[:4] == b"stoc":
+            name_len = chunk[4]
+            name = chunk[5 : 5 + name_len]
+            body = chunk[align(5 + name_len, 2) :]
+            if name == b"VADPCMCODES":
+                version, order, npredictors = struct.unpack(">hhh", body[:6])
+                entries = order * npredictors * 8
+                book = (order, npredictors, list(struct.unpack(">%dh" % entries, body[6 : 6 + entries * 2])))
+
+    if sample_rate is None or sound_data is None or book is None:
+        fail(path + ": missing COMM, SSND or VADPCM codebook")
+    if book[0] * book[1] * 8 > BOOK_MAX_ENTRIES:
+        fail(path + ": codebook is too large (at most order 2 with 8 predictors)")
+
+    num_frames = len(sound_data) // ADPCM_FRAME_BYTES
+    return int(sample_rate), book, sound_data[: num_frames * ADPCM_FRAME_BYTES]
+
+
+def read_wav(path):
+    with wave.open(path, "rb") as w:
+        if w.getsampwidth() != 2:
+            fail(path + ": only 16-bit WAV files are supported")
+        if w.getnchannels() not in (1, 2):
+            fail(path + ": only mono and stereo WAV files are supported")
+        num_channels = w.getnchannels()
+        sample_rate = w.getframerate()
+        frames = w.readframes(w.getnframes())
+
+    count = len(frames) // 2
+    samples = struct.unpack("<%dh" % count, frames[: count * 2])
+    return sample_rate, [list(samples[c::num_channels]) for c in range(num_channels)]
+
+
+class Stream:
+    def __init__(self, codec, sample_rate, channels, book=None):
+        # channels holds lists of samples (PCM) or bytes of whole frames (ADPCM)
+        self.codec = codec
+        self.sample_rate = sample_rate
+        self.channels = channels
+        self.book = book
+
+    def num_samples(self):
+        if self.codec == CODEC_PCM16:
+            return len(self.channels[0])
+        return len(self.channels[0]) // ADPCM_FRAME_BYTES * ADPCM_FRAME_SAMPLES
+
+    def bytes_for(self, samples):
+        if self.codec == CODEC_PCM16:
+            return samples * 2
+        return samples // ADPCM_FRAME_SAMPLES * ADPCM_FRAME_BYTES
+
+    def encode(self, channel, start, end):
+        if self.codec == CODEC_PCM16:
+            return struct.pack(">%dh" % (end - start), *self.channels[channel][start:end])
+        return bytes(self.channels[channel][self.bytes_for(start) : self.bytes_for(end)])
+
+    def pad(self, lead, total):
+        """Adds lead samples of silence at the start, and pads or trims the end to total samples."""
+        for c in range(len(self.channels)):
+            if self.codec == CODEC_PCM16:
+                data = [0] * lead + self.channels[c]
+                self.channels[c] = (data + [0] * total)[:total]
+            else:
+                # All zero frames decode to silence after silence
+                data = bytes(self.bytes_for(lead)) + self.channels[c]
+                self.channels[c] = (data + bytes(self.bytes_for(total)))[: self.bytes_for(total)]
+
+
+def choose_layout(num_samples, loop, max_chunk_samples):
+    """
+    Finds a chunk size for which the loop start falls on a chunk boundary after padding, and the
+    last chunk is long enough that one audio update never spans more than two chunks.
+    Returns (chunk samples, lead-in samples, total samples).
+    """
+    for chunk_samples in range(max_chunk_samples, MIN_CHUNK_SAMPLES - 1, -ADPCM_FRAME_SAMPLES):
+        lead = (chunk_samples - loop % chunk_samples) % chunk_samples if loop is not None else 0
+        total = lead + num_samples
+        tail = total % chunk_samples
+        if total >= MIN_CHUNK_SAMPLES and (tail == 0 or tail >= MIN_CHUNK_SAMPLES):
+            return chunk_samples, lead, total
+    if loop is None:
+        # Pad the end with silence instead
+        return max_chunk_samples, 0, align(max(num_samples, MIN_CHUNK_SAMPLES), max_chunk_samples)
+    fail("could not find a chunk layout for this loop, try another --chunk-samples")
+
+
+def write_stream(path, stream, loop, max_chunk_samples):
+    num_channels = len(stream.channels)
+    num_samples = stream.num_samples()
+
+    if stream.codec == CODEC_PCM16:
+        # Chunks must be whole multiples of 16 samples
+        if loop is not None:
+            num_samples -= num_samples % ADPCM_FRAME_SAMPLES
+        else:
+            num_samples = align(num_samples, ADPCM_FRAME_SAMPLES)
+    if loop is not None and (loop < 0 or loop >= num_samples or loop % ADPCM_FRAME_SAMPLES != 0):
+        fail("loop start must be a multiple of 16 inside the stream")
+
+    chunk_samples, lead, total = choose_layout(num_samples, loop, max_chunk_samples)
+    stream.pad(lead, total)
+
+    channel_stride = align(stream.bytes_for(chunk_samples), 16)
+    chunk_stride = channel_stride * num_channels
+    if chunk_stride > BUFFER_SIZE:
+        fail("chunks are 0x%X bytes, but must fit in 0x%X; lower --chunk-samples" % (chunk_stride, BUFFER_SIZE))
+
+    num_chunks = (total + chunk_samples - 1) // chunk_samples
+    last_chunk_samples = total - (num_chunks - 1) * chunk_samples
+    loop_chunk = (loop + lead) // chunk_samples if loop is not None else -1
+
+    book_order, book_predictors, book = stream.book if stream.book is not None else (0, 0, [])
+    header = struct.pack(
+        ">IBBHIIIIIiHHI8x",
+        MAGIC,
+        stream.codec,
+        num_channels,
+        stream.sample_rate,
+        num_chunks,
+        chunk_samples,
+        last_chunk_samples,
+        channel_stride,
+        chunk_stride,
+        loop_chunk,
+        book_order,
+        book_predictors,
+        HEADER_SIZE,
+    )
+    header += struct.pack(">%dh" % BOOK_MAX_ENTRIES, *(book + [0] * (BOOK_MAX_ENTRIES - len(book))))
+    assert len(header) == HEADER_SIZE
+
+    with open(path, "wb") as f:
+        f.write(header)
+        for chunk in range(num_chunks):
+            start = chunk * chunk_samples
+            end = min(start + chunk_samples, total)
+            for c in range(num_channels):
+                data = stream.encode(c, start, end)
+                f.write(data + bytes(channel_stride - len(data)))
+
+    print(
+        "%s: %d channel(s), %d Hz, %d chunks of %d samples (0x%X bytes), loop chunk %d"
+        % (path, num_channels, stream.sample_rate, num_chunks, chunk_samples, chunk_stride, loop_chunk)
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert audio into an AUDIO_STREAMING stream file.")
+    parser.add_argument("output", help="output .stream file")
+    parser.add_argument("inputs", nargs="+", help="a 16-bit WAV file, or one VADPCM .aifc file per channel")
+    parser.add_argument("--loop", type=int, default=None, help="sample to loop back to at the end (multiple of 16)")
+    parser.add_argument(
+        "--chunk-samples", type=int, default=DEFAULT_CHUNK_SAMPLES, help="largest chunk size in samples per channel"
+    )
+    args = parser.parse_args()
+
+    if args.chunk_samples < MIN_CHUNK_SAMPLES or args.chunk_samples % ADPCM_FRAME_SAMPLES != 0:
+        fail("--chunk-samples must be a multiple of 16 and at least %d" % MIN_CHUNK_SAMPLES)
+
+    if args.inputs[0].lower().endswith(".wav"):
+        if len(args.inputs) != 1:
+            fail("only one WAV file can be given")
+        sample_rate, channels = read_wav(args.inputs[0])
+        stream = Stream(CODEC_PCM16, sample_rate, channels)
+    else:
+        if len(args.inputs) > 2:
+            fail("at most two .aifc files can be given")
+        parsed = [read_aifc(path) for path in args.inputs]
+        if any(p[1] != parsed[0][1] for p in parsed) or any(p[0] != parsed[0][0] for p in parsed):
+            fail("all channels must have the same sample rate and codebook")
+        length = min(len(p[2]) for p in parsed)
+        stream = Stream(CODEC_ADPCM, parsed[0][0], [bytearray(p[2][:length]) for p in parsed], parsed[0][1])
+
+    if stream.sample_rate >= 0x10000:
+        fail("sample rate is too high")
+
+    write_stream(args.output, stream, args.loop, args.chunk_samples)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""
+Host side of the input replay benchmark (BENCHMARK_RECORD_INPUTS and BENCHMARK_REPLAY, see src/game/benchmark.c).
+
+Recordings and results are read either from a binary dump received over USB, or from the emulator's SRAM save
+file (.sra), which some emulators store with each word byte swapped.
+
+Usage:
+    tools/benchmark.py route recording.bin [src/game/benchmark/route.inc.c]
+    tools/benchmark.py report results.sra [--csv frames.csv]
+    tools/benchmark.py compare baseline.sra results.sra [--threshold PERCENT]
+"""
+import argparse
+import struct
+import sys
+
+ROUTE_MAGIC = 0x42525445
+RESULTS_MAGIC = 0x424E4348
+VERSION = 1
+
+HEADER_FORMAT = ">IHHII"
+INPUT_FORMAT = ">HHbb"
+FRAME_FORMAT = ">6H"
+
+FRAME_FIELDS = ["cpu", "cpuAudio", "rspGfx", "rspAudio", "rdp", "objects"]
+TIME_FIELDS = FRAME_FIELDS[:-1]
+
+DEFAULT_ROUTE_PATH = "src/game/benchmark/route.inc.c"
+
+
+def fail(msg):
+    print("benchmark.py: " + msg, file=sys.stderr)
+    sys.exit(1)
+
+
+def unswap_words(data):
+    data = data[: len(data) & ~3]
+    return b"".join(data[i : i + 4][::-1] for i in range(0, len(data), 4))
+
+
+def read_dump(path, magic):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if len(data) >= 4 and struct.unpack(">I", data[:4])[0] != magic:
+        data = unswap_words(data)
+    if len(data) < struct.calcsize(HEADER_FORMAT) or struct.unpack(">I", data[:4])[0] != magic:
+        fail(path + ": not a benchmark %s" % ("recording" if magic == ROUTE_MAGIC else "result"))
+
+    _, version, count, checksum, route_frames = struct.unpack_from(HEADER_FORMAT, data)
+    if version != VERSION:
+        fail(path + ": unsupported version %d" % version)
+    return data[struct.calcsize(HEADER_FORMAT) :], count, checksum, route_frames
+
+
+def route_checksum(inputs):
+    # FNV-1a, matching benchmark_checksum in src/game/benchmark.c
+    h = 0x811C9DC5
+    for inp in inputs:
+        for b in struct.pack(INPUT_FORMAT, *inp):
+            h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def read_route(path):
+    data, count, checksum, route_frames = read_dump(path, ROUTE_MAGIC)
+    size = struct.calcsize(INPUT_FORMAT)
+    if len(data) < count * size:
+        fail(path + ": recording is truncated")
+    inputs = [struct.unpack_from(INPUT_FORMAT, data, i * size) for i in range(count)]
+    if route_checksum(inputs) != checksum:
+        fail(path + ": checksum mismatch, the recording is corrupt")
+    return inputs, route_frames
+
+
+def read_results(path):
+    data, count, checksum, route_frames = read_dump(path, RESULTS_MAGIC)
+    size = struct.calcsize(FRAME_FORMAT)
+    if len(data) < count * size:
+        fail(path + ": results are truncated")
+    frames = [dict(zip(FRAME_FIELDS, struct.unpack_from(FRAME_FORMAT, data, i * size))) for i in range(count)]
+    return frames, checksum, route_frames
+
+
+def percentile(values, pct):
+    values = sorted(values)
+    return values[min(len(values) - 1, len(values) * pct // 100)]
+
+
+def summarize(frames):
+    summary = {}
+    for field in FRAME_FIELDS:
+        values = [f[field] for f in frames]
+        summary[field] = {
+            "avg": sum(values) / len(values),
+            "p50": percentile(values, 50),
+            "p99": percentile(values, 99),
+            "max": max(values),
+        }
+    return summary
+
+
+def cmd_route(args):
+    inputs, route_frames = read_route(args.input)
+    with open(args.output, "w") as f:
+        f.write("// Route replayed by BENCHMARK_REPLAY, generated with tools/benchmark.py route.\n")
+        f.write("// %d inputs over %d frames.\n" % (len(inputs), route_frames))
+        f.write("static const struct BenchmarkInput sBenchmarkRoute[] = {\n")
+        for frames, button, stick_x, stick_y in inputs:
+            f.write("    { %d, 0x%04X, %d, %d },\n" % (frames, button, stick_x, stick_y))
+        f.write("    { 0, 0, 0, 0 },\n")
+        f.write("};\n")
+    print("%s: %d inputs over %d frames" % (args.output, len(inputs), route_frames))
+
+
+def cmd_report(args):
+    frames, checksum, route_frames = read_results(args.input)
+    if not frames:
+        fail(args.input + ": no frames were recorded")
+
+    print("Route %08X: %d frames, %d sampled" % (checksum, route_frames, len(frames)))
+    for field, stats in summarize(frames).items():
+        unit = "" if field == "objects" else " us"
+        print(
+            "%-9s avg %8.1f%s  p50 %6d%s  p99 %6d%s  max %6d%s"
+            % (field, stats["avg"], unit, stats["p50"], unit, stats["p99"], unit, stats["max"], unit)
+        )
+
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write("frame," + ",".join(FRAME_FIELDS) + "\n")
+            for i, frame in enumerate(frames):
+                f.write("%d,%s\n" % (i, ",".join(str(frame[k]) for k in FRAME_FIELDS)))
+
+
+def cmd_compare(args):
+    base_frames, base_checksum, _ = read_results(args.baseline)
+    new_frames, new_checksum, _ = read_results(args.results)
+    if base_checksum != new_checksum:
+        fail("the results are from different routes (%08X and %08X)" % (base_checksum, new_checksum))
+
+    # The route is deterministic, so a different object count means the replay desynced.
+    count = min(len(base_frames), len(new_frames))
+    for i in range(count):
+        if base_frames[i]["objects"] != new_frames[i]["objects"]:
+            print("warning: object counts differ from frame %d, the game state may have changed" % i)
+            break
+
+    base = summarize(base_frames[:count])
+    new = summarize(new_frames[:count])
+    regressions = 0
+    print("%-9s %10s %10s %9s %10s %10s %9s" % ("", "base avg", "avg", "", "base p99", "p99", ""))
+    for field in TIME_FIELDS:
+        row = "%-9s" % field
+        for stat in ("avg", "p99"):
+            old, cur = base[field][stat], new[field][stat]
+            change = (cur - old) * 100.0 / old if old else 0.0
+            flag = " "
+            if change > args.threshold:
+                flag = "!"
+                regressions += 1
+            row += " %10.1f %10.1f %+7.1f%%%s" % (old, cur, change, flag)
+        print(row)
+
+    if regressions:
+        print("%d regression(s) above %.1f%%" % (regressions, args.threshold))
+        sys.exit(2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert input recordings and compare replay benchmark results.")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("route", help="convert an input recording into a route for BENCHMARK_REPLAY")
+    p.add_argument("input", help="recording dumped over USB, or the SRAM save file")
+    p.add_argument("output", nargs="?", default=DEFAULT_ROUTE_PATH, help="route file to write")
+    p.set_defaults(func=cmd_route)
+
+    p = sub.add_parser("report", help="summarize a set of results")
+    p.add_argument("input", help="results dumped over USB, or the SRAM save file")
+    p.add_argument("--csv", help="also write every frame to a CSV file")
+    p.set_defaults(func=cmd_report)
+
+    p = sub.add_parser("compare", help="compare results against a baseline, exiting with 2 on regressions")
+    p.add_argument("baseline", help="results of the baseline build")
+    p.add_argument("results", help="results of the build to check")
+    p.add_argument("--threshold", type=float, default=5.0, help="largest allowed increase in percent (default: 5)")
+    p.set_defaults(func=cmd_compare)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
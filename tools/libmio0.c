@@ -25,7 +25,9 @@ typedef struct
 } lookback;
 
 // functions
-#define LOOKBACK_COUNT 256
+// positions are looked up by a hash of their first 3 bytes, since shorter matches are never used
+#define LOOKBACK_HASH_BITS 12
+#define LOOKBACK_COUNT (1 << LOOKBACK_HASH_BITS)
 #define LOOKBACK_INIT_SIZE 128
 static lookback *lookback_init(void)
 {
@@ -47,9 +49,18 @@ static void lookback_free(lookback *lb)
    free(lb);
 }
 
-static inline void lookback_push(lookback *lkbk, unsigned char val, int index)
+static inline unsigned int lookback_hash(const unsigned char *buf)
 {
-   lookback *lb = &lkbk[val];
+   return ((buf[0] << 16 | buf[1] << 8 | buf[2]) * 2654435761u) >> (32 - LOOKBACK_HASH_BITS);
+}
+
+static inline void lookback_push(lookback *lkbk, const unsigned char *buf, unsigned int length, int index)
+{
+   lookback *lb;
+   if (index + 3 > length) {
+      return;
+   }
+   lb = &lkbk[lookback_hash(&buf[index])];
    if (lb->count == lb->allocated) {
       lb->allocated *= 4;
       lb->indexes = realloc(lb->indexes, lb->allocated * sizeof(*lb->indexes));
@@ -78,8 +89,13 @@ static int find_longest(const unsigned char *buf, int start_offset, int max_sear
    int search_len;
    int farthest, off, i;
    int lb_idx;
-   const unsigned char first = buf[start_offset];
-   lookback *lb = &lkbk[first];
+   lookback *lb;
+
+   if (max_search < 3) {
+      *found_offset = 0;
+      return 0;
+   }
+   lb = &lkbk[lookback_hash(&buf[start_offset])];
 
    // buf
    //  |    off        start                  max
@@ -117,6 +133,10 @@ static int find_longest(const unsigned char *buf, int start_offset, int max_sear
       if (cur_length > best_length) {
          best_offset = start_offset - off;
          best_length = cur_length;
+         // nothing later can beat it, and the earliest match wins ties
+         if (best_length == max_search) {
+            break;
+         }
       }
    }
 
@@ -219,7 +239,7 @@ int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out
 
    // encode data
    // special case for first byte
-   lookback_push(lookbacks, in[0], 0);
+   lookback_push(lookbacks, in, length, 0);
    uncomp_buf[uncomp_idx] = in[0];
    uncomp_idx += 1;
    bytes_proc += 1;
@@ -229,7 +249,7 @@ int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out
       int max_length = MIN(length - bytes_proc, 18);
       int longest_match = find_longest(in, bytes_proc, max_length, &offset, lookbacks);
       // push current byte before checking next longer match
-      lookback_push(lookbacks, in[bytes_proc], bytes_proc);
+      lookback_push(lookbacks, in, length, bytes_proc);
       if (longest_match > 2) {
          int lookahead_offset;
          // lookahead to next byte to see if longer match
@@ -245,11 +265,11 @@ int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out
             longest_match = lookahead_match;
             offset = lookahead_offset;
             bit_idx++;
-            lookback_push(lookbacks, in[bytes_proc], bytes_proc);
+            lookback_push(lookbacks, in, length, bytes_proc);
          }
          // first byte already pushed above
          for (int i = 1; i < longest_match; i++) {
-            lookback_push(lookbacks, in[bytes_proc + i], bytes_proc + i);
+            lookback_push(lookbacks, in, length, bytes_proc + i);
          }
          // compressed block
          comp_buf[comp_idx] = (((longest_match - 3) & 0x0F) << 4) |
@@ -283,6 +303,7 @@ int mio0_encode(const unsigned char *in, unsigned int length, unsigned char *out
    write_u32_be(&out[12], uncomp_offset);
    // output data
    memcpy(&out[MIO0_HEADER_LENGTH], bit_buf, bit_length);
+   memset(&out[MIO0_HEADER_LENGTH + bit_length], 0, comp_offset - (MIO0_HEADER_LENGTH + bit_length));
    memcpy(&out[comp_offset], comp_buf, comp_idx);
    memcpy(&out[uncomp_offset], uncomp_buf, uncomp_idx);
 
@@ -449,12 +470,21 @@ free_all:
 
 // mio0 standalone executable
 #ifdef MIO0_STANDALONE
+#include <pthread.h>
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 typedef struct
 {
    char *in_filename;
    char *out_filename;
    unsigned int offset;
    int compress;
+   char **files;   // every FILE and OUTPUT, in pairs when there's more than one FILE
+   int file_count;
 } arg_config;
 
 static arg_config default_config =
@@ -462,12 +492,82 @@ static arg_config default_config =
    NULL,
    NULL,
    0,
-   1
+   1,
+   NULL,
+   0
 };
 
+typedef struct
+{
+   char **files;
+   int count;
+   int next;
+   int ret_val;
+   pthread_mutex_t lock;
+} batch_queue;
+
+static int cpu_count(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return info.dwNumberOfProcessors;
+#else
+   long count = sysconf(_SC_NPROCESSORS_ONLN);
+   return count > 0 ? count : 1;
+#endif
+}
+
+static void *batch_worker(void *arg)
+{
+   batch_queue *queue = arg;
+   while (1) {
+      int ret_val;
+      int pair;
+      pthread_mutex_lock(&queue->lock);
+      pair = queue->next++;
+      pthread_mutex_unlock(&queue->lock);
+      if (pair >= queue->count) {
+         return NULL;
+      }
+      ret_val = mio0_encode_file(queue->files[pair * 2], queue->files[pair * 2 + 1]);
+      if (ret_val != 0) {
+         ERROR("Error compressing \"%s\" to \"%s\"\n", queue->files[pair * 2], queue->files[pair * 2 + 1]);
+         pthread_mutex_lock(&queue->lock);
+         queue->ret_val = ret_val;
+         pthread_mutex_unlock(&queue->lock);
+      }
+   }
+}
+
+// compress FILE OUTPUT pairs using a thread per CPU core
+static int mio0_encode_batch(char **files, int count)
+{
+   batch_queue queue;
+   pthread_t *threads;
+   int thread_count = MIN(cpu_count(), count);
+
+   queue.files = files;
+   queue.count = count;
+   queue.next = 0;
+   queue.ret_val = 0;
+   pthread_mutex_init(&queue.lock, NULL);
+   threads = malloc(thread_count * sizeof(*threads));
+   for (int i = 0; i < thread_count; i++) {
+      pthread_create(&threads[i], NULL, batch_worker, &queue);
+   }
+   for (int i = 0; i < thread_count; i++) {
+      pthread_join(threads[i], NULL);
+   }
+   free(threads);
+   pthread_mutex_destroy(&queue.lock);
+
+   return queue.ret_val;
+}
+
 static void print_usage(void)
 {
-   ERROR("Usage: mio0 [-c / -d] [-o OFFSET] FILE [OUTPUT]\n"
+   ERROR("Usage: mio0 [-c / -d] [-o OFFSET] FILE [OUTPUT] [FILE OUTPUT ...]\n"
          "\n"
          "mio0 v" MIO0_VERSION ": MIO0 compression and decompression tool\n"
          "\n"
@@ -478,7 +578,8 @@ static void print_usage(void)
          "\n"
          "File arguments:\n"
          " FILE        input file\n"
-         " [OUTPUT]    output file (default: FILE.out), \"-\" for stdout\n");
+         " [OUTPUT]    output file (default: FILE.out), \"-\" for stdout\n"
+         " FILE OUTPUT more files to compress, spread across all CPU cores\n");
    exit(1);
 }
 
@@ -518,16 +619,20 @@ static void parse_arguments(int argc, char *argv[], arg_config *config)
             case 1:
                config->out_filename = argv[i];
                break;
-            default: // too many
-               print_usage();
+            default: // more pairs to compress
                break;
          }
-         file_count++;
+         config->files[file_count++] = argv[i];
       }
    }
    if (file_count < 1) {
       print_usage();
    }
+   // more than one FILE only works for compressing, and each needs an OUTPUT
+   if (file_count > 2 && (!config->compress || file_count % 2 != 0)) {
+      print_usage();
+   }
+   config->file_count = file_count;
 }
 
 int main(int argc, char *argv[])
@@ -538,6 +643,7 @@ int main(int argc, char *argv[])
 
    // get configuration from arguments
    config = default_config;
+   config.files = malloc(argc * sizeof(*config.files));
    parse_arguments(argc, argv, &config);
    if (config.out_filename == NULL) {
       config.out_filename = out_filename;
@@ -545,7 +651,11 @@ int main(int argc, char *argv[])
    }
 
    // operation
-   if (config.compress) {
+   if (config.file_count > 2) {
+      ret_val = mio0_encode_batch(config.files, config.file_count / 2);
+      free(config.files);
+      return ret_val;
+   } else if (config.compress) {
       ret_val = mio0_encode_file(config.in_filename, config.out_filename);
    } else {
       ret_val = mio0_decode_file(config.in_filename, config.offset, config.out_filename);
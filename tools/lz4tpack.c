@@ -0,0 +1,303 @@
+// LZ4T compression tool
+//
+// LZ4T is a byte-aligned LZ4 variant made to be unpacked as fast as possible by lz4t_unpack (src/boot/lz4t.s).
+// Everything is byte aligned and match offsets are big endian, so the decoder never has to shift bits around.
+//
+// Header (8 bytes):
+//   0x00  "LZ4T"
+//   0x04  Decompressed size (u32, big endian)
+//
+// Followed by sequences until the output is full:
+//   token         High nibble: literal count. Low nibble: match length - 4.
+//                 15 in either means extra length bytes follow, each one added to it, up to and including
+//                 the first that isn't 255.
+//   [lengths]     Extra literal count bytes
+//   literals
+//                 (Stops here if the output is full)
+//   offset        u16, big endian, 1-65535 bytes back from the current output position
+//   [lengths]     Extra match length bytes
+//                 (Stops here if the output is full)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LZ4T_HEADER_SIZE 8
+#define MIN_MATCH        4
+#define MAX_OFFSET       0xFFFF
+#define HASH_BITS        16
+#define MAX_CHAIN        4096
+
+static unsigned char *in;
+static int insize;
+static unsigned char *out;
+static int outsize;
+static int *head;
+static int *prev;
+
+static void usage(void) {
+    fprintf(stderr, "lz4tpack [-d] infile outfile\n"
+                    "  -d  decompress instead\n");
+    exit(1);
+}
+
+static unsigned char *read_file(const char *path, int *size) {
+    FILE *fp = fopen(path, "rb");
+    unsigned char *data;
+
+    if (fp == NULL) {
+        perror(path);
+        exit(1);
+    }
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data = malloc(*size + 1);
+    if (data == NULL || fread(data, 1, *size, fp) != (size_t) *size) {
+        fprintf(stderr, "lz4tpack: could not read %s\n", path);
+        exit(1);
+    }
+    fclose(fp);
+    return data;
+}
+
+static void write_file(const char *path, unsigned char *data, int size) {
+    FILE *fp = fopen(path, "wb");
+
+    if (fp == NULL) {
+        perror(path);
+        exit(1);
+    }
+    if (fwrite(data, 1, size, fp) != (size_t) size) {
+        fprintf(stderr, "lz4tpack: could not write %s\n", path);
+        exit(1);
+    }
+    fclose(fp);
+}
+
+static unsigned int hash4(int pos) {
+    unsigned int v = (in[pos] << 24) | (in[pos + 1] << 16) | (in[pos + 2] << 8) | in[pos + 3];
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void insert(int pos) {
+    if (pos + MIN_MATCH <= insize) {
+        unsigned int h = hash4(pos);
+        prev[pos] = head[h];
+        head[h] = pos;
+    }
+}
+
+// Finds the longest match for pos among the positions already inserted, preferring the closest.
+static int find_match(int pos, int *offset) {
+    int best = 0;
+    int chain = MAX_CHAIN;
+
+    if (pos + MIN_MATCH > insize) {
+        return 0;
+    }
+    for (int cand = head[hash4(pos)]; cand >= 0 && pos - cand <= MAX_OFFSET && chain-- > 0; cand = prev[cand]) {
+        int len = 0;
+
+        if (in[cand + best] != in[pos + best]) {
+            continue;
+        }
+        while (pos + len < insize && in[cand + len] == in[pos + len]) {
+            len++;
+        }
+        if (len > best) {
+            best = len;
+            *offset = pos - cand;
+            if (pos + len == insize) {
+                break;
+            }
+        }
+    }
+
+    return (best >= MIN_MATCH) ? best : 0;
+}
+
+static void put_length(int len) {
+    while (len >= 255) {
+        out[outsize++] = 255;
+        len -= 255;
+    }
+    out[outsize++] = len;
+}
+
+static void put_sequence(int litStart, int litLen, int matchLen, int offset) {
+    int litNibble = (litLen < 15) ? litLen : 15;
+    int matchNibble = 0;
+
+    if (matchLen != 0) {
+        matchNibble = (matchLen - MIN_MATCH < 15) ? matchLen - MIN_MATCH : 15;
+    }
+    out[outsize++] = (litNibble << 4) | matchNibble;
+    if (litNibble == 15) {
+        put_length(litLen - 15);
+    }
+    memcpy(&out[outsize], &in[litStart], litLen);
+    outsize += litLen;
+
+    if (matchLen != 0) {
+        out[outsize++] = offset >> 8;
+        out[outsize++] = offset & 0xFF;
+        if (matchNibble == 15) {
+            put_length(matchLen - MIN_MATCH - 15);
+        }
+    }
+}
+
+static void compress(void) {
+    int pos = 0;
+    int litStart = 0;
+
+    head = malloc(sizeof(int) << HASH_BITS);
+    prev = malloc(sizeof(int) * (insize + 1));
+    // Worst case is all literals, which costs one byte for every 255 of them.
+    out = malloc(LZ4T_HEADER_SIZE + insize + insize / 255 + 16);
+    if (head == NULL || prev == NULL || out == NULL) {
+        fprintf(stderr, "lz4tpack: out of memory\n");
+        exit(1);
+    }
+    memset(head, -1, sizeof(int) << HASH_BITS);
+
+    memcpy(out, "LZ4T", 4);
+    out[4] = insize >> 24;
+    out[5] = insize >> 16;
+    out[6] = insize >> 8;
+    out[7] = insize;
+    outsize = LZ4T_HEADER_SIZE;
+
+    while (pos < insize) {
+        int offset = 0;
+        int len = find_match(pos, &offset);
+
+        if (len != 0) {
+            // Lazy matching: take a literal instead if the next position has a longer match.
+            int nextOffset = 0;
+            int nextLen;
+
+            insert(pos);
+            nextLen = find_match(pos + 1, &nextOffset);
+            if (nextLen > len + 1) {
+                pos++;
+                continue;
+            }
+
+            put_sequence(litStart, pos - litStart, len, offset);
+            for (int i = 1; i < len; i++) {
+                insert(pos + i);
+            }
+            pos += len;
+            litStart = pos;
+        } else {
+            insert(pos);
+            pos++;
+        }
+    }
+
+    // The decoder stops as soon as the output is full, so trailing literals need no match.
+    if (litStart < insize) {
+        put_sequence(litStart, insize - litStart, 0, 0);
+    }
+}
+
+static int get_length(int *pos, int size) {
+    int len = 0;
+    int b;
+
+    do {
+        if (*pos >= size) {
+            return -1;
+        }
+        b = in[(*pos)++];
+        len += b;
+    } while (b == 255);
+
+    return len;
+}
+
+static int decompress(void) {
+    int pos = LZ4T_HEADER_SIZE;
+
+    if (insize < LZ4T_HEADER_SIZE || memcmp(in, "LZ4T", 4) != 0) {
+        return 0;
+    }
+    int size = (in[4] << 24) | (in[5] << 16) | (in[6] << 8) | in[7];
+
+    out = malloc(size + 1);
+    outsize = 0;
+    while (outsize < size) {
+        if (pos >= insize) {
+            return 0;
+        }
+        int token = in[pos++];
+        int litLen = token >> 4;
+        int matchLen = (token & 0xF) + MIN_MATCH;
+
+        if (litLen == 15) {
+            int extra = get_length(&pos, insize);
+            if (extra < 0) {
+                return 0;
+            }
+            litLen += extra;
+        }
+        if (pos + litLen > insize || outsize + litLen > size) {
+            return 0;
+        }
+        memcpy(&out[outsize], &in[pos], litLen);
+        pos += litLen;
+        outsize += litLen;
+        if (outsize == size) {
+            break;
+        }
+
+        if (pos + 2 > insize) {
+            return 0;
+        }
+        int offset = (in[pos] << 8) | in[pos + 1];
+        pos += 2;
+        if ((token & 0xF) == 15) {
+            int extra = get_length(&pos, insize);
+            if (extra < 0) {
+                return 0;
+            }
+            matchLen += extra;
+        }
+        if (offset == 0 || offset > outsize || outsize + matchLen > size) {
+            return 0;
+        }
+        for (int i = 0; i < matchLen; i++, outsize++) {
+            out[outsize] = out[outsize - offset];
+        }
+    }
+
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    int unpack = 0;
+    int arg = 1;
+
+    if (argc > 1 && strcmp(argv[1], "-d") == 0) {
+        unpack = 1;
+        arg++;
+    }
+    if (argc - arg != 2) {
+        usage();
+    }
+
+    in = read_file(argv[arg], &insize);
+    if (unpack) {
+        if (!decompress()) {
+            fprintf(stderr, "lz4tpack: %s is not valid LZ4T data\n", argv[arg]);
+            return 1;
+        }
+    } else {
+        compress();
+    }
+    write_file(argv[arg + 1], out, outsize);
+
+    return 0;
+}
@@ -1,9 +1,10 @@
 import sys, struct, subprocess
 
 class MapEntry():
-	def __init__(self, nm, addr):
+	def __init__(self, nm, addr, size):
 		self.name = nm
 		self.addr = addr
+		self.size = size
 		self.strlen = (len(nm) + 4) & (~3)
 	def __str__(self):
 		return "%s %s %d" % (self.addr, self.name, self.strlen)
@@ -26,19 +27,25 @@ for line in symbols:
 	tokens = line.split()
 	if len(tokens) >= 3 and len(tokens[-2]) == 1:
 		addr = int(tokens[0], 16)
+		# symbols from assembly files usually have no size
+		size = int(tokens[1], 16) if len(tokens) >= 4 else 0
 		if addr & 0x80000000 and tokens[-2].lower() == "t":
-			symNames.append(MapEntry(tokens[-1], addr))
+			symNames.append(MapEntry(tokens[-1], addr, size))
+		# behavior scripts, so the behavior profiler can name them by their segmented address
+		elif (addr >> 24) == 0x13 and tokens[-2].lower() in ("d", "r"):
+			symNames.append(MapEntry(tokens[-1], addr, size))
 
 
 
 f1 = open(sys.argv[2], "wb+")
 f2 = open(sys.argv[3], "wb+")
 
+# parse_map binary searches the entries, so they must stay sorted by address
 symNames.sort(key=lambda x: x.addr)
 
 off = 0
 for x in symNames:
-	f1.write(struct.pack(structDef, x.addr, off, len(x.name), 0))
+	f1.write(struct.pack(structDef, x.addr, off, len(x.name), x.size))
 	f2.write(struct.pack(">%ds" % x.strlen, bytes(x.name, encoding="ascii")))
 	off += x.strlen
 
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 
 #define STBI_NO_LINEAR
@@ -260,12 +261,8 @@ int rgba2raw(uint8_t *raw, const rgba *img, int width, int height, int depth)
          raw[i*2+1] = ((g & 0x3) << 6) | (b << 1) | a;
       }
    } else if (depth == 32) {
-      for (int i = 0; i < width * height; i++) {
-         raw[i*4]   = img[i].red;
-         raw[i*4+1] = img[i].green;
-         raw[i*4+2] = img[i].blue;
-         raw[i*4+3] = img[i].alpha;
-      }
+      // rgba is already laid out as RGBA32
+      memcpy(raw, img, width * height * sizeof(*img));
    } else {
       ERROR("Error invalid depth %d\n", depth);
       size = -1;
@@ -282,10 +279,8 @@ int ia2raw(uint8_t *raw, const ia *img, int width, int height, int depth)
 
    switch (depth) {
       case 16:
-         for (int i = 0; i < width * height; i++) {
-            raw[i*2]   = img[i].intensity;
-            raw[i*2+1] = img[i].alpha;
-         }
+         // ia is already laid out as IA16
+         memcpy(raw, img, width * height * sizeof(*img));
          break;
       case 8:
          for (int i = 0; i < width * height; i++) {
@@ -296,26 +291,23 @@ int ia2raw(uint8_t *raw, const ia *img, int width, int height, int depth)
          break;
       case 4:
          for (int i = 0; i < width * height; i++) {
-            uint8_t val = SCALE_8_3(img[i].intensity);
-            uint8_t alpha = img[i].alpha ? 0x01 : 0x00;
-            uint8_t old = raw[i/2];
+            uint8_t val = (SCALE_8_3(img[i].intensity) << 1) | (img[i].alpha ? 0x01 : 0x00);
             if (i % 2) {
-               raw[i/2] = (old & 0xF0) | (val << 1) | alpha;
+               raw[i/2] |= val;
             } else {
-               raw[i/2] = (old & 0x0F) | (((val << 1) | alpha) << 4);
+               raw[i/2] = val << 4;
             }
          }
          break;
       case 1:
-         for (int i = 0; i < width * height; i++) {
-            uint8_t val = img[i].intensity;
-            uint8_t old = raw[i/8];
-            uint8_t bit = 1 << (7 - (i % 8));
-            if (val) {
-               raw[i/8] = old | bit;
-            } else {
-               raw[i/8] = old & (~bit);
+         for (int i = 0; i < width * height; i += 8) {
+            uint8_t byte = 0;
+            for (int j = 0; j < 8 && i + j < width * height; j++) {
+               if (img[i + j].intensity) {
+                  byte |= 0x80 >> j;
+               }
             }
+            raw[i/8] = byte;
          }
          break;
       default:
@@ -342,11 +334,10 @@ int i2raw(uint8_t *raw, const ia *img, int width, int height, int depth)
       case 4:
          for (int i = 0; i < width * height; i++) {
             uint8_t val = SCALE_8_4(img[i].intensity);
-            uint8_t old = raw[i/2];
             if (i % 2) {
-               raw[i/2] = (old & 0xF0) | val;
+               raw[i/2] |= val;
             } else {
-               raw[i/2] = (old & 0x0F) | (val << 4);
+               raw[i/2] = val << 4;
             }
          }
          break;
@@ -441,19 +432,17 @@ rgba *png2rgba(const char *png_filename, int *width, int *height)
    }
 
    switch (channels) {
-      case 3: // red, green, blue
       case 4: // red, green, blue, alpha
+         memcpy(img, data, img_size);
+         break;
+      case 3: // red, green, blue
          for (int j = 0; j < h; j++) {
             for (int i = 0; i < w; i++) {
                int idx = j*w + i;
                img[idx].red   = data[channels*idx];
                img[idx].green = data[channels*idx + 1];
                img[idx].blue  = data[channels*idx + 2];
-               if (channels == 4) {
-                  img[idx].alpha = data[channels*idx + 3];
-               } else {
-                  img[idx].alpha = 0xFF;
-               }
+               img[idx].alpha = 0xFF;
             }
          }
          break;
@@ -618,8 +607,14 @@ const char *n64graphics_get_write_version(void)
 }
 
 #ifdef N64GRAPHICS_STANDALONE
-#define N64GRAPHICS_VERSION "0.4"
+#define N64GRAPHICS_VERSION "0.5"
 #include <string.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 typedef enum
 {
@@ -632,6 +627,7 @@ typedef struct
    char *img_filename;
    char *bin_filename;
    char *pal_filename;
+   char *batch_filename;
    tool_mode mode;
    write_encoding encoding;
    unsigned int bin_offset;
@@ -650,6 +646,7 @@ static const graphics_config default_config =
    .img_filename = NULL,
    .bin_filename = NULL,
    .pal_filename = NULL,
+   .batch_filename = NULL,
    .mode = MODE_EXPORT,
    .encoding = ENCODING_RAW,
    .bin_offset = 0,
@@ -744,6 +741,7 @@ static int parse_encoding(write_encoding *encoding, const char *str)
 static void print_usage(void)
 {
    ERROR("Usage: n64graphics -e/-i BIN_FILE -g IMG_FILE [-p PAL_FILE] [-o BIN_OFFSET] [-P PAL_OFFSET] [-f FORMAT] [-c CI_FORMAT] [-w WIDTH] [-h HEIGHT] [-r ROTATE] [-V]\n"
+         "       n64graphics -b MANIFEST [-v]\n"
          "\n"
          "n64graphics v" N64GRAPHICS_VERSION ": N64 graphics manipulator\n"
          "\n"
@@ -762,6 +760,9 @@ static void print_usage(void)
          " -c CI_FORMAT  CI palette format: rgba16, ia16 (default: %s)\n"
          " -p PAL_FILE   palette binary file to import/export from/to\n"
          " -P PAL_OFFSET starting offset in PAL_FILE (prevents truncation during import)\n"
+         "Batch arguments:\n"
+         " -b MANIFEST   run every conversion listed in MANIFEST (- for stdin) in parallel, one per line,\n"
+         "               each given with the arguments above; blank lines and lines starting with # are skipped\n"
          "Other arguments:\n"
          " -v            verbose logging\n"
          " -V            print version information\n",
@@ -786,6 +787,10 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
    for (int i = 1; i < argc; i++) {
       if (argv[i][0] == '-') {
          switch (argv[i][1]) {
+            case 'b':
+               if (++i >= argc) return 0;
+               config->batch_filename = argv[i];
+               break;
             case 'c':
                if (++i >= argc) return 0;
                if (!parse_format(&config->pal_format, argv[i])) {
@@ -869,6 +874,9 @@ static int parse_arguments(int argc, char *argv[], graphics_config *config)
 // returns 1 if config is valid
 static int valid_config(const graphics_config *config)
 {
+   if (config->batch_filename) {
+      return 1;
+   }
    if (!config->bin_filename || !config->img_filename) {
       return 0;
    }
@@ -881,24 +889,18 @@ static int valid_config(const graphics_config *config)
    return 1;
 }
 
-int main(int argc, char *argv[])
+// run a single import or export
+static int convert(graphics_config config)
 {
-   graphics_config config = default_config;
-   rgba *imgr;
-   ia   *imgi;
+   rgba *imgr = NULL;
+   ia   *imgi = NULL;
    FILE *bin_fp;
-   uint8_t *raw;
+   uint8_t *raw = NULL;
    int raw_size;
    int length = 0;
    int flength;
    int res;
 
-   int valid = parse_arguments(argc, argv, &config);
-   if (!valid || !valid_config(&config)) {
-      print_usage();
-      exit(EXIT_FAILURE);
-   }
-
    if (config.mode == MODE_IMPORT) {
       if (0 == strcmp("-", config.bin_filename)) {
          bin_fp = stdout;
@@ -919,6 +921,9 @@ int main(int argc, char *argv[])
       switch (config.format.format) {
          case IMG_FORMAT_RGBA:
             imgr = png2rgba(config.img_filename, &config.width, &config.height);
+            if (!imgr) {
+               return EXIT_FAILURE;
+            }
             raw_size = (config.width * config.height * config.format.depth + 7) / 8;
             raw = malloc(raw_size);
             if (!raw) {
@@ -928,6 +933,9 @@ int main(int argc, char *argv[])
             break;
          case IMG_FORMAT_IA:
             imgi = png2ia(config.img_filename, &config.width, &config.height);
+            if (!imgi) {
+               return EXIT_FAILURE;
+            }
             raw_size = (config.width * config.height * config.format.depth + 7) / 8;
             raw = malloc(raw_size);
             if (!raw) {
@@ -937,6 +945,9 @@ int main(int argc, char *argv[])
             break;
          case IMG_FORMAT_I:
             imgi = png2ia(config.img_filename, &config.width, &config.height);
+            if (!imgi) {
+               return EXIT_FAILURE;
+            }
             raw_size = (config.width * config.height * config.format.depth + 7) / 8;
             raw = malloc(raw_size);
             if (!raw) {
@@ -1035,6 +1046,7 @@ int main(int argc, char *argv[])
       if (bin_fp != stdout) {
          fclose(bin_fp);
       }
+      free(raw);
 
    } else {
       if (config.width <= 0 || config.height <= 0 || config.format.depth <= 0) {
@@ -1055,6 +1067,7 @@ int main(int argc, char *argv[])
       if (flength != raw_size) {
          ERROR("Error reading %d bytes from \"%s\"\n", raw_size, config.bin_filename);
       }
+      fclose(bin_fp);
       switch (config.format.format) {
          case IMG_FORMAT_RGBA:
             if (config.rotate_envmap) {
@@ -1118,17 +1131,190 @@ int main(int argc, char *argv[])
             }
             free(raw_fmt);
             free(pal);
+            fclose(pal_fp);
             break;
          }
          default:
             return EXIT_FAILURE;
       }
+      free(raw);
       if (!res) {
          ERROR("Error writing to \"%s\"\n", config.img_filename);
          return EXIT_FAILURE;
       }
    }
 
+   free(imgr);
+   free(imgi);
    return EXIT_SUCCESS;
 }
+
+//---------------------------------------------------------
+// batch mode
+//---------------------------------------------------------
+
+typedef struct
+{
+   graphics_config config;
+   int line;
+   int result;
+} batch_job;
+
+static batch_job *jobs;
+static int num_jobs;
+static int next_job;
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int num_cpus(void)
+{
+#ifdef _WIN32
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return info.dwNumberOfProcessors;
+#else
+   long n = sysconf(_SC_NPROCESSORS_ONLN);
+   return (n > 0) ? n : 1;
+#endif
+}
+
+static void *batch_worker(void *arg)
+{
+   (void) arg;
+
+   while (1) {
+      int job;
+
+      pthread_mutex_lock(&job_lock);
+      job = next_job++;
+      pthread_mutex_unlock(&job_lock);
+      if (job >= num_jobs) {
+         return NULL;
+      }
+      jobs[job].result = convert(jobs[job].config);
+   }
+}
+
+// split a manifest line into arguments in place, returns the argument count
+static int split_line(char *line, char **args, int max_args)
+{
+   int count = 1; // args[0] is the program name, as parse_arguments expects
+   char *tok = strtok(line, " \t\r\n");
+
+   args[0] = "n64graphics";
+   while (tok && count < max_args) {
+      args[count++] = tok;
+      tok = strtok(NULL, " \t\r\n");
+   }
+   return count;
+}
+
+// run every conversion in the manifest, spread across a thread per CPU core
+static int run_batch(const char *manifest)
+{
+   FILE *fp;
+   char *buf;
+   long buf_size;
+   char *line;
+   int line_num = 0;
+   int capacity = 0;
+   int num_threads;
+   int ret = EXIT_SUCCESS;
+
+   if (0 == strcmp("-", manifest)) {
+      fp = stdin;
+   } else {
+      fp = fopen(manifest, "rb");
+   }
+   if (!fp) {
+      ERROR("Error opening \"%s\"\n", manifest);
+      return EXIT_FAILURE;
+   }
+   // the manifest is kept in memory, since the configs point into it
+   buf_size = 0x1000;
+   buf = malloc(buf_size);
+   for (long len = 0; ; ) {
+      len += fread(buf + len, 1, buf_size - len - 1, fp);
+      if (len < buf_size - 1) {
+         buf[len] = '\0';
+         break;
+      }
+      buf_size *= 2;
+      buf = realloc(buf, buf_size);
+   }
+   if (fp != stdin) {
+      fclose(fp);
+   }
+
+   for (line = buf; line; ) {
+      char *next = strchr(line, '\n');
+      char *args[32];
+      int argc;
+
+      if (next) {
+         *next++ = '\0';
+      }
+      line_num++;
+      argc = split_line(line, args, DIM(args));
+      if (argc > 1 && args[1][0] != '#') {
+         graphics_config config = default_config;
+         if (!parse_arguments(argc, args, &config) || config.batch_filename || !valid_config(&config)) {
+            ERROR("Error in \"%s\" line %d\n", manifest, line_num);
+            free(buf);
+            free(jobs);
+            return EXIT_FAILURE;
+         }
+         if (num_jobs == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            jobs = realloc(jobs, capacity * sizeof(*jobs));
+         }
+         jobs[num_jobs].config = config;
+         jobs[num_jobs].line = line_num;
+         num_jobs++;
+      }
+      line = next;
+   }
+
+   num_threads = num_cpus();
+   if (num_threads > num_jobs) {
+      num_threads = num_jobs;
+   }
+   if (num_threads <= 1) {
+      batch_worker(NULL);
+   } else {
+      pthread_t *threads = malloc(num_threads * sizeof(*threads));
+      for (int i = 0; i < num_threads; i++) {
+         pthread_create(&threads[i], NULL, batch_worker, NULL);
+      }
+      for (int i = 0; i < num_threads; i++) {
+         pthread_join(threads[i], NULL);
+      }
+      free(threads);
+   }
+
+   for (int i = 0; i < num_jobs; i++) {
+      if (jobs[i].result != EXIT_SUCCESS) {
+         ERROR("Error converting \"%s\" line %d\n", manifest, jobs[i].line);
+         ret = EXIT_FAILURE;
+      }
+   }
+   free(jobs);
+   free(buf);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   graphics_config config = default_config;
+
+   int valid = parse_arguments(argc, argv, &config);
+   if (!valid || !valid_config(&config)) {
+      print_usage();
+      exit(EXIT_FAILURE);
+   }
+
+   if (config.batch_filename) {
+      return run_batch(config.batch_filename);
+   }
+   return convert(config);
+}
 #endif // N64GRAPHICS_STANDALONE
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+Converts a trace sent over USB by PROFILER_TRACE (see src/game/profiling.h) into the Chrome trace
+JSON format, which can be opened in https://ui.perfetto.dev or chrome://tracing.
+
+UNFLoader saves binary dumps to the folder it runs in (binaryout-*.bin by default).
+
+Usage:
+    tools/profiler_trace.py binaryout.bin trace.json
+"""
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x54524345
+VERSION = 1
+NAME_LENGTH = 24
+HEADER_FORMAT = ">IHHIII"
+EVENT_FORMAT = ">IHBB"
+
+EVENT_BEGIN = 0
+EVENT_END = 1
+EVENT_INSTANT = 2
+
+THREAD_RSP = 0x3F
+
+# enum ThreadID in src/game/main.h
+THREAD_NAMES = {
+    1: "Idle",
+    3: "Scheduler",
+    4: "Sound",
+    5: "Game Loop",
+    6: "Rumble",
+    THREAD_RSP: "RSP",
+}
+
+
+def fail(msg):
+    print("profiler_trace.py: " + msg, file=sys.stderr)
+    sys.exit(1)
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    if len(data) < header_size:
+        fail(path + ": file is too short")
+    magic, version, num_scopes, num_events, num_dropped, counter_rate = struct.unpack_from(HEADER_FORMAT, data)
+    if magic != MAGIC:
+        fail(path + ": not a profiler trace")
+    if version != VERSION:
+        fail(path + ": unsupported trace version %d" % version)
+
+    names = []
+    offset = header_size
+    for i in range(num_scopes):
+        name = data[offset : offset + NAME_LENGTH].split(b"\0")[0].decode("ascii", "replace")
+        names.append(name or "Scope %d" % i)
+        offset += NAME_LENGTH
+
+    event_size = struct.calcsize(EVENT_FORMAT)
+    if len(data) < offset + num_events * event_size:
+        fail(path + ": trace is truncated")
+
+    events = []
+    for i in range(num_events):
+        time, frame, scope, type_and_thread = struct.unpack_from(EVENT_FORMAT, data, offset + i * event_size)
+        events.append((time, frame, scope, type_and_thread >> 6, type_and_thread & 0x3F))
+
+    return names, events, num_dropped, counter_rate
+
+
+def unwrap_times(events):
+    """The counter wraps every ~90 seconds, so times are made relative to the first event."""
+    result = []
+    prev = None
+    total = 0
+    for event in events:
+        if prev is not None:
+            delta = (event[0] - prev) & 0xFFFFFFFF
+            # Events from different threads are not strictly in order, so allow small steps back.
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            total += delta
+        prev = event[0]
+        result.append((total,) + event[1:])
+    # Stable, so a zero length begin stays before its end
+    result.sort(key=lambda e: e[0])
+    return result
+
+
+def convert(names, events, counter_rate):
+    trace = []
+    for tid, name in sorted(THREAD_NAMES.items()):
+        trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": tid, "args": {"name": name}})
+        trace.append({"name": "thread_sort_index", "ph": "M", "pid": 0, "tid": tid, "args": {"sort_index": tid}})
+
+    for time, frame, scope, event_type, thread in events:
+        name = names[scope] if scope < len(names) else "Scope %d" % scope
+        entry = {
+            "name": name,
+            "pid": 0,
+            "tid": thread,
+            "ts": time * 1000000.0 / counter_rate,
+            "args": {"frame": frame},
+        }
+        if event_type == EVENT_BEGIN:
+            entry["ph"] = "B"
+        elif event_type == EVENT_END:
+            entry["ph"] = "E"
+        elif event_type == EVENT_INSTANT:
+            entry["ph"] = "i"
+            entry["s"] = "g"
+        else:
+            continue
+        trace.append(entry)
+
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a PROFILER_TRACE dump into Chrome trace JSON.")
+    parser.add_argument("input", help="binary dump received over USB")
+    parser.add_argument("output", help="output .json file")
+    args = parser.parse_args()
+
+    names, events, num_dropped, counter_rate = read_trace(args.input)
+    events = unwrap_times(events)
+
+    with open(args.output, "w") as f:
+        json.dump(convert(names, events, counter_rate), f)
+
+    frames = len(set(e[1] for e in events))
+    print("%s: %d events over %d frames, %d older events dropped" % (args.output, len(events), frames, num_dropped))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,38 @@
+#!/usr/bin/env python3
+# Prefixes a compressed segment with the header load_segment_decompress reads when building with COMPRESS=mixed.
+#
+# Header (16 bytes, big endian):
+#   0x00  "SEG"
+#   0x03  Codec (enum SegmentCodec in src/boot/memory.c)
+#   0x04  Decompressed size
+#   0x08  Padding, so the packed data stays 16 byte aligned
+#
+# If the packed data is no smaller than the original, the original is stored instead.
+
+import sys, struct
+
+CODECS = {
+	"uncomp": 0,
+	"yay0": 1,
+	"mio0": 2,
+	"rnc1": 3,
+	"rnc2": 4,
+	"gzip": 5,
+	"lz4t": 6,
+}
+
+if len(sys.argv) != 5 or sys.argv[1] not in CODECS:
+	print("usage: segment_header.py {%s} original packed outfile" % ",".join(CODECS), file=sys.stderr)
+	sys.exit(1)
+
+codec = sys.argv[1]
+original = open(sys.argv[2], "rb").read()
+packed = open(sys.argv[3], "rb").read()
+
+if len(packed) >= len(original):
+	codec = "uncomp"
+	packed = original
+
+out = b"SEG" + struct.pack(">BL8x", CODECS[codec], len(original)) + packed
+out += b"\0" * (-len(out) % 16)
+open(sys.argv[4], "wb").write(out)
@@ -1,98 +1,221 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 // Yay0 "slienc" compression tool
 // originally decompiled by SimonTime
+//
+// Several files can be compressed at once by passing more than one infile/outfile pair,
+// in which case they're spread across a thread per CPU core.
+//
+// -O picks matches by optimal parsing instead of greedily, which makes smaller files that
+// decode just the same, but takes longer.
+
+#define WINDOW_SIZE 4096
+#define MAX_MATCH   273
+#define HASH_BITS   16
+
+typedef struct
+{
+	unsigned char *bz;   // input
+	int insize;
+	unsigned int *cmd;   // mask bits
+	int cp;
+	int ncp;
+	unsigned short *pol; // links
+	int pp;
+	int npp;
+	unsigned char *def;  // literals and long match lengths
+	int dp;
+	int ndp;
+	int *head;           // oldest position in the window for each hash
+	int *next;           // next position with the same hash
+} Encoder;
+
+typedef struct
+{
+	const char *src;
+	const char *dest;
+	int result;
+} Job;
+
+static Job *jobs;
+static int numJobs;
+static int nextJob;
+static int optimal;
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
 
 int main(int argc, const char **argv, const char **envp);
-void encode();
-void search(unsigned int a1, int a2, int *a3, unsigned int *a4);
-int mischarsearch(unsigned char *a1, int a2, unsigned char *a3, int a4);
-void initskip(unsigned char *a1, int a2);
-void writeshort(short a1);
-void writeint4(int a1);
-
-unsigned short skip[256]; // idb
-int cp; // weak
-int ndp; // weak
-FILE *fp; // idb
-unsigned char *def;
-unsigned short *pol;
-int pp; // weak
-int insize; // idb
-int ncp; // weak
-int npp; // weak
-unsigned char *bz;
-int dp; // idb
-unsigned int *cmd;
+int compress_file(const char *src, const char *dest);
+void encode(Encoder *e);
+void encode_optimal(Encoder *e);
+void search(Encoder *e, unsigned int a1, int a2, int *a3, unsigned int *a4);
+void writeshort(FILE *fp, short a1);
+void writeint4(FILE *fp, int a1);
+
+static unsigned int hash3(const unsigned char *p)
+{
+	return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void init_chains(Encoder *e)
+{
+	e->head = malloc(sizeof(int) << HASH_BITS);
+	e->next = malloc(sizeof(int) * (e->insize + 1));
+	memset(e->head, -1, sizeof(int) << HASH_BITS);
+	for (int i = e->insize - 3; i >= 0; i--)
+	{
+		unsigned int h = hash3(&e->bz[i]);
+		e->next[i] = e->head[h];
+		e->head[h] = i;
+	}
+}
+
+static int num_cpus(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? n : 1;
+#endif
+}
+
+static void *worker(void *arg)
+{
+	(void) arg;
+
+	while (1)
+	{
+		int job;
+
+		pthread_mutex_lock(&jobLock);
+		job = nextJob++;
+		pthread_mutex_unlock(&jobLock);
+		if (job >= numJobs)
+			return NULL;
+		jobs[job].result = compress_file(jobs[job].src, jobs[job].dest);
+	}
+}
 
 int main(int argc, const char **argv, const char **envp)
 {
-    char src[999];
-	char dest[999];
+	int numThreads;
+	pthread_t *threads;
+	int result = 0;
 
+	if (argc > 1 && strcmp(argv[1], "-O") == 0)
+	{
+		optimal = 1;
+		argv++;
+		argc--;
+	}
 
-	if (argc < 3)
+	if (argc < 3 || (argc - 1) % 2 != 0)
 	{
-		fprintf(stderr, "slienc [infile] [outfile]\n");
+		fprintf(stderr, "slienc [-O] [infile] [outfile] [[infile] [outfile] ...]\n");
 		return 1;
 	}
-	
-	strcpy(src, argv[1]);
-    strcpy(dest, argv[2]);
-	
+
+	numJobs = (argc - 1) / 2;
+	jobs = calloc(numJobs, sizeof(*jobs));
+	for (int i = 0; i < numJobs; i++)
+	{
+		jobs[i].src = argv[1 + i * 2];
+		jobs[i].dest = argv[2 + i * 2];
+	}
+
+	numThreads = num_cpus();
+	if (numThreads > numJobs)
+		numThreads = numJobs;
+	if (numThreads <= 1)
+	{
+		worker(NULL);
+	}
+	else
+	{
+		threads = malloc(numThreads * sizeof(*threads));
+		for (int i = 0; i < numThreads; i++)
+			pthread_create(&threads[i], NULL, worker, NULL);
+		for (int i = 0; i < numThreads; i++)
+			pthread_join(threads[i], NULL);
+		free(threads);
+	}
+
+	for (int i = 0; i < numJobs; i++)
+	{
+		if (jobs[i].result != 0)
+			result = jobs[i].result;
+	}
+	free(jobs);
+
+	return result;
+}
+
+int compress_file(const char *src, const char *dest)
+{
+	Encoder e;
+	FILE *fp;
+
 	if ((fp = fopen(src, "rb")) == NULL)
 	{
 		fprintf(stderr, "FILE OPEN ERROR![%s]\n", src);
 		return 1;
 	}
-	
+
 	fseek(fp, 0, SEEK_END);
-	insize = ftell(fp);
+	e.insize = ftell(fp);
 	fseek(fp, 0, SEEK_SET);
-	
-	bz = malloc(insize);
-	size_t fread_result = fread(bz, 1, insize, fp);
+
+	e.bz = malloc(e.insize + 1);
+	size_t fread_result = fread(e.bz, 1, e.insize, fp);
 	fclose(fp);
-	
-	for (int i = 0; src[i]; i++)
-	{
-		if (src[i] == '.')
-		{
-			src[i] = 0;
-			break;
-		}
-	}
-    
+
 	if ((fp = fopen(dest, "wb")) == NULL)
 	{
 		fprintf(stderr, "FILE CREATE ERROR![%s]\n", dest);
-		exit(1);
+		free(e.bz);
+		return 1;
 	}
-	
-	encode();
-	
+
+	if (optimal)
+		encode_optimal(&e);
+	else
+		encode(&e);
+
 	fprintf(fp, "Yay0");
-	
-	writeint4(insize);
-	
-	writeint4(4 * cp + 16);
-	writeint4(2 * pp + 4 * cp + 16);
-	
-	for (int i = 0; i < cp; i++)
-		writeint4(cmd[i]);
-	
-	for (int i = 0; i < pp; i++)
-		writeshort(pol[i]);
-	
-	fwrite(def, 1u, dp, fp);
+
+	writeint4(fp, e.insize);
+
+	writeint4(fp, 4 * e.cp + 16);
+	writeint4(fp, 2 * e.pp + 4 * e.cp + 16);
+
+	for (int i = 0; i < e.cp; i++)
+		writeint4(fp, e.cmd[i]);
+
+	for (int i = 0; i < e.pp; i++)
+		writeshort(fp, e.pol[i]);
+
+	fwrite(e.def, 1u, e.dp, fp);
 	fclose(fp);
-	
+
+	free(e.bz);
+	free(e.cmd);
+	free(e.pol);
+	free(e.def);
+
 	return 0;
 }
 
-void encode()
+void encode(Encoder *e)
 {
 	unsigned int v0; // esi
 	unsigned int v1; // edi
@@ -106,56 +229,59 @@ void encode()
 	unsigned int a4; // [esp+1Ch] [ebp-8h]
 	int a3; // [esp+20h] [ebp-4h]
 
-	dp = 0;
-	pp = 0;
-	cp = 0;
-	npp = 4096;
-	ndp = 4096;
-	ncp = 4096;
-	cmd = calloc(0x4000u, 1u);
-	pol = malloc(2 * npp);
-	def = malloc(4 * ndp);
+	// Chain every position to the next one with the same hash, so search only looks at likely matches.
+	init_chains(e);
+
+	e->dp = 0;
+	e->pp = 0;
+	e->cp = 0;
+	e->npp = 4096;
+	e->ndp = 4096;
+	e->ncp = 4096;
+	e->cmd = calloc(0x4000u, 1u);
+	e->pol = malloc(2 * e->npp);
+	e->def = malloc(4 * e->ndp);
 	v0 = 0;
 	v6 = 1024;
 	v1 = 2147483648;
-	while ( insize > v0 )
+	while ( e->insize > v0 )
 	{
 		if ( v6 < v0 )
 			v6 += 1024;
-		search(v0, insize, &a3, &a4);
+		search(e, v0, e->insize, &a3, &a4);
 		if ( a4 <= 2 )
 		{
-			cmd[cp] |= v1;
-			def[dp++] = bz[v0++];
-			if ( ndp == dp )
+			e->cmd[e->cp] |= v1;
+			e->def[e->dp++] = e->bz[v0++];
+			if ( e->ndp == e->dp )
 			{
-				ndp = dp + 4096;
-				def = realloc(def, dp + 4096);
+				e->ndp = e->dp + 4096;
+				e->def = realloc(e->def, e->dp + 4096);
 			}
 		}
 		else
 		{
-			search(v0 + 1, insize, &v8, &v7);
+			search(e, v0 + 1, e->insize, &v8, &v7);
 			if ( v7 > a4 + 1 )
 			{
-				cmd[cp] |= v1;
-				def[dp++] = bz[v0++];
-				if ( ndp == dp )
+				e->cmd[e->cp] |= v1;
+				e->def[e->dp++] = e->bz[v0++];
+				if ( e->ndp == e->dp )
 				{
-					ndp = dp + 4096;
-					def = realloc(def, dp + 4096);
+					e->ndp = e->dp + 4096;
+					e->def = realloc(e->def, e->dp + 4096);
 				}
 				v1 >>= 1;
 				if ( !v1 )
 				{
 					v1 = 2147483648;
-					v2 = cp++;
-					if ( cp == ncp )
+					v2 = e->cp++;
+					if ( e->cp == e->ncp )
 					{
-						ncp = v2 + 1025;
-						cmd = realloc(cmd, 4 * (v2 + 1025));
+						e->ncp = v2 + 1025;
+						e->cmd = realloc(e->cmd, 4 * (v2 + 1025));
 					}
-					cmd[cp] = 0;
+					e->cmd[e->cp] = 0;
 				}
 				a4 = v7;
 				a3 = v8;
@@ -165,22 +291,22 @@ void encode()
 			v5 = a4;
 			if ( a4 > 0x11 )
 			{
-				pol[pp++] = v3;
-				def[dp++] = v5 - 18;
-				if ( ndp == dp )
+				e->pol[e->pp++] = v3;
+				e->def[e->dp++] = v5 - 18;
+				if ( e->ndp == e->dp )
 				{
-					ndp = dp + 4096;
-					def = realloc(def, dp + 4096);
+					e->ndp = e->dp + 4096;
+					e->def = realloc(e->def, e->dp + 4096);
 				}
 			}
 			else
 			{
-				pol[pp++] = v3 | (((short)a4 - 2) << 12);
+				e->pol[e->pp++] = v3 | (((short)a4 - 2) << 12);
 			}
-			if ( npp == pp )
+			if ( e->npp == e->pp )
 			{
-				npp = pp + 4096;
-				pol = realloc(pol, 2 * (pp + 4096));
+				e->npp = e->pp + 4096;
+				e->pol = realloc(e->pol, 2 * (e->pp + 4096));
 			}
 			v0 += a4;
 		}
@@ -188,129 +314,156 @@ void encode()
 		if ( !v1 )
 		{
 			v1 = 2147483648;
-			v4 = cp++;
-			if ( cp == ncp )
+			v4 = e->cp++;
+			if ( e->cp == e->ncp )
 			{
-				ncp = v4 + 1025;
-				cmd = realloc(cmd, 4 * (v4 + 1025));
+				e->ncp = v4 + 1025;
+				e->cmd = realloc(e->cmd, 4 * (v4 + 1025));
 			}
-			cmd[cp] = 0;
+			e->cmd[e->cp] = 0;
 		}
 	}
 	if ( v1 != 0x80000000 )
-		++cp;
-	//fprintf(stderr, "IN=%d OUT=%d\n", insize, dp + 2 * pp + 4 * cp + 16);
+		++e->cp;
+	//fprintf(stderr, "IN=%d OUT=%d\n", e->insize, e->dp + 2 * e->pp + 4 * e->cp + 16);
+
+	free(e->head);
+	free(e->next);
 }
 
-void search(unsigned int a1, int a2, int *a3, unsigned int *a4)
+// Encodes with the fewest bits possible: 9 for a literal, 17 for a match of up to 17 bytes and
+// 25 for a longer one. Every length from 3 up to the longest match at a position can be had from
+// the same offset, so only the longest match needs finding, and then the cheapest way to reach
+// the end from each position is worked out backwards.
+void encode_optimal(Encoder *e)
 {
-	unsigned int v4; // ebx
-	unsigned int v5; // esi
-	unsigned int *v6; // edi
-	unsigned int v7; // [esp+Ch] [ebp-10h]
-	int v8; // [esp+14h] [ebp-8h]
-	unsigned int v9; // [esp+18h] [ebp-4h]
-
-	v4 = 3;
-	v5 = 0;
-	if ( a1 > 0x1000 )
-		v5 = a1 - 4096;
-	v9 = 273;
-	if ( a2 - a1 <= 0x111 )
-		v9 = a2 - a1;
-	if ( v9 > 2 )
+	int n = e->insize;
+	unsigned int *cost = malloc(sizeof(int) * (n + 1));
+	unsigned short *length = malloc(sizeof(short) * (n + 1));
+	unsigned short *longest = malloc(sizeof(short) * (n + 1));
+	int *offset = malloc(sizeof(int) * (n + 1));
+	unsigned int bit = 0x80000000;
+
+	init_chains(e);
+	for (int i = 0; i < n; i++)
+	{
+		unsigned int len;
+		search(e, i, n, &offset[i], &len);
+		longest[i] = len;
+	}
+
+	cost[n] = 0;
+	for (int i = n - 1; i >= 0; i--)
 	{
-		while ( a1 > v5 )
+		cost[i] = cost[i + 1] + 9;
+		length[i] = 1;
+		for (int len = 3; len <= longest[i]; len++)
 		{
-			v7 = mischarsearch(&bz[a1], v4, &bz[v5], v4 + a1 - v5);
-			if ( v7 >= a1 - v5 )
-				break;
-			for ( ; v9 > v4; ++v4 )
+			unsigned int c = cost[i + len] + ((len < 18) ? 17 : 25);
+			if (c < cost[i])
+			{
+				cost[i] = c;
+				length[i] = len;
+			}
+		}
+	}
+
+	e->cp = 0;
+	e->pp = 0;
+	e->dp = 0;
+	e->cmd = calloc(n / 32 + 2, sizeof(*e->cmd));
+	e->pol = malloc(sizeof(*e->pol) * (n / 3 + 1));
+	e->def = malloc(n + 1);
+	for (int i = 0; i < n; i += length[i])
+	{
+		if (length[i] == 1)
+		{
+			e->cmd[e->cp] |= bit;
+			e->def[e->dp++] = e->bz[i];
+		}
+		else
+		{
+			int dist = i - offset[i] - 1;
+			if (length[i] >= 18)
 			{
-				if ( bz[v4 + v5 + v7] != bz[v4 + a1] )
-					break;
+				e->pol[e->pp++] = dist;
+				e->def[e->dp++] = length[i] - 18;
 			}
-			if ( v9 == v4 )
+			else
 			{
-				*a3 = v7 + v5;
-				goto LABEL_17;
+				e->pol[e->pp++] = dist | ((length[i] - 2) << 12);
 			}
-			v8 = v5 + v7;
-			++v4;
-			v5 += v7 + 1;
 		}
-		*a3 = v8;
-		if ( v4 > 3 )
+		bit >>= 1;
+		if (!bit)
 		{
-			--v4;
-LABEL_17:
-			*a4 = v4;
-			return;
+			bit = 0x80000000;
+			e->cp++;
 		}
-		v6 = a4;
 	}
-	else
+	if (bit != 0x80000000)
+		e->cp++;
+
+	free(cost);
+	free(length);
+	free(longest);
+	free(offset);
+	free(e->head);
+	free(e->next);
+}
+
+// Finds the longest match for a1 of at least 3 bytes in the 4096 bytes before it, and the earliest one if there's a tie.
+// Only positions with the same hash can match, and positions are only ever searched in increasing order, so the head
+// of each hash chain is moved forward to the start of the window as it goes.
+void search(Encoder *e, unsigned int a1, int a2, int *a3, unsigned int *a4)
+{
+	unsigned int windowStart = (a1 > WINDOW_SIZE) ? a1 - WINDOW_SIZE : 0;
+	unsigned int maxLength = MAX_MATCH;
+	unsigned int bestLength = 0;
+	int bestPos = 0;
+	int *head;
+	int pos;
+
+	if ( a2 - a1 <= MAX_MATCH )
+		maxLength = a2 - a1;
+	if ( maxLength <= 2 )
 	{
+		*a3 = 0;
 		*a4 = 0;
-		v6 = a3;
+		return;
 	}
-	*v6 = 0;
-}
 
-int mischarsearch(unsigned char *pattern, int patternlen, unsigned char *data, int datalen)
-{
-  int result; // eax
-  int i; // ebx
-  int v6; // eax
-  int j; // ecx
-
-  result = datalen;
-  if ( patternlen <= datalen )
-  {
-    initskip(pattern, patternlen);
-    for ( i = patternlen - 1; ; i += v6 )
-    {
-      if ( pattern[patternlen - 1] == data[i] )
-      {
-        --i;
-        j = patternlen - 2;
-        if ( patternlen - 2 < 0 )
-          return i + 1;
-        while ( pattern[j] == data[i] )
-        {
-          --i;
-          if ( --j < 0 )
-            return i + 1;
-        }
-        v6 = patternlen - j;
-        if ( skip[data[i]] > patternlen - j )
-          v6 = skip[data[i]];
-      }
-      else
-      {
-        v6 = skip[data[i]];
-      }
-    }
-  }
-  return result;
-}
+	head = &e->head[hash3(&e->bz[a1])];
+	for (pos = *head; pos >= 0 && (unsigned int) pos < windowStart; pos = e->next[pos])
+		;
+	*head = pos;
 
-void initskip(unsigned char *pattern, int len)
-{
-	for (int i = 0; i < 256; i++)
-		skip[i] = len;
-	
-	for (int i = 0; i < len; i++)
-		skip[pattern[i]] = len - i - 1;
+	for ( ; pos >= 0 && (unsigned int) pos < a1; pos = e->next[pos])
+	{
+		unsigned int length = 0;
+
+		while (length < maxLength && e->bz[pos + length] == e->bz[a1 + length])
+			length++;
+		if (length > bestLength && length > 2)
+		{
+			bestLength = length;
+			bestPos = pos;
+			if (length == maxLength)
+				break;
+		}
+	}
+
+	*a3 = bestPos;
+	*a4 = bestLength;
 }
 
-void writeshort(short val)
+void writeshort(FILE *fp, short val)
 {
 	fputc((val & 0xff00) >> 8, fp);
 	fputc((val & 0x00ff) >> 0, fp);
 }
 
-void writeint4(int val)
+void writeint4(FILE *fp, int val)
 {
 	fputc((val & 0x00ff000000) >> 24, fp);
 	fputc((val & 0x0000ff0000) >> 16, fp);
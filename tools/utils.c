@@ -68,15 +68,28 @@ int fprint_write_output(FILE *fp, write_encoding encoding, const uint8_t *raw, i
       case ENCODING_U16:
       case ENCODING_U32:
       case ENCODING_U64:
+      {
+         // format each value by hand, printf per byte is most of the time spent on large textures
+         static const char hex[] = "0123456789abcdef";
+         char val[32];
          for (int w = 0; w < length; w += fmt->bytes_per_val) {
-            flength += fprintf(fp, "0x");
+            int len = 0;
+            val[len++] = '0';
+            val[len++] = 'x';
             for (int b = 0; b < fmt->bytes_per_val; b++) {
                int off = w + b;
-               flength += fprintf(fp, "%02x", off < length ? raw[off] : 0x00);
+               uint8_t byte = off < length ? raw[off] : 0x00;
+               val[len++] = hex[byte >> 4];
+               val[len++] = hex[byte & 0xF];
             }
-            flength += fprintf(fp, "%s%c", fmt->suffix, (w < length - fmt->bytes_per_val) ? ',' : '\n');
+            for (const char *c = fmt->suffix; *c; c++) {
+               val[len++] = *c;
+            }
+            val[len++] = (w < length - fmt->bytes_per_val) ? ',' : '\n';
+            flength += fwrite(val, 1, len, fp);
          }
          break;
+      }
    }
    return flength;
 }